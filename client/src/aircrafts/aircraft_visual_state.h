@@ -19,6 +19,8 @@
 #ifndef AIRCRAFT_VISUAL_STATE_H
 #define AIRCRAFT_VISUAL_STATE_H
 
+#include <QtGlobal>
+
 struct AircraftVisualState
 {
     double Latitude;
@@ -29,6 +31,7 @@ struct AircraftVisualState
     double Heading;
     double Bank;
     double NoseWheelAngle;
+    qint64 ReceivedTimestamp = 0; // ms since epoch, when the position arrived from FSD
 
     bool operator==(const AircraftVisualState& rhs) const
     {
@@ -23,7 +23,8 @@ namespace xpilot
     AircraftManager::AircraftManager(QObject *parent) :
         QObject(parent),
         m_networkManager(*QInjection::Pointer<NetworkManager>().data()),
-        m_xplaneAdapter(*QInjection::Pointer<XplaneAdapter>().data())
+        m_xplaneAdapter(*QInjection::Pointer<XplaneAdapter>().data()),
+        m_staleAircraft(StaleAircraftTick, StaleAircraftSlots)
     {
         InitializeTimers();
 
@@ -63,22 +64,23 @@ namespace xpilot
 
     void AircraftManager::OnStaleAircraftTimeoutTimeout()
     {
-        auto now = QDateTime::currentDateTimeUtc();
+        // position updates re-arm each aircraft's deadline, so only aircraft that actually went stale are visited
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        m_expiredAircraft.clear();
+        m_staleAircraft.Advance(now, m_expiredAircraft);
 
-        QVector<NetworkAircraft> deleteThese;
-        for(auto& aircraft : m_aircraft)
+        for(const auto& callsign : m_expiredAircraft)
         {
-            int timeSinceLastUpdate = aircraft.LastUpdated.msecsTo(now);
-            if(timeSinceLastUpdate > 15000)
+            auto aircraft = std::find_if(m_aircraft.begin(), m_aircraft.end(), [&](const NetworkAircraft& a){
+                return a.Callsign == callsign;
+            });
+
+            if(aircraft != m_aircraft.end())
             {
-                deleteThese.append(aircraft);
+                DeletePlane(*aircraft, "Stale");
+                m_staleAircraft.Arm(callsign, now + StaleAircraftTimeout); // ask again until the simulator confirms the removal
             }
         }
-
-        for(auto & aircraft : deleteThese)
-        {
-            DeletePlane(aircraft, "Stale");
-        }
     }
 
     void AircraftManager::OnSimulatorAircraftSyncTimeout()
@@ -120,6 +122,7 @@ namespace xpilot
         {
            aircraft->Speed = speed;
            aircraft->LastUpdated = QDateTime::currentDateTimeUtc();
+           m_staleAircraft.Arm(callsign, aircraft->LastUpdated.toMSecsSinceEpoch() + StaleAircraftAge);
            m_xplaneAdapter.SendHeartbeat(callsign);
 
            if((aircraft->Status == AircraftStatus::New) && IsEligibleToAddToSimulator(*aircraft))
@@ -140,6 +143,7 @@ namespace xpilot
         {
             aircraft->HaveVelocities = true;
             aircraft->LastUpdated = QDateTime::currentDateTimeUtc();
+            m_staleAircraft.Arm(callsign, aircraft->LastUpdated.toMSecsSinceEpoch() + StaleAircraftAge);
             m_xplaneAdapter.SendFastPositionUpdate(*aircraft, visualState, positionalVelocityVector, rotationalVelocityVector);
         }
     }
@@ -240,6 +244,7 @@ namespace xpilot
     {
         m_xplaneAdapter.DeleteAllAircraft();
         m_aircraft.clear();
+        m_staleAircraft.Clear();
     }
 
     void AircraftManager::DeletePlane(const NetworkAircraft &aircraft, QString reason)
@@ -255,6 +260,7 @@ namespace xpilot
         aircraft.LastUpdated = QDateTime::currentDateTimeUtc();
         aircraft.Status = m_ignoredAircraft.contains(callsign) ? AircraftStatus::Ignored : AircraftStatus::New;
         m_aircraft.append(aircraft);
+        m_staleAircraft.Arm(callsign, aircraft.LastUpdated.toMSecsSinceEpoch() + StaleAircraftAge);
 
         m_networkManager.RequestCapabilities(callsign);
         m_networkManager.SendCapabilities(callsign);
@@ -355,6 +361,7 @@ namespace xpilot
         if(aircraft != m_aircraft.end())
         {
             m_aircraft.removeAll(*aircraft);
+            m_staleAircraft.Cancel(callsign);
         }
     }
 }
@@ -25,6 +25,7 @@
 
 #include "network_aircraft.h"
 #include "velocity_vector.h"
+#include "expiry_wheel.h"
 #include "simulator/xplane_adapter.h"
 #include "network/networkmanager.h"
 #include "qinjection/dependencypointer.h"
@@ -43,6 +44,9 @@ namespace xpilot
         XplaneAdapter& m_xplaneAdapter;
 
         static constexpr int StaleAircraftTimeout = 10000;
+        static constexpr int StaleAircraftAge = 15000;
+        static constexpr int StaleAircraftTick = 1000;
+        static constexpr int StaleAircraftSlots = 32;
         static constexpr int SimulatorAircraftSyncInterval = 5000;
 
         QTimer m_staleAircraftCheckTimer;
@@ -50,6 +54,8 @@ namespace xpilot
 
         QList<NetworkAircraft> m_aircraft;
         QList<QString> m_ignoredAircraft;
+        ExpiryWheel<QString> m_staleAircraft;
+        std::vector<QString> m_expiredAircraft;
 
         void InitializeTimers();
         void OnNetworkConnected();
@@ -58,7 +58,7 @@ public:
 
     Q_PROPERTY(bool SelcalMuteOverride MEMBER SelcalMuteOverride)
 
-    bool operator==(RadioStackState &other) const
+    bool operator==(const RadioStackState &other) const
     {
         return AvionicsPowerOn == other.AvionicsPowerOn
                 && OverrideRadioPower == other.OverrideRadioPower
@@ -76,7 +76,7 @@ public:
                 && SelcalMuteOverride == other.SelcalMuteOverride;
     }
 
-    bool operator!=(RadioStackState &other) const
+    bool operator!=(const RadioStackState &other) const
     {
         return AvionicsPowerOn != other.AvionicsPowerOn
                 || OverrideRadioPower != other.OverrideRadioPower
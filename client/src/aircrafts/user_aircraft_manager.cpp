@@ -41,6 +41,10 @@ UserAircraftManager::UserAircraftManager(QObject* parent) :
         if(m_tokensAvailable < AcconfigMaxTokens) {
             m_tokensAvailable++;
         }
+
+        // configuration updates are change-driven, so a change that arrived while we were
+        // out of tokens has to be flushed here rather than on the next (possibly distant) update
+        BroadcastAircraftConfiguration();
     });
     m_tokenRefreshTimer.start(AcconfigTokenRefreshInterval);
 }
@@ -56,15 +60,9 @@ void UserAircraftManager::OnUserAircraftConfigDataUpdated(UserAircraftConfigData
     {
         m_lastBroadcastConfig = AircraftConfiguration::FromUserAircraftData(m_userAircraftConfigData);
     }
-    else if(m_tokensAvailable > 0)
+    else
     {
-        AircraftConfiguration newCfg = AircraftConfiguration::FromUserAircraftData(m_userAircraftConfigData);
-        if(newCfg != m_lastBroadcastConfig.value()) {
-            AircraftConfiguration incremental = m_lastBroadcastConfig->CreateIncremental(newCfg);
-            m_networkManager.SendAircraftConfigurationUpdate(incremental);
-            m_lastBroadcastConfig = newCfg;
-            m_tokensAvailable--;
-        }
+        BroadcastAircraftConfiguration();
     }
 
     if(m_simConnected && m_initialAircraftDataReceived)
@@ -80,6 +78,20 @@ void UserAircraftManager::OnUserAircraftConfigDataUpdated(UserAircraftConfigData
     m_initialAircraftDataReceived = true;
 }
 
+void UserAircraftManager::BroadcastAircraftConfiguration()
+{
+    if(!m_lastBroadcastConfig.has_value() || m_tokensAvailable <= 0)
+        return;
+
+    AircraftConfiguration newCfg = AircraftConfiguration::FromUserAircraftData(m_userAircraftConfigData);
+    if(newCfg != m_lastBroadcastConfig.value()) {
+        AircraftConfiguration incremental = m_lastBroadcastConfig->CreateIncremental(newCfg);
+        m_networkManager.SendAircraftConfigurationUpdate(incremental);
+        m_lastBroadcastConfig = newCfg;
+        m_tokensAvailable--;
+    }
+}
+
 void UserAircraftManager::OnRadioStackUpdated(RadioStackState radioStack)
 {
     m_radioStackState = radioStack;
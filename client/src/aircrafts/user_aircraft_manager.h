@@ -44,6 +44,7 @@ private:
     void OnUserAircraftConfigDataUpdated(UserAircraftConfigData data);
     void OnRadioStackUpdated(RadioStackState radioStack);
     void OnAircraftConfigurationInfoReceived(QString from, QString json);
+    void BroadcastAircraftConfiguration();
 
 private:
     NetworkManager& m_networkManager;
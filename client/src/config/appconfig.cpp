@@ -163,6 +163,7 @@ void AppConfig::loadConfig()
     XplaneUdpPort = getJsonValue<int>(jsonMap, "XplaneUdpPort", 49000);
     SilenceModelInstall = getJsonValue(jsonMap, "SilenceModelInstall", false);
     VisualMachines = getJsonValue(jsonMap, "VisualMachines", QStringList());
+    VisualMachineDeltaEncoding = getJsonValue(jsonMap, "VisualMachineDeltaEncoding", true);
     KeepWindowVisible = getJsonValue(jsonMap, "KeepWindowVisible", false);
     AircraftRadioStackControlsVolume = getJsonValue(jsonMap, "AircraftRadioStackControlsVolume", false);
     MicrophoneCalibrated = getJsonValue(jsonMap, "MicrophoneCalibrated", false);
@@ -268,6 +269,7 @@ bool AppConfig::saveConfig()
         visualMachines.append(machine);
     }
     jsonObj["VisualMachines"] = visualMachines;
+    jsonObj["VisualMachineDeltaEncoding"] = VisualMachineDeltaEncoding;
 
     QJsonObject recentConnection;
     recentConnection["Callsign"] = RecentConnection.Callsign;
@@ -93,6 +93,7 @@ namespace xpilot
         int XplaneUdpPort;
         bool SilenceModelInstall;
         QStringList VisualMachines;
+        bool VisualMachineDeltaEncoding; // send delta-encoded positions to visual machines whose plugin supports it
         bool KeepWindowVisible;
         bool AircraftRadioStackControlsVolume;
         bool MicrophoneCalibrated;
@@ -155,6 +156,7 @@ namespace xpilot
         Q_PROPERTY(bool MicrophoneCalibrated MEMBER MicrophoneCalibrated)
         Q_PROPERTY(bool SilenceModelInstall MEMBER SilenceModelInstall)
         Q_PROPERTY(QStringList VisualMachines MEMBER VisualMachines)
+        Q_PROPERTY(bool VisualMachineDeltaEncoding MEMBER VisualMachineDeltaEncoding)
         Q_PROPERTY(QString XplaneNetworkAddress MEMBER XplaneNetworkAddress)
 
         // Setter functions
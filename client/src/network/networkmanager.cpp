@@ -120,6 +120,9 @@ namespace xpilot
         }
 
         if(!m_connectInfo.TowerViewMode) {
+            // radio changes are only signalled on change and ignored in tower view, so catch up on
+            // whatever the sim is tuned to now before transmit frequencies are used
+            OnRadioStackStateChanged(m_xplaneAdapter.CurrentRadioStackState());
             m_xplaneAdapter.NetworkConnected(m_connectInfo.Callsign, m_connectInfo.SelcalCode, m_connectInfo.ObserverMode);
         }
     }
@@ -397,6 +400,7 @@ namespace xpilot
         visualState.Heading = pdu.Heading;
         visualState.Bank = pdu.Bank;
         visualState.NoseWheelAngle = pdu.NoseGearAngle;
+        visualState.ReceivedTimestamp = QDateTime::currentMSecsSinceEpoch();
 
         if(pdu.Type != FastPilotPositionType::Stopped)
         {
@@ -19,8 +19,11 @@
 #ifndef DTO_H
 #define DTO_H
 
+#include <array>
+#include <cmath>
 #include <string>
 #include <optional>
+#include <vector>
 
 #include <msgpack.hpp>
 
@@ -34,6 +37,7 @@ namespace xpilot {
         const std::string DELETE_ALL_AIRCRAFT = "DELALL";
         const std::string AIRCRAFT_CONFIG = "ACCONF";
         const std::string FAST_POSITION_UPDATE = "FSTPOS";
+        const std::string FAST_POSITION_DELTA = "FSTPOSD";
         const std::string HEARTBEAT = "HB";
         const std::string PLUGIN_VER = "VER";
         const std::string VALIDATE_CSL = "CSL";
@@ -151,13 +155,47 @@ namespace xpilot {
         double vb;
         double noseWheelAngle;
         double speed;
-        MSGPACK_DEFINE(callsign, latitude, longitude, altitudeTrue, altitudeAgl, heading, bank, pitch, vx, vy, vz, vp, vh, vb, noseWheelAngle, speed);
+        int64_t fsdReceiveTime = 0;
+        int64_t ipcSendTime = 0;
+        uint64_t clientSendFailures = 0;
+        MSGPACK_DEFINE(callsign, latitude, longitude, altitudeTrue, altitudeAgl, heading, bank, pitch, vx, vy, vz, vp, vh, vb, noseWheelAngle, speed, fsdReceiveTime, ipcSendTime, clientSendFailures);
 
         static std::string getName() {
             return FAST_POSITION_UPDATE;
         }
     };
 
+    // Sent to visual machines instead of FSTPOS once a keyframe has been delivered.
+    // Each entry is the difference between the quantized position and the previous one.
+    struct FastPositionDeltaDto {
+        std::string callsign;
+        std::vector<int64_t> delta;
+        MSGPACK_DEFINE(callsign, delta);
+
+        static std::string getName() {
+            return FAST_POSITION_DELTA;
+        }
+    };
+
+    constexpr size_t QUANTIZED_POSITION_FIELDS = 15;
+    typedef std::array<int64_t, QUANTIZED_POSITION_FIELDS> QuantizedPosition;
+
+    inline int64_t quantize(double value, double scale) {
+        return std::isfinite(value) ? std::llround(value * scale) : 0;
+    }
+
+    // Must match the plugin's dequantizePosition
+    inline QuantizedPosition quantizePosition(const FastPositionUpdateDto& dto) {
+        return {
+            quantize(dto.latitude, 1e7), quantize(dto.longitude, 1e7),
+            quantize(dto.altitudeTrue, 100), quantize(dto.altitudeAgl, 100),
+            quantize(dto.heading, 100), quantize(dto.bank, 100), quantize(dto.pitch, 100),
+            quantize(dto.vx, 1000), quantize(dto.vy, 1000), quantize(dto.vz, 1000),
+            quantize(dto.vp, 10000), quantize(dto.vh, 10000), quantize(dto.vb, 10000),
+            quantize(dto.noseWheelAngle, 100), quantize(dto.speed, 100)
+        };
+    }
+
     struct HeartbeatDto {
         std::string callsign;
         MSGPACK_DEFINE(callsign);
@@ -167,9 +205,13 @@ namespace xpilot {
         }
     };
 
+    // PluginVersionDto::capabilities; a plugin from before the field existed reports none
+    constexpr int PLUGIN_CAPABILITY_POSITION_DELTAS = 1 << 0; // understands FSTPOSD frames
+
     struct PluginVersionDto {
         int version;
-        MSGPACK_DEFINE(version);
+        int capabilities = 0;
+        MSGPACK_DEFINE(version, capabilities);
 
         static std::string getName() {
             return PLUGIN_VER;
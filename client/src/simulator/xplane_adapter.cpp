@@ -35,6 +35,9 @@
 using namespace xpilot;
 
 constexpr int HEARTBEAT_TIMEOUT_SECS = 15;
+constexpr int USER_AIRCRAFT_DATA_INTERVAL_MS = 50;
+constexpr int VISUAL_MACHINE_POLL_INTERVAL_MS = 250;
+constexpr int VISUAL_KEYFRAME_INTERVAL_MS = 5000;
 
 enum DataRef
 {
@@ -119,9 +122,7 @@ XplaneAdapter::XplaneAdapter(QObject* parent) : QObject(parent)
         qint64 now = QDateTime::currentSecsSinceEpoch();
 
         if(!m_initialHandshake || (now - m_lastUdpTimestamp) > HEARTBEAT_TIMEOUT_SECS) {
-            m_radioStackState = {};
-            m_userAircraftData = {};
-            m_userAircraftConfigData = {};
+            resetSimState();
 
             SubscribeDataRefs();
 
@@ -141,25 +142,30 @@ XplaneAdapter::XplaneAdapter(QObject* parent) : QObject(parent)
             if(!m_simConnected && m_validPluginVersion && m_validCsl) {
                 emit simConnectionStateChanged(true);
                 m_simConnected = true;
+
+                // signals are change-driven, so give every consumer a full snapshot once connected
+                m_radioStackStateDirty = true;
+                m_userAircraftDataDirty = true;
+                m_userAircraftConfigDataDirty = true;
+                emitPendingStateChanges(true);
             }
         }
     });
     m_heartbeatTimer.start(1000);
 
-    connect(&m_xplaneDataTimer, &QTimer::timeout, this, [&]{
-        emit userAircraftDataChanged(m_userAircraftData);
-        emit userAircraftConfigDataChanged(m_userAircraftConfigData);
-        emit radioStackStateChanged(m_radioStackState);
+    connect(&m_userAircraftDataTimer, &QTimer::timeout, this, [&]{
+        emitPendingStateChanges(true);
     });
-    m_xplaneDataTimer.start(50);
+    m_userAircraftDataTimer.start(USER_AIRCRAFT_DATA_INTERVAL_MS);
 }
 
 XplaneAdapter::~XplaneAdapter()
 {
-    for(auto &visualSocket : m_visualSockets) {
-        nng_close(visualSocket);
+    m_visualMachineTimer.stop();
+    for(auto &visualMachine : m_visualMachines) {
+        nng_close(visualMachine->socket);
     }
-    m_visualSockets.clear();
+    m_visualMachines.clear();
 
     m_keepSocketAlive = false;
     nng_close(m_socket);
@@ -421,26 +427,128 @@ void XplaneAdapter::setupNngSocket()
         }
     });
 
+    setupVisualMachineSockets();
+}
+
+void XplaneAdapter::setupVisualMachineSockets()
+{
     for(const QString &machine : qAsConst(AppConfig::getInstance()->VisualMachines)) {
 
-        nng_socket _visualSocket;
+        auto visualMachine = std::make_unique<VisualMachineConnection>();
         int result;
 
-        if((result = nng_pair1_open(&_visualSocket)) != 0) {
+        if((result = nng_pair1_open(&visualMachine->socket)) != 0) {
             emit nngSocketError(QString("Error opening visual machine socket: %1").arg(nng_strerror(result)));;
             continue;
         }
 
-        nng_setopt_int(_visualSocket, NNG_OPT_RECVBUF, 8192);
-        nng_setopt_int(_visualSocket, NNG_OPT_SENDBUF, 8192);
+        nng_setopt_int(visualMachine->socket, NNG_OPT_RECVBUF, 8192);
+        nng_setopt_int(visualMachine->socket, NNG_OPT_SENDBUF, 8192);
+
+        // every (re)connect restarts the delta stream from a keyframe
+        nng_pipe_notify(visualMachine->socket, NNG_PIPE_EV_ADD_POST, &XplaneAdapter::visualMachinePipeEvent, visualMachine.get());
+        nng_pipe_notify(visualMachine->socket, NNG_PIPE_EV_REM_POST, &XplaneAdapter::visualMachinePipeEvent, visualMachine.get());
 
         QString url = QString("tcp://%1:%2").arg(machine).arg(AppConfig::getInstance()->XplanePluginPort);
-        if((result = nng_dial(_visualSocket, url.toStdString().c_str(), NULL, NNG_FLAG_NONBLOCK)) != 0) {
+        if((result = nng_dial(visualMachine->socket, url.toStdString().c_str(), NULL, NNG_FLAG_NONBLOCK)) != 0) {
             emit nngSocketError(QString("Error dialing visual machine socket (%1): %2").arg(url, nng_strerror(result)));;
+            nng_close(visualMachine->socket);
             continue;
         }
 
-        m_visualSockets.push_back(_visualSocket);
+        m_visualMachines.push_back(std::move(visualMachine));
+    }
+
+    if(!m_visualMachines.empty()) {
+        connect(&m_visualMachineTimer, &QTimer::timeout, this, &XplaneAdapter::pollVisualMachineSockets);
+        m_visualMachineTimer.start(VISUAL_MACHINE_POLL_INTERVAL_MS);
+    }
+}
+
+void XplaneAdapter::visualMachinePipeEvent(nng_pipe, nng_pipe_ev, void *arg)
+{
+    static_cast<VisualMachineConnection*>(arg)->pipeGeneration++;
+}
+
+void XplaneAdapter::resyncVisualMachine(VisualMachineConnection &visualMachine)
+{
+    const uint32_t generation = visualMachine.pipeGeneration.load();
+    if(generation == visualMachine.syncedGeneration)
+        return;
+    visualMachine.syncedGeneration = generation;
+
+    // the remote plugin drops its baselines whenever the pipe changes, so fall back to full frames
+    // until it has told us again that it understands delta frames; every aircraft then starts with a keyframe
+    visualMachine.deltaEnabled = false;
+    visualMachine.positions.clear();
+
+    PluginVersionDto dto{};
+    sendDtoToSocket(visualMachine.socket, dto);
+}
+
+void XplaneAdapter::pollVisualMachineSockets()
+{
+    for(auto &visualMachine : m_visualMachines) {
+        resyncVisualMachine(*visualMachine);
+
+        char* buffer;
+        size_t bufferLen;
+        while(nng_recv(visualMachine->socket, &buffer, &bufferLen, NNG_FLAG_ALLOC | NNG_FLAG_NONBLOCK) == 0) {
+            try {
+                BaseDto packet;
+                auto obj = msgpack::unpack(reinterpret_cast<const char*>(buffer), bufferLen);
+                obj.get().convert(packet);
+
+                if(packet.type == dto::PLUGIN_VER) {
+                    PluginVersionDto dto{};
+                    packet.dto.convert(dto);
+                    visualMachine->deltaEnabled = AppConfig::getInstance()->VisualMachineDeltaEncoding
+                            && (dto.capabilities & PLUGIN_CAPABILITY_POSITION_DELTAS) != 0;
+                }
+            }
+            catch(...) {}
+
+            nng_free(buffer, bufferLen);
+        }
+    }
+}
+
+void XplaneAdapter::sendVisualPositionUpdate(VisualMachineConnection &visualMachine, const FastPositionUpdateDto &dto)
+{
+    // don't wait for the next poll: a delta against a baseline from the previous pipe would be misapplied
+    resyncVisualMachine(visualMachine);
+
+    if(!visualMachine.deltaEnabled) {
+        sendDtoToSocket(visualMachine.socket, dto);
+        return;
+    }
+
+    const QuantizedPosition position = quantizePosition(dto);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    auto it = visualMachine.positions.find(dto.callsign);
+    if(it == visualMachine.positions.end() || (now - it->second.keyframeTimestamp) > VISUAL_KEYFRAME_INTERVAL_MS) {
+        // keyframe: the plugin quantizes the full frame the same way to establish its baseline
+        if(sendDtoToSocket(visualMachine.socket, dto)) {
+            visualMachine.positions[dto.callsign] = { position, now };
+        } else {
+            visualMachine.positions.erase(dto.callsign);
+        }
+        return;
+    }
+
+    FastPositionDeltaDto delta{};
+    delta.callsign = dto.callsign;
+    delta.delta.resize(QUANTIZED_POSITION_FIELDS);
+    for(size_t i = 0; i < QUANTIZED_POSITION_FIELDS; i++) {
+        delta.delta[i] = position[i] - it->second.position[i];
+    }
+
+    if(sendDtoToSocket(visualMachine.socket, delta)) {
+        it->second.position = position;
+    } else {
+        // the baseline is now ambiguous, start over with a keyframe
+        visualMachine.positions.erase(it);
     }
 }
 
@@ -500,35 +608,35 @@ void XplaneAdapter::OnDataReceived()
             switch(f[i].idx)
             {
                 case DataRef::AvionicsPower:
-                    m_radioStackState.AvionicsPowerOn = value;
+                    updateField(m_radioStackState.AvionicsPowerOn, value, m_radioStackStateDirty);
                     break;
                 case DataRef::AudioComSelection:
                     if(value == 6) {
-                        m_radioStackState.Com1TransmitEnabled = true;
-                        m_radioStackState.Com2TransmitEnabled = false;
+                        updateField(m_radioStackState.Com1TransmitEnabled, true, m_radioStackStateDirty);
+                        updateField(m_radioStackState.Com2TransmitEnabled, false, m_radioStackStateDirty);
                     } else if(value == 7) {
-                        m_radioStackState.Com1TransmitEnabled = false;
-                        m_radioStackState.Com2TransmitEnabled = true;
+                        updateField(m_radioStackState.Com1TransmitEnabled, false, m_radioStackStateDirty);
+                        updateField(m_radioStackState.Com2TransmitEnabled, true, m_radioStackStateDirty);
                     }
                     break;
                 case DataRef::Com1AudioSelection:
-                    m_radioStackState.Com1ReceiveEnabled = value;
+                    updateField(m_radioStackState.Com1ReceiveEnabled, value, m_radioStackStateDirty);
                     break;
                 case DataRef::Com2AudioSelection:
-                    m_radioStackState.Com2ReceiveEnabled = value;
+                    updateField(m_radioStackState.Com2ReceiveEnabled, value, m_radioStackStateDirty);
                     break;
                 case DataRef::Com1Frequency:
-                    m_radioStackState.Com1Frequency = value;
+                    updateField(m_radioStackState.Com1Frequency, value, m_radioStackStateDirty);
                     break;
                 case DataRef::Com2Frequency:
-                    m_radioStackState.Com2Frequency = value;
+                    updateField(m_radioStackState.Com2Frequency, value, m_radioStackStateDirty);
                     break;
                 case DataRef::Com1Volume:
                     {
                         int volume = qRound(value * 100);
                         volume = (volume > 100) ? 100 : volume;
                         volume = (volume < 0) ? 0 : volume;
-                        m_radioStackState.Com1Volume = volume;
+                        updateField(m_radioStackState.Com1Volume, volume, m_radioStackStateDirty);
                     }
                     break;
                 case DataRef::Com2Volume:
@@ -536,125 +644,125 @@ void XplaneAdapter::OnDataReceived()
                         int volume = qRound(value * 100);
                         volume = (volume > 100) ? 100 : volume;
                         volume = (volume < 0) ? 0 : volume;
-                        m_radioStackState.Com2Volume = volume;
+                        updateField(m_radioStackState.Com2Volume, volume, m_radioStackStateDirty);
                     }
                     break;
                 case DataRef::TransponderIdent:
-                    m_radioStackState.SquawkingIdent = value;
+                    updateField(m_radioStackState.SquawkingIdent, value, m_radioStackStateDirty);
                     break;
                 case DataRef::TransponderMode:
-                    m_radioStackState.SquawkingModeC = value >= 2;
+                    updateField(m_radioStackState.SquawkingModeC, value >= 2, m_radioStackStateDirty);
                     break;
                 case DataRef::TransponderCode:
-                    m_radioStackState.TransponderCode = value;
+                    updateField(m_radioStackState.TransponderCode, value, m_radioStackStateDirty);
                     break;
                 case DataRef::Latitude:
-                    m_userAircraftData.Latitude = value;
+                    updateField(m_userAircraftData.Latitude, value, m_userAircraftDataDirty);
                     break;
                 case DataRef::Longitude:
-                    m_userAircraftData.Longitude = value;
+                    updateField(m_userAircraftData.Longitude, value, m_userAircraftDataDirty);
                     break;
                 case DataRef::Heading:
-                    m_userAircraftData.Heading = value;
+                    updateField(m_userAircraftData.Heading, value, m_userAircraftDataDirty);
                     break;
                 case DataRef::Pitch:
-                    m_userAircraftData.Pitch = value;
+                    updateField(m_userAircraftData.Pitch, value, m_userAircraftDataDirty);
                     break;
                 case DataRef::Bank:
-                    m_userAircraftData.Bank = value;
+                    updateField(m_userAircraftData.Bank, value, m_userAircraftDataDirty);
                     break;
                 case DataRef::AltitudeMsl:
-                    m_userAircraftData.AltitudeMslM = value;
+                    updateField(m_userAircraftData.AltitudeMslM, value, m_userAircraftDataDirty);
                     break;
                 case DataRef::AltitudeAgl:
-                    m_userAircraftData.AltitudeAglM = value;
+                    updateField(m_userAircraftData.AltitudeAglM, value, m_userAircraftDataDirty);
                     break;
                 case DataRef::AltitudePressure:
-                    m_userAircraftData.AltitudePressure = value;
+                    updateField(m_userAircraftData.AltitudePressure, value, m_userAircraftDataDirty);
                     break;
                 case DataRef::BarometerSeaLevel:
-                    m_userAircraftData.BarometerSeaLevel = value * 33.8639; // inHg to millibar
+                    updateField(m_userAircraftData.BarometerSeaLevel, value * 33.8639, m_userAircraftDataDirty); // inHg to millibar
                     break;
                 case DataRef::AltimeterTemperatureError:
-                    m_userAircraftData.AltimeterTemperatureError = value;
+                    updateField(m_userAircraftData.AltimeterTemperatureError, value, m_userAircraftDataDirty);
                     break;
                 case DataRef::LatitudeVelocity:
-                    m_userAircraftData.LatitudeVelocity = value * -1.0;
+                    updateField(m_userAircraftData.LatitudeVelocity, value * -1.0, m_userAircraftDataDirty);
                     break;
                 case DataRef::AltitudeVelocity:
-                    m_userAircraftData.AltitudeVelocity = value;
+                    updateField(m_userAircraftData.AltitudeVelocity, value, m_userAircraftDataDirty);
                     break;
                 case DataRef::LongitudeVelocity:
-                    m_userAircraftData.LongitudeVelocity = value;
+                    updateField(m_userAircraftData.LongitudeVelocity, value, m_userAircraftDataDirty);
                     break;
                 case DataRef::PitchVelocity:
-                    m_userAircraftData.PitchVelocity = value * -1.0;
+                    updateField(m_userAircraftData.PitchVelocity, value * -1.0, m_userAircraftDataDirty);
                     break;
                 case DataRef::HeadingVelocity:
-                    m_userAircraftData.HeadingVelocity = value;
+                    updateField(m_userAircraftData.HeadingVelocity, value, m_userAircraftDataDirty);
                     break;
                 case DataRef::BankVelocity:
-                    m_userAircraftData.BankVelocity = value * -1.0;
+                    updateField(m_userAircraftData.BankVelocity, value * -1.0, m_userAircraftDataDirty);
                     break;
                 case DataRef::GroundSpeed:
-                    m_userAircraftData.GroundSpeed = value * 1.94384; // mps -> knots
+                    updateField(m_userAircraftData.GroundSpeed, value * 1.94384, m_userAircraftDataDirty); // mps -> knots
                     break;
                 case DataRef::BeaconLights:
-                    m_userAircraftConfigData.BeaconOn = value;
+                    updateField(m_userAircraftConfigData.BeaconOn, value, m_userAircraftConfigDataDirty);
                     break;
                 case DataRef::LandingLights:
-                    m_userAircraftConfigData.LandingLightsOn = value;
+                    updateField(m_userAircraftConfigData.LandingLightsOn, value, m_userAircraftConfigDataDirty);
                     break;
                 case DataRef::TaxiLights:
-                    m_userAircraftConfigData.TaxiLightsOn = value;
+                    updateField(m_userAircraftConfigData.TaxiLightsOn, value, m_userAircraftConfigDataDirty);
                     break;
                 case DataRef::NavLights:
-                    m_userAircraftConfigData.NavLightsOn = value;
+                    updateField(m_userAircraftConfigData.NavLightsOn, value, m_userAircraftConfigDataDirty);
                     break;
                 case DataRef::StrobeLights:
-                    m_userAircraftConfigData.StrobesOn = value;
+                    updateField(m_userAircraftConfigData.StrobesOn, value, m_userAircraftConfigDataDirty);
                     break;
                 case DataRef::EngineCount:
-                    m_userAircraftConfigData.EngineCount = value;
+                    updateField(m_userAircraftConfigData.EngineCount, value, m_userAircraftConfigDataDirty);
                     break;
                 case DataRef::Engine1Running:
-                    m_userAircraftConfigData.Engine1Running = value;
+                    updateField(m_userAircraftConfigData.Engine1Running, value, m_userAircraftConfigDataDirty);
                     break;
                 case DataRef::Engine2Running:
-                    m_userAircraftConfigData.Engine2Running = value;
+                    updateField(m_userAircraftConfigData.Engine2Running, value, m_userAircraftConfigDataDirty);
                     break;
                 case DataRef::Engine3Running:
-                    m_userAircraftConfigData.Engine3Running = value;
+                    updateField(m_userAircraftConfigData.Engine3Running, value, m_userAircraftConfigDataDirty);
                     break;
                 case DataRef::Engine4Running:
-                    m_userAircraftConfigData.Engine4Running = value;
+                    updateField(m_userAircraftConfigData.Engine4Running, value, m_userAircraftConfigDataDirty);
                     break;
                 case DataRef::Engine1Reversing:
-                    m_userAircraftConfigData.Engine1Reversing = (value == 3);
+                    updateField(m_userAircraftConfigData.Engine1Reversing, (value == 3), m_userAircraftConfigDataDirty);
                     break;
                 case DataRef::Engine2Reversing:
-                    m_userAircraftConfigData.Engine2Reversing = (value == 3);
+                    updateField(m_userAircraftConfigData.Engine2Reversing, (value == 3), m_userAircraftConfigDataDirty);
                     break;
                 case DataRef::Engine3Reversing:
-                    m_userAircraftConfigData.Engine3Reversing = (value == 3);
+                    updateField(m_userAircraftConfigData.Engine3Reversing, (value == 3), m_userAircraftConfigDataDirty);
                     break;
                 case DataRef::Engine4Reversing:
-                    m_userAircraftConfigData.Engine4Reversing = (value == 3);
+                    updateField(m_userAircraftConfigData.Engine4Reversing, (value == 3), m_userAircraftConfigDataDirty);
                     break;
                 case DataRef::OnGround:
-                    m_userAircraftConfigData.OnGround = value;
+                    updateField(m_userAircraftConfigData.OnGround, value, m_userAircraftConfigDataDirty);
                     break;
                 case DataRef::GearDown:
-                    m_userAircraftConfigData.GearDown = value;
+                    updateField(m_userAircraftConfigData.GearDown, value, m_userAircraftConfigDataDirty);
                     break;
                 case DataRef::FlapRatio:
-                    m_userAircraftConfigData.FlapsRatio = value;
+                    updateField(m_userAircraftConfigData.FlapsRatio, value, m_userAircraftConfigDataDirty);
                     break;
                 case DataRef::SpeedbrakeRatio:
-                    m_userAircraftConfigData.SpeedbrakeRatio = value;
+                    updateField(m_userAircraftConfigData.SpeedbrakeRatio, value, m_userAircraftConfigDataDirty);
                     break;
                 case DataRef::NoseWheelAngle:
-                    m_userAircraftData.NoseWheelAngle = value;
+                    updateField(m_userAircraftData.NoseWheelAngle, value, m_userAircraftDataDirty);
                     break;
                 case DataRef::ReplayMode:
                     if(value > 0) {
@@ -676,7 +784,7 @@ void XplaneAdapter::OnDataReceived()
                     }
                     break;
                 case DataRef::SelcalMuteOverride:
-                    m_radioStackState.SelcalMuteOverride = value > 0;
+                    updateField(m_radioStackState.SelcalMuteOverride, value > 0, m_radioStackStateDirty);
                     break;
                 case DataRef::XplaneVersionNumber:
                     SKIP_EMPTY(value);
@@ -700,7 +808,49 @@ void XplaneAdapter::OnDataReceived()
                     break;
             }
         }
+
+        // radio and configuration changes are infrequent, so deliver them as soon as the datagram
+        // has been applied; position data is delivered by m_userAircraftDataTimer at its own rate
+        emitPendingStateChanges(false);
+    }
+}
+
+void XplaneAdapter::emitPendingStateChanges(bool includeUserAircraftData)
+{
+    if(m_radioStackStateDirty) {
+        m_radioStackStateDirty = false;
+        emit radioStackStateChanged(m_radioStackState);
+    }
+
+    if(m_userAircraftConfigDataDirty) {
+        m_userAircraftConfigDataDirty = false;
+        emit userAircraftConfigDataChanged(m_userAircraftConfigData);
+    }
+
+    if(includeUserAircraftData && m_userAircraftDataDirty) {
+        m_userAircraftDataDirty = false;
+        emit userAircraftDataChanged(m_userAircraftData);
+    }
+}
+
+void XplaneAdapter::resetSimState()
+{
+    if(m_radioStackState != RadioStackState{}) {
+        m_radioStackState = {};
+        m_radioStackStateDirty = true;
     }
+
+    if(m_userAircraftData != UserAircraftData{}) {
+        m_userAircraftData = {};
+        m_userAircraftDataDirty = true;
+    }
+
+    if(m_userAircraftConfigData != UserAircraftConfigData{}) {
+        m_userAircraftConfigData = {};
+        m_userAircraftConfigDataDirty = true;
+    }
+
+    emitPendingStateChanges(true);
 }
 
 void XplaneAdapter::requestPluginVersion()
@@ -808,9 +958,8 @@ void XplaneAdapter::setCom2OnHeadset(bool onHeadset)
 
 void XplaneAdapter::overrideRadioPower(bool hasPower)
 {
-    if(m_radioStackState.OverrideRadioPower != hasPower) {
-        m_radioStackState.OverrideRadioPower = hasPower;
-    }
+    updateField(m_radioStackState.OverrideRadioPower, hasPower, m_radioStackStateDirty);
+    emitPendingStateChanges(false);
 }
 
 void XplaneAdapter::setSplitAudioChannels(bool split)
@@ -908,12 +1057,20 @@ void XplaneAdapter::DeleteAircraft(const NetworkAircraft &aircraft, QString reas
     dto.callsign = aircraft.Callsign.toStdString();
     dto.reason = reason.toStdString();
     SendDto(dto);
+
+    for(auto &visualMachine : m_visualMachines) {
+        visualMachine->positions.erase(dto.callsign);
+    }
 }
 
 void XplaneAdapter::DeleteAllAircraft()
 {
     DeleteAllAircraftDto dto{};
     SendDto(dto);
+
+    for(auto &visualMachine : m_visualMachines) {
+        visualMachine->positions.clear();
+    }
 }
 
 void XplaneAdapter::UpdateControllers(QList<Controller> &controllers)
@@ -959,8 +1116,20 @@ void XplaneAdapter::SendFastPositionUpdate(const NetworkAircraft &aircraft, cons
     dto.vb = rotationalVelocityVector.Z;
     dto.noseWheelAngle = visualState.NoseWheelAngle;
     dto.speed = aircraft.Speed;
+    dto.fsdReceiveTime = visualState.ReceivedTimestamp;
+    dto.ipcSendTime = QDateTime::currentMSecsSinceEpoch();
+    dto.clientSendFailures = m_sendFailures;
+
+    msgpack::sbuffer dtoBuf;
+    if(encodeDto(dtoBuf, dto) && dtoBuf.size() > 0) {
+        if(nng_send(m_socket, dtoBuf.data(), dtoBuf.size(), NNG_FLAG_NONBLOCK) != 0) {
+            m_sendFailures++;
+        }
+    }
 
-    SendDto(dto);
+    for(auto &visualMachine : m_visualMachines) {
+        sendVisualPositionUpdate(*visualMachine, dto);
+    }
 }
 
 void XplaneAdapter::SendHeartbeat(const QString callsign)
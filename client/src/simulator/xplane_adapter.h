@@ -29,6 +29,7 @@
 #include <vector>
 #include <thread>
 #include <deque>
+#include <atomic>
 
 #include <QObject>
 #include <QUdpSocket>
@@ -100,6 +101,7 @@ public:
     void DisableVoiceTransmit() { m_voiceTransmitDisabled = true; }
     void EnableVoiceTransmit() { m_voiceTransmitDisabled = false; }
     int XplaneVersion() const { return m_xplaneVersion; }
+    RadioStackState CurrentRadioStackState() const { return m_radioStackState; }
 
 private:
     void SubscribeDataRefs();
@@ -108,6 +110,8 @@ private:
     void sendCommand(std::string command);
 
     void setupNngSocket();
+    void setupVisualMachineSockets();
+    void pollVisualMachineSockets();
     void processMessage(QString message);
     void processPacket(const BaseDto& packet);
     void clearSimConnection();
@@ -115,6 +119,19 @@ private:
     void requestPluginVersion();
     void validateCsl();
 
+    void emitPendingStateChanges(bool includeUserAircraftData);
+    void resetSimState();
+
+    template<typename T, typename V>
+    static void updateField(T& field, V value, bool& dirty)
+    {
+        T newValue = static_cast<T>(value);
+        if(field != newValue) {
+            field = newValue;
+            dirty = true;
+        }
+    }
+
 public slots:
     void OnDataReceived();
 
@@ -166,10 +183,13 @@ private:
     UserAircraftData m_userAircraftData{};
     UserAircraftConfigData m_userAircraftConfigData{};
     RadioStackState m_radioStackState{};
+    bool m_userAircraftDataDirty = false;
+    bool m_userAircraftConfigDataDirty = false;
+    bool m_radioStackStateDirty = false;
 
     QList<QString> m_ignoreList;
     QTimer m_heartbeatTimer;
-    QTimer m_xplaneDataTimer;
+    QTimer m_userAircraftDataTimer;
 
     QList<QString> m_subscribedDataRefs;
 
@@ -185,7 +205,37 @@ private:
     bool m_keepSocketAlive = false;
     std::unique_ptr<std::thread> m_socketThread;
     nng_socket m_socket;
-    QList<nng_socket> m_visualSockets;
+    uint64_t m_sendFailures = 0;
+
+    struct VisualPositionState {
+        QuantizedPosition position;
+        qint64 keyframeTimestamp;
+    };
+
+    struct VisualMachineConnection {
+        nng_socket socket;
+        std::atomic<uint32_t> pipeGeneration{0}; // bumped from the nng pipe callback on every connect and disconnect
+        uint32_t syncedGeneration = 0; // pipeGeneration that deltaEnabled and positions belong to
+        bool deltaEnabled = false;
+        std::map<std::string, VisualPositionState> positions;
+    };
+
+    std::vector<std::unique_ptr<VisualMachineConnection>> m_visualMachines;
+    QTimer m_visualMachineTimer;
+
+    static void visualMachinePipeEvent(nng_pipe pipe, nng_pipe_ev event, void* arg);
+    void resyncVisualMachine(VisualMachineConnection& visualMachine);
+    void sendVisualPositionUpdate(VisualMachineConnection& visualMachine, const FastPositionUpdateDto& dto);
+
+    template<class T>
+    static bool sendDtoToSocket(nng_socket socket, const T& dto)
+    {
+        msgpack::sbuffer dtoBuf;
+        if (!encodeDto(dtoBuf, dto) || dtoBuf.size() == 0)
+            return false;
+
+        return nng_send(socket, dtoBuf.data(), dtoBuf.size(), NNG_FLAG_NONBLOCK) == 0;
+    }
 
     template<class T>
     void SendDto(const T& dto)
@@ -197,10 +247,12 @@ private:
                 return;
 
             std::vector<unsigned char> dgBuffer(dtoBuf.data(), dtoBuf.data() + dtoBuf.size());
-            nng_send(m_socket, reinterpret_cast<char*>(dgBuffer.data()), dgBuffer.size(), NNG_FLAG_NONBLOCK);
+            if(nng_send(m_socket, reinterpret_cast<char*>(dgBuffer.data()), dgBuffer.size(), NNG_FLAG_NONBLOCK) != 0) {
+                m_sendFailures++;
+            }
 
-            for(auto &visualSocket : m_visualSockets) {
-                nng_send(visualSocket, reinterpret_cast<char*>(dgBuffer.data()), dgBuffer.size(), NNG_FLAG_NONBLOCK);
+            for(auto &visualMachine : m_visualMachines) {
+                nng_send(visualMachine->socket, reinterpret_cast<char*>(dgBuffer.data()), dgBuffer.size(), NNG_FLAG_NONBLOCK);
             }
         }
     }
@@ -0,0 +1,141 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#pragma once
+
+// Shared by the plugin and the client; plain C++17 so it builds in both trees.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace xpilot
+{
+	/// Hashed timer wheel for per-key deadlines that are re-armed much more often than they fire,
+	/// such as "no update received for n seconds". Arm() drops an entry into the slot of the deadline's
+	/// tick; re-arming leaves the earlier entry behind, and it is discarded when its slot comes round.
+	/// Advance() only visits the slots of elapsed ticks, so expiry costs O(expired + re-arms) instead
+	/// of a scan over every key. Deadlines are rounded up to the next tick, so keys may expire up to
+	/// one tick late but never early. Not thread safe.
+	template<typename Key, typename Hash = std::hash<Key>>
+	class ExpiryWheel
+	{
+	public:
+		/// tickLength and deadlines share a unit (both the plugin and the client use milliseconds);
+		/// deadlines further out than tickLength * slotCount cost an extra visit per revolution
+		ExpiryWheel(int64_t tickLength, size_t slotCount) :
+			m_tickLength(tickLength),
+			m_slots(slotCount)
+		{
+		}
+
+		/// Sets the deadline of key, replacing any earlier one
+		void Arm(const Key& key, int64_t deadline)
+		{
+			int64_t tick = deadline / m_tickLength + 1;
+			if (m_started && tick <= m_currentTick)
+			{
+				tick = m_currentTick + 1; // that slot was already visited
+			}
+
+			auto [it, inserted] = m_deadlines.try_emplace(key, tick);
+			if (!inserted)
+			{
+				if (it->second == tick)
+					return;
+				it->second = tick;
+			}
+			m_slots[SlotOf(tick)].push_back({ key, tick });
+		}
+
+		void Cancel(const Key& key)
+		{
+			m_deadlines.erase(key);
+		}
+
+		void Clear()
+		{
+			m_deadlines.clear();
+			for (auto& slot : m_slots)
+			{
+				slot.clear();
+			}
+		}
+
+		/// Appends every key whose deadline has passed by now to expired, and forgets it
+		void Advance(int64_t now, std::vector<Key>& expired)
+		{
+			const int64_t nowTick = now / m_tickLength;
+			const int64_t slotCount = static_cast<int64_t>(m_slots.size());
+			const int64_t steps = m_started ? std::min(nowTick - m_currentTick, slotCount) : slotCount;
+			m_started = true;
+			m_currentTick = std::max(m_currentTick, nowTick);
+
+			for (int64_t tick = nowTick - steps + 1; tick <= nowTick; tick++)
+			{
+				auto& slot = m_slots[SlotOf(tick)];
+				size_t kept = 0;
+				for (size_t i = 0; i < slot.size(); i++)
+				{
+					const auto it = m_deadlines.find(slot[i].Id);
+					if (it == m_deadlines.end() || it->second != slot[i].Tick)
+						continue; // cancelled or re-armed since
+
+					if (slot[i].Tick <= nowTick)
+					{
+						expired.push_back(slot[i].Id);
+						m_deadlines.erase(it);
+						continue;
+					}
+
+					if (kept != i)
+					{
+						slot[kept] = std::move(slot[i]);
+					}
+					kept++; // due on a later revolution
+				}
+				slot.resize(kept);
+			}
+		}
+
+		/// Number of armed keys
+		size_t Size() const { return m_deadlines.size(); }
+
+	private:
+		struct Entry
+		{
+			Key Id;
+			int64_t Tick;
+		};
+
+		size_t SlotOf(int64_t tick) const
+		{
+			const int64_t slotCount = static_cast<int64_t>(m_slots.size());
+			return static_cast<size_t>(((tick % slotCount) + slotCount) % slotCount);
+		}
+
+		int64_t m_tickLength;
+		std::vector<std::vector<Entry>> m_slots;
+		std::unordered_map<Key, int64_t, Hash> m_deadlines; // key -> tick of its current deadline
+		int64_t m_currentTick = 0;
+		bool m_started = false;
+	};
+}
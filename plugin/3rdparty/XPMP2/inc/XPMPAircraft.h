@@ -800,6 +800,16 @@ protected:
 /// Find aircraft by its plane ID, can return nullptr
 XPMP2_EXPORT Aircraft* AcFindByID (XPMPPlaneID _id);
 
+/// @brief Matches a CSL model without creating an aircraft, pass the result to Aircraft::Create() to skip matching there
+/// @details Only reads the model list, so it may run on a worker thread
+///          as long as no CSL package is being loaded at the same time.
+/// @param[out] _pOutModel Receives the matching model, or `nullptr` if there are no models at all
+/// @return Match quality as per Aircraft::GetMatchQuality(), negative if there are no models
+XPMP2_EXPORT int ModelMatch (const std::string& _icaoType,
+                             const std::string& _icaoAirline,
+                             const std::string& _livery,
+                             CSLModel*& _pOutModel);
+
 /// (Re)Define default wake turbulence values per WTC
 XPMP2_EXPORT bool AcSetDefaultWakeData(const std::string& _wtc, const Aircraft::wakeTy& _wake);
 
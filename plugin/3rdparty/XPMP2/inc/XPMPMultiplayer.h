@@ -561,6 +561,36 @@ XPMP2_EXPORT bool XPMPHasControlOfAIAircraft();
 /// @param inCSLFolder Root folder to start the search.
 XPMP2_EXPORT const char *    XPMPLoadCSLPackage(const char * inCSLFolder);
 
+/// @brief Counts and timing of a CSL package load, filled by XPMPStageCSLPackage()
+struct XPMPCSLLoadStats_t {
+    int     numPkgFiles = 0;    ///< number of `xsb_aircraft.txt` files found
+    int     numModels   = 0;    ///< number of models read from them (before removing duplicates)
+    double  scanMs      = 0.0;  ///< time spent searching folders for `xsb_aircraft.txt` files
+    double  parseMs     = 0.0;  ///< time spent reading and processing the `xsb_aircraft.txt` files
+};
+
+/// @brief Progress callback for XPMPStageCSLPackage(), called after each processed `xsb_aircraft.txt` file
+/// @return `false` to stop loading any further files
+typedef bool (*XPMPCSLLoadProgressFuncTy)(int _filesDone, int _filesTotal, void* _refcon);
+
+/// @brief Loads CSL packages like XPMPLoadCSLPackage(), but into a staging catalogue
+/// @details Can be called from a worker thread: Folders are listed without XPLM calls there,
+///          and nothing the flight loop reads is modified. Once all staged loads have returned,
+///          call XPMPCommitStagedCSLPackages() from X-Plane's main thread to make the models available.
+/// @param inCSLFolder Root folder to start the search.
+/// @param[out] outStats Optional, receives counts and the time spent scanning and parsing
+/// @param inProgressFunc Optional, called after each `xsb_aircraft.txt` file, can stop the load
+/// @param inRefcon Passed through to `inProgressFunc`
+XPMP2_EXPORT const char* XPMPStageCSLPackage(const char* inCSLFolder,
+                                             XPMPCSLLoadStats_t* outStats = nullptr,
+                                             XPMPCSLLoadProgressFuncTy inProgressFunc = nullptr,
+                                             void* inRefcon = nullptr);
+
+/// @brief Adds the models read by XPMPStageCSLPackage() to the live catalogue
+/// @note Call from X-Plane's main thread, and not while XPMPStageCSLPackage() is running.
+/// @return Number of models added, duplicates of already known models are dropped
+XPMP2_EXPORT int XPMPCommitStagedCSLPackages();
+
 
 /// @brief Legacy function only provided for backwards compatibility. Does not actually do anything.
 [[deprecated("No longer needed, does not do anything.")]]
@@ -780,6 +810,37 @@ XPMP2_EXPORT void    XPMPSetDefaultPlaneICAO(const char* _acIcaoType,
 
 /// @}
 
+/************************************************************************************
+ * MARK: PROFILING
+ ************************************************************************************/
+
+/// @name Profiling
+/// @{
+
+/// Parts of XPMP2's per-frame work that are reported to a profiling callback
+enum XPMPProfileSection {
+    XPMP_PROFILE_UPDATE_POSITION = 0,   ///< all XPMP2::Aircraft::UpdatePosition() calls of one flight loop
+    XPMP_PROFILE_CLAMP_TO_GROUND,       ///< all XPMP2::Aircraft::ClampToGround() calls
+    XPMP_PROFILE_INSTANCES,             ///< moving instances and contrails
+    XPMP_PROFILE_SOUND,                 ///< sound updates
+    XPMP_PROFILE_REMOTE,                ///< feeding remote (XPMP2 Remote Client) connections
+    XPMP_PROFILE_AI_MULTI,              ///< publishing AI/multiplayer (TCAS) dataRefs
+    XPMP_PROFILE_LABELS,                ///< drawing labels, all draw callbacks since the previous flight loop
+    XPMP_PROFILE_COUNT
+};
+
+/// @brief Receives the time spent in one section
+/// @param inSection Section measured
+/// @param inMicroseconds Time spent in the section since the previous report
+/// @param inRefcon The refcon passed to XPMPSetProfileCallback()
+typedef void (*XPMPProfileCallback_f)(XPMPProfileSection inSection, double inMicroseconds, void* inRefcon);
+
+/// @brief Registers a callback that is called for every section at the end of each flight loop
+/// @details Sections are only timed while a callback is registered. Pass `nullptr` to stop profiling.
+XPMP2_EXPORT void XPMPSetProfileCallback (XPMPProfileCallback_f inCallback, void* inRefcon = nullptr);
+
+/// @}
+
 /************************************************************************************
  * MARK: PLANE OBSERVATION API
  ************************************************************************************/
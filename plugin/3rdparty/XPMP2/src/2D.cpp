@@ -197,6 +197,7 @@ int CPLabelDrawing (XPLMDrawingPhase     /*inPhase*/,
 {
     // Library entry point, catch all exceptions
     try {
+        ProfileScope prof(XPMP_PROFILE_LABELS);
         TwoDDrawLabels();
     }
     catch(const std::exception& e) {
@@ -282,6 +282,9 @@ void Aircraft::Create (const std::string& _icaoType,
             if (!_icaoType.empty())     acIcaoType = _icaoType;
             if (!_icaoAirline.empty())  acIcaoAirline = _icaoAirline;
             if (!_livery.empty())       acLivery = _livery;
+            // related group and map icon follow the type we were given, not the model's
+            acRelGrp = RelatedGet(REL_TXT_DESIGNATOR, acIcaoType);
+            MapFindIcon();
         }
     }
     
@@ -521,10 +524,16 @@ float Aircraft::FlightLoopCB(float _elapsedSinceLastCall, float, int _flCounter,
         glob.UpdateCameraPos();
 
         // give remote model the chance for some prep work
-        RemoteAcEnqueueStarts(now);
+        {
+            ProfileScope prof(XPMP_PROFILE_REMOTE);
+            RemoteAcEnqueueStarts(now);
+        }
 
         // Tell Sound module that we are about to start updaing
-        SoundUpdatesBegin();
+        {
+            ProfileScope prof(XPMP_PROFILE_SOUND);
+            SoundUpdatesBegin();
+        }
 
         // Update positional and configurational values
         for (mapAcTy::value_type& pair : glob.mapAc) {
@@ -537,12 +546,17 @@ float Aircraft::FlightLoopCB(float _elapsedSinceLastCall, float, int _flCounter,
                 continue;
             try {
                 // Have the aircraft provide up-to-date position and orientation values
-                ac.UpdatePosition(_elapsedSinceLastCall, _flCounter);
+                {
+                    ProfileScope prof(XPMP_PROFILE_UPDATE_POSITION);
+                    ac.UpdatePosition(_elapsedSinceLastCall, _flCounter);
+                }
                 // A/c still valid? Then proceed:
                 if (ac.IsValid()) {
                     // If requested, clamp to ground, ie. make sure it is not below ground
-                    if (ac.bClampToGround || glob.bClampAll)
+                    if (ac.bClampToGround || glob.bClampAll) {
+                        ProfileScope prof(XPMP_PROFILE_CLAMP_TO_GROUND);
                         ac.ClampToGround();
+                    }
                     // Do some expensive stuff every second only
                     ac.DoEverySecondUpdates(now);
                     // If required reset touch down animation
@@ -553,6 +567,7 @@ float Aircraft::FlightLoopCB(float _elapsedSinceLastCall, float, int _flCounter,
                     // Actually move the plane, ie. the instance that represents it
                     ac.DoMove();
                     // Feed remote connections
+                    ProfileScope prof(XPMP_PROFILE_REMOTE);
                     RemoteAcEnqueue(ac);
                 }
             }
@@ -560,13 +575,25 @@ float Aircraft::FlightLoopCB(float _elapsedSinceLastCall, float, int _flCounter,
         }
         
         // Tell remote module that we are done updated a/c so it can send out last pending messages
-        RemoteAcEnqueueDone();
+        {
+            ProfileScope prof(XPMP_PROFILE_REMOTE);
+            RemoteAcEnqueueDone();
+        }
         
         // Tell Sound module that we are done updating
-        SoundUpdatesDone();
+        {
+            ProfileScope prof(XPMP_PROFILE_SOUND);
+            SoundUpdatesDone();
+        }
         
         // Publish aircraft data on the AI/multiplayer dataRefs
-        AIMultiUpdate();
+        {
+            ProfileScope prof(XPMP_PROFILE_AI_MULTI);
+            AIMultiUpdate();
+        }
+        
+        // Hand this flight loop's timings to the profiling callback, if any
+        ProfileReport();
     }
     catch (const std::exception& e) {
         LOG_MSG(logFATAL, ERR_EXCEPTION, e.what());
@@ -593,12 +620,16 @@ void Aircraft::DoMove ()
     if (IsRendered()) {
         // Already have instances? 
         if (!listInst.empty() || CreateInstances()) {
-            // Move the instances (this is probably the single most important line of code ;-) )
-            for (XPLMInstanceRef hInst: listInst)
-                 XPLMInstanceSetPosition(hInst, &drawInfo, v.data());
-            // Move/create contrails
-            ContrailMove();
+            {
+                ProfileScope prof(XPMP_PROFILE_INSTANCES);
+                // Move the instances (this is probably the single most important line of code ;-) )
+                for (XPLMInstanceRef hInst: listInst)
+                     XPLMInstanceSetPosition(hInst, &drawInfo, v.data());
+                // Move/create contrails
+                ContrailMove();
+            }
             // Update Sound
+            ProfileScope prof(XPMP_PROFILE_SOUND);
             SoundUpdate();
         }
     }
@@ -1116,6 +1147,15 @@ Aircraft* AcFindByID (XPMPPlaneID _id)
     }
 }
 
+// Match a CSL model without creating an aircraft
+int ModelMatch (const std::string& _icaoType,
+                const std::string& _icaoAirline,
+                const std::string& _livery,
+                CSLModel*& _pOutModel)
+{
+    return CSLModelMatching(_icaoType, _icaoAirline, _livery, _pOutModel);
+}
+
 // (Re)Define default wake turbulence values per WTC
 bool AcSetDefaultWakeData(const std::string& _wtc, const Aircraft::wakeTy& _wake)
 {
@@ -67,6 +67,39 @@ constexpr float GARBAGE_COLLECTION_TIMEOUT = 180.0f;
 /// a map of a text and a counter
 typedef std::map<std::string, int> mapStrIntTy;
 
+/// Catalogue filled by CSLModelsStage(), possibly on a worker thread, until CSLModelsCommitStaged() merges it
+struct CSLStagingTy {
+    std::mutex          mtx;            ///< held while loading into or committing the staged maps
+    mapCSLPackageTy     mapPkgs;        ///< packages found by staged loads
+    mapCSLModelTy       mapModels;      ///< models read by staged loads
+} gStaging;
+
+/// Is the current thread loading into gStaging instead of the live catalogue?
+thread_local bool gbLoadStaged = false;
+
+/// The model map the current thread's load writes to
+inline mapCSLModelTy& LoadModels ()
+{ return gbLoadStaged ? gStaging.mapModels : glob.mapCSLModels; }
+
+/// The package map the current thread's load writes to
+inline mapCSLPackageTy& LoadPkgs ()
+{ return gbLoadStaged ? gStaging.mapPkgs : glob.mapCSLPkgs; }
+
+/// @brief Find a package's base path, staged packages included during a staged load
+/// @note The live package map is only written by loads, so reading it from a staged load is safe
+const std::string* LoadFindPkg (const std::string& pkg)
+{
+    auto iter = glob.mapCSLPkgs.find(pkg);
+    if (iter != glob.mapCSLPkgs.cend())
+        return &iter->second;
+    if (gbLoadStaged) {
+        iter = gStaging.mapPkgs.find(pkg);
+        if (iter != gStaging.mapPkgs.cend())
+            return &iter->second;
+    }
+    return nullptr;
+}
+
 //
 // MARK: CSL Model Info implementation
 //       A small public structure to pass back CSL model information to the calling plugin
@@ -581,8 +614,8 @@ std::string CSLModelsConvPackagePath (const std::string& pkgPath,
     
     // Let's try finding the full path for the package
     const std::string pkg(pkgPath.substr(0,pos));
-    const auto pkgIter = glob.mapCSLPkgs.find(pkg);
-    if (pkgIter == glob.mapCSLPkgs.cend()) {
+    const std::string* pPkgBase = LoadFindPkg(pkg);
+    if (!pPkgBase) {
         LOG_MSG(logERR, ERR_PKG_UNKNOWN, lnNr, pkg.c_str(), StripXPSysDir(pkgPath).c_str());
         return "";
     }
@@ -594,14 +627,14 @@ std::string CSLModelsConvPackagePath (const std::string& pkgPath,
     std::replace_if(relFilePath.begin(), relFilePath.end(),
                     [](char c)
                     {
-                        if (c == XPLMGetDirectorySeparator()[0])        // don't touch correct directory separator
+                        if (c == glob.dirSep)                           // don't touch correct directory separator
                             return false;
                         return c==':' || c=='\\' || c=='/';             // but do touch all others
                     },
-                    XPLMGetDirectorySeparator()[0]);    // replace with 'correct' dir separator
+                    glob.dirSep);    // replace with 'correct' dir separator
 
     // Full path is package path plus relative path
-    std::string path = pkgIter->second + relFilePath;
+    std::string path = *pPkgBase + relFilePath;
     
     // We do check here already if that target really exists
     if (!ExistsFile(TOPOSIX(path))) {
@@ -620,7 +653,7 @@ void CSLModelsAdd (CSLModel& _csl)
 {
     // the main map, which actually "owns" the object, indexed by key
     const std::string cslKey = _csl.GetKeyString();
-    auto p = glob.mapCSLModels.emplace(cslKey, std::move(_csl));
+    auto p = LoadModels().emplace(cslKey, std::move(_csl));
     if (!p.second) {                    // not inserted, ie. not a new entry!
         LOG_MSG(logWARN, WARN_DUP_MODEL, p.first->second.GetModelName().c_str(),
                 p.first->second.xsbAircraftLn,
@@ -637,7 +670,7 @@ void CSLModelsAdd (CSLModel& _csl)
 const char* CSLModelsReadPkgId (const std::string& path)
 {
     // Open the xsb_aircraft.txt file
-    const std::string xsbName (path + XPLMGetDirectorySeparator()[0] + XSB_AIRCRAFT_TXT);
+    const std::string xsbName (path + glob.dirSep + XSB_AIRCRAFT_TXT);
     std::ifstream fAc (TOPOSIX(xsbName));
     if (!fAc || !fAc.is_open())
         return WARN_NO_XSBACTXT_FOUND;
@@ -661,12 +694,13 @@ const char* CSLModelsReadPkgId (const std::string& path)
             tokens[0] == "EXPORT_NAME")
         {
             // Found a package id -> save an entry for a package
-            auto p = glob.mapCSLPkgs.insert(std::make_pair(tokens[1], path + XPLMGetDirectorySeparator()[0]));
-            if (!p.second) {                // not inserted, ie. package name existed already?
+            const std::string* pKnownPath = LoadFindPkg(tokens[1]);
+            if (pKnownPath) {               // package name existed already?
                 LOG_MSG(logWARN, WARN_DUP_PKG_NAME,
                         tokens[1].c_str(), StripXPSysDir(path).c_str(),
-                        p.first->second.c_str());
+                        pKnownPath->c_str());
             } else {
+                LoadPkgs().emplace(tokens[1], path + glob.dirSep);
                 LOG_MSG(logDEBUG, "Added package '%s' from %s",
                         tokens[1].c_str(), StripXPSysDir(path).c_str());
             }
@@ -702,7 +736,7 @@ const char* CSLModelsFindPkgs (const std::string& _path,
     if (_maxDepth > 0) {
         // The let's see if there were some directories
         for (const std::string& f: files) {
-            const std::string nextPath(_path + XPLMGetDirectorySeparator()[0] + f);
+            const std::string nextPath(_path + glob.dirSep + f);
             if (IsDir(TOPOSIX(nextPath))) {
                 // recuresively call myself, allow one level of hierarchy less
                 const char* res = CSLModelsFindPkgs(nextPath, paths, _maxDepth-1);
@@ -733,7 +767,7 @@ void AcTxtLine_DEPENDENCY (std::vector<std::string>& tokens,
 {
     if (tokens.size() >= 2) {
         // We try finding the package and issue a warning if we didn't...but continue anyway
-        if (glob.mapCSLPkgs.find(tokens[1]) == glob.mapCSLPkgs.cend()) {
+        if (!LoadFindPkg(tokens[1])) {
             LOG_MSG(logWARN, WARN_PKG_DPDCY_FAILED, lnNr, tokens[1].c_str());
         }
     }
@@ -917,7 +951,7 @@ const char* CSLModelsProcessAcFile (const std::string& path)
     CSLModel csl;
     
     // Open the xsb_aircraft.txt file
-    const std::string xsbName (path + XPLMGetDirectorySeparator()[0] + XSB_AIRCRAFT_TXT);
+    const std::string xsbName (path + glob.dirSep + XSB_AIRCRAFT_TXT);
     std::ifstream fAc (TOPOSIX(xsbName));
     if (!fAc || !fAc.is_open())
         return WARN_NO_XSBACTXT_FOUND;
@@ -1077,21 +1111,35 @@ void CSLModelsCleanup ()
     glob.mapCSLModels.clear();
     // Clear out all packages
     glob.mapCSLPkgs.clear();
+    
+    // and whatever was staged but never committed
+    std::lock_guard<std::mutex> lock(gStaging.mtx);
+    gStaging.mapModels.clear();
+    gStaging.mapPkgs.clear();
 }
 
 
 // Read the CSL Models found in the given path and below
 const char* CSLModelsLoad (const std::string& _path,
-                           int _maxDepth)
+                           int _maxDepth,
+                           XPMPCSLLoadStats_t* _pStats,
+                           XPMPCSLLoadProgressFuncTy _progressFunc,
+                           void* _refcon)
 {
+    typedef std::chrono::duration<double, std::milli> msTy;
+    const auto tStart = std::chrono::steady_clock::now();
+    
     // First we identify all package, so that (theoretically)
     // package dependencies to other packages can be resolved.
     // (This might rarely be used as OBJ8 only consists of one file,
     //  but the original xsb_aircraft.txt syntax requires it.)
     std::vector<std::string> paths;
     const char* res = CSLModelsFindPkgs(_path, paths, _maxDepth);
+    const auto tScanned = std::chrono::steady_clock::now();
     
     // Now we can process each folder and read in the CSL models there
+    const size_t numModelsBefore = LoadModels().size();
+    int numDone = 0;
     for (const std::string& p: paths)
     {
         const char* r = CSLModelsProcessAcFile(p);
@@ -1099,15 +1147,61 @@ const char* CSLModelsLoad (const std::string& _path,
             res = r;                    // keep it as function result (but continue with next path anyway)
             LOG_MSG(logWARN, "%s", res);// also report it to the log
         }
+        if (_progressFunc && !_progressFunc(++numDone, int(paths.size()), _refcon))
+            break;
     }
     
-    // How many models do we now have in total?
-    LOG_MSG(logINFO, INFO_TOTAL_NUM_MODELS, (unsigned long)glob.mapCSLModels.size())
+    if (_pStats) {
+        _pStats->numPkgFiles = int(paths.size());
+        _pStats->numModels   = int(LoadModels().size() - numModelsBefore);
+        _pStats->scanMs      = msTy(tScanned - tStart).count();
+        _pStats->parseMs     = msTy(std::chrono::steady_clock::now() - tScanned).count();
+    }
+    
+    // How many models do we now have in total? (Staged ones are only counted once committed.)
+    if (!gbLoadStaged)
+        LOG_MSG(logINFO, INFO_TOTAL_NUM_MODELS, (unsigned long)glob.mapCSLModels.size())
     
     // return the final result
     return res;
 }
 
+// Read the CSL Models found in the given path and below into the staging catalogue
+const char* CSLModelsStage (const std::string& _path,
+                            XPMPCSLLoadStats_t* _pStats,
+                            XPMPCSLLoadProgressFuncTy _progressFunc,
+                            void* _refcon)
+{
+    std::lock_guard<std::mutex> lock(gStaging.mtx);
+    gbLoadStaged = true;
+    const char* res = CSLModelsLoad(_path, 5, _pStats, _progressFunc, _refcon);
+    gbLoadStaged = false;
+    return res;
+}
+
+// Move staged models and packages into the live catalogue
+int CSLModelsCommitStaged ()
+{
+    LOG_ASSERT(glob.IsXPThread());
+    std::lock_guard<std::mutex> lock(gStaging.mtx);
+    
+    // Package names and model keys already known stay behind in the staging maps
+    glob.mapCSLPkgs.merge(gStaging.mapPkgs);
+    const size_t numModelsBefore = glob.mapCSLModels.size();
+    glob.mapCSLModels.merge(gStaging.mapModels);
+    for (const auto& p: gStaging.mapModels) {
+        const CSLModel& known = glob.mapCSLModels.at(p.first);
+        LOG_MSG(logWARN, WARN_DUP_MODEL, known.GetModelName().c_str(),
+                known.xsbAircraftLn, StripXPSysDir(known.xsbAircraftPath).c_str());
+    }
+    gStaging.mapModels.clear();
+    gStaging.mapPkgs.clear();
+    
+    // How many models do we now have in total?
+    LOG_MSG(logINFO, INFO_TOTAL_NUM_MODELS, (unsigned long)glob.mapCSLModels.size())
+    return int(glob.mapCSLModels.size() - numModelsBefore);
+}
+
 
 // Find a model by name
 CSLModel* CSLModelById (const std::string& _cslId,
@@ -267,7 +267,21 @@ void CSLModelsCleanup ();
 /// @param _maxDepth Search shall go how many folders deep at max?
 /// @return An empty string on success, otherwise a human-readable error message
 const char* CSLModelsLoad (const std::string& _path,
-                           int _maxDepth = 5);
+                           int _maxDepth = 5,
+                           XPMPCSLLoadStats_t* _pStats = nullptr,
+                           XPMPCSLLoadProgressFuncTy _progressFunc = nullptr,
+                           void* _refcon = nullptr);
+
+/// @brief Read the CSL Models found in the given path and below into the staging catalogue, safe on a worker thread
+/// @see XPMPStageCSLPackage()
+const char* CSLModelsStage (const std::string& _path,
+                            XPMPCSLLoadStats_t* _pStats,
+                            XPMPCSLLoadProgressFuncTy _progressFunc,
+                            void* _refcon);
+
+/// @brief Move staged models and packages into the live catalogue
+/// @return Number of models added
+int CSLModelsCommitStaged ();
 
 /// @brief Find a model by unique id
 /// @param _cslId The model's unique id to search for (package name/short id)
@@ -19,6 +19,7 @@
 ///             THE SOFTWARE.
 
 #include "XPMP2.h"
+#include <filesystem>
 
 namespace XPMP2 {
 
@@ -282,6 +283,14 @@ void GlobVars::UpdateCfgVals ()
 
 }
 
+// Cache path settings so CSL loading can run on a worker thread
+void GlobVars::ReadPathSettings ()
+{
+    dirSep = XPLMGetDirectorySeparator()[0];
+    bNativePaths = XPLMIsFeatureEnabled("XPLM_USE_NATIVE_PATHS") != 0;
+    GetXPSystemPath();                  // fills its cache
+}
+
 // Read version numbers into verXplane/verXPLM
 void GlobVars::ReadVersions ()
 {
@@ -433,6 +442,18 @@ std::list<std::string> GetDirContents (const std::string& path)
     int numFiles = 0;                       // number of files returned (per batch)
     bool bFinished = false;
     
+    // XPLM calls aren't allowed off X-Plane's main thread, e.g. while staging CSL packages
+    if (!glob.IsXPThread()) {
+        std::error_code ec;
+        for (const auto& entry: std::filesystem::directory_iterator(std::filesystem::u8path(path), ec)) {
+            std::string name = entry.path().filename().u8string();
+            if (!name.empty() && name[0] != '.')    // skip hidden entries
+                l.push_back(std::move(name));
+        }
+        l.sort();
+        return l;
+    }
+    
     // Call XPLMGetDirectoryContents as often as needed to read all directory content
     do {
         numFiles = 0;
@@ -569,7 +590,7 @@ bool Posix2HFSPath(const char *path, char *result, int resultSize)
 std::string TOPOSIX (const std::string& p)
 {
     // no actual conversion if XPLM_USE_NATIVE_PATHS is activated
-    if (XPLMIsFeatureEnabled("XPLM_USE_NATIVE_PATHS"))
+    if (glob.bNativePaths)
         return p;
     else {
         char posix[1024];
@@ -584,7 +605,7 @@ std::string TOPOSIX (const std::string& p)
 std::string FROMPOSIX (const std::string& p)
 {
     // no actual conversion if XPLM_USE_NATIVE_PATHS is activated
-    if (XPLMIsFeatureEnabled("XPLM_USE_NATIVE_PATHS"))
+    if (glob.bNativePaths)
         return p;
     else {
         char hfs[1024];
@@ -63,6 +63,7 @@
 #include <shared_mutex>
 #include <regex>
 #include <bitset>
+#include <chrono>
 
 // FMOD Sound, must be included before XPLMSound.h
 #if INCLUDE_FMOD_SOUND + 0 >= 1
@@ -267,6 +268,10 @@ public:
     XPLMPluginID    pluginId = 0;
     /// id of X-Plane's thread (when it is OK to use XP API calls)
     std::thread::id xpThread;
+    /// Directory separator (XPLMGetDirectorySeparator), cached for path handling off XP's thread
+    char            dirSep = '/';
+    /// Is XPLM_USE_NATIVE_PATHS enabled? Cached for path handling off XP's thread
+    bool            bNativePaths = true;
 
     /// Current camera location, updated every flight loop
     XPLMCameraPosition_t posCamera = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
@@ -297,6 +302,8 @@ public:
     void UpdateCfgVals ();
     /// Read version numbers into verXplane/verXPLM
     void ReadVersions ();
+    /// Cache path settings (separator, native paths, system path) so CSL loading can run on a worker thread
+    void ReadPathSettings ();
     /// Using a modern graphics driver, ie. Vulkan/Metal?
     bool UsingModernGraphicsDriver() const { return bXPUsingModernGraphicsDriver; }
     /// Set current thread as main xp Thread
@@ -307,11 +314,38 @@ public:
 
     /// Update the stored camera position and velocity values
     void UpdateCameraPos ();
+
+    /// Profiling callback as set by XPMPSetProfileCallback(), `nullptr` if not profiling
+    XPMPProfileCallback_f profileCb = nullptr;
+    /// Refcon passed to the profiling callback
+    void*           profileRefcon = nullptr;
+    /// Time [us] accumulated per section since the last report
+    std::array<double, XPMP_PROFILE_COUNT> profileUs = {};
 };
 
 /// The one and only global variable structure
 extern GlobVars glob;
 
+/// Adds the time until it goes out of scope to a profiling section, if profiling is active
+class ProfileScope {
+protected:
+    XPMPProfileSection section;
+    bool bActive;
+    std::chrono::steady_clock::time_point tStart;
+public:
+    ProfileScope (XPMPProfileSection _section) :
+    section(_section), bActive(glob.profileCb != nullptr)
+    { if (bActive) tStart = std::chrono::steady_clock::now(); }
+    ~ProfileScope ()
+    {
+        if (bActive)
+            glob.profileUs[section] += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - tStart).count();
+    }
+};
+
+/// Hands the accumulated section times to the profiling callback and resets them
+void ProfileReport ();
+
 }       // namespace XPMP2
 
 
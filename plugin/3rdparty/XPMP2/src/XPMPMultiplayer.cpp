@@ -170,6 +170,7 @@ const char *    XPMPMultiplayerInit(const char* inPluginName,
 
     // Get X-Plane's version numbers
     glob.ReadVersions();    
+    glob.ReadPathSettings();
 #if defined(XPMP2_DLLEXPORT)
     const char* MSG_IS_DLL = "(DLL) ";
 #else
@@ -251,6 +252,26 @@ void XPMPMultiplayerCleanup()
     
     // Unregister all notification callbacks
     glob.listObservers.clear();
+    glob.profileCb = nullptr;
+}
+
+// Hands the accumulated section times to the profiling callback and resets them
+void XPMP2::ProfileReport ()
+{
+    if (!glob.profileCb)
+        return;
+    for (int i = 0; i < XPMP_PROFILE_COUNT; i++) {
+        glob.profileCb(XPMPProfileSection(i), glob.profileUs[i], glob.profileRefcon);
+        glob.profileUs[i] = 0.0;
+    }
+}
+
+// Registers a callback that receives the per-frame section times
+void XPMPSetProfileCallback (XPMPProfileCallback_f inCallback, void* inRefcon)
+{
+    glob.profileCb = inCallback;
+    glob.profileRefcon = inRefcon;
+    glob.profileUs.fill(0.0);
 }
 
 // OBJ7 is not supported
@@ -275,6 +296,26 @@ const char *    XPMPLoadCSLPackage(const char * inCSLFolder)
         return "<nullptr> provided";
 }
 
+// Loads a collection of planes models into the staging catalogue
+const char* XPMPStageCSLPackage(const char* inCSLFolder,
+                                XPMPCSLLoadStats_t* outStats,
+                                XPMPCSLLoadProgressFuncTy inProgressFunc,
+                                void* inRefcon)
+{
+    if (inCSLFolder) {
+        LOG_MSG(logINFO, INFO_LOAD_CSL_PACKAGE, StripXPSysDir(inCSLFolder).c_str());
+        return CSLModelsStage(inCSLFolder, outStats, inProgressFunc, inRefcon);
+    }
+    else
+        return "<nullptr> provided";
+}
+
+// Makes staged models available
+int XPMPCommitStagedCSLPackages()
+{
+    return CSLModelsCommitStaged();
+}
+
 // checks what planes are loaded and loads any that we didn't get
 void            XPMPLoadPlanesIfNecessary()
 {}
@@ -4,6 +4,15 @@
 
 #include <cmath>
 #include <algorithm>
+#include <cstddef>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
 struct Quaternion
 {
@@ -329,4 +338,274 @@ bool operator==(const Quaternion lhs, const Quaternion rhs)
 bool operator!=(const Quaternion lhs, const Quaternion rhs)
 {
     return !(lhs == rhs);
-}
\ No newline at end of file
+}
+
+// Batch variants of the quaternion helpers above, operating on structure-of-arrays input.
+// The arithmetic runs on 4 (AVX), 2 (SSE2, NEON) or 1 lane(s) at a time; the trigonometric
+// functions are evaluated per lane with the same libm calls. Every lane performs the same
+// operations in the same order as the scalar functions, so results match them exactly
+// (as long as the compiler does not contract the scalar code into FMA instructions).
+
+struct QuaternionSpan
+{
+    double* I;
+    double* J;
+    double* K;
+    double* U;
+};
+
+struct ConstQuaternionSpan
+{
+    const double* I;
+    const double* J;
+    const double* K;
+    const double* U;
+
+    ConstQuaternionSpan(const double* i, const double* j, const double* k, const double* u) : I(i), J(j), K(k), U(u) {}
+    ConstQuaternionSpan(QuaternionSpan q) : I(q.I), J(q.J), K(q.K), U(q.U) {}
+};
+
+namespace AbacusLanes
+{
+    struct Scalar
+    {
+        static constexpr size_t Width = 1;
+        double v;
+
+        static inline Scalar Load(const double* p) { return { *p }; }
+        static inline Scalar Set(double x) { return { x }; }
+        inline void Store(double* p) const { *p = v; }
+    };
+
+    inline Scalar operator+(Scalar a, Scalar b) { return { a.v + b.v }; }
+    inline Scalar operator-(Scalar a, Scalar b) { return { a.v - b.v }; }
+    inline Scalar operator*(Scalar a, Scalar b) { return { a.v * b.v }; }
+    inline Scalar operator/(Scalar a, Scalar b) { return { a.v / b.v }; }
+    inline Scalar Sqrt(Scalar a) { return { sqrt(a.v) }; }
+
+#if defined(__AVX__)
+    struct Wide
+    {
+        static constexpr size_t Width = 4;
+        __m256d v;
+
+        static inline Wide Load(const double* p) { return { _mm256_loadu_pd(p) }; }
+        static inline Wide Set(double x) { return { _mm256_set1_pd(x) }; }
+        inline void Store(double* p) const { _mm256_storeu_pd(p, v); }
+    };
+
+    inline Wide operator+(Wide a, Wide b) { return { _mm256_add_pd(a.v, b.v) }; }
+    inline Wide operator-(Wide a, Wide b) { return { _mm256_sub_pd(a.v, b.v) }; }
+    inline Wide operator*(Wide a, Wide b) { return { _mm256_mul_pd(a.v, b.v) }; }
+    inline Wide operator/(Wide a, Wide b) { return { _mm256_div_pd(a.v, b.v) }; }
+    inline Wide Sqrt(Wide a) { return { _mm256_sqrt_pd(a.v) }; }
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    struct Wide
+    {
+        static constexpr size_t Width = 2;
+        __m128d v;
+
+        static inline Wide Load(const double* p) { return { _mm_loadu_pd(p) }; }
+        static inline Wide Set(double x) { return { _mm_set1_pd(x) }; }
+        inline void Store(double* p) const { _mm_storeu_pd(p, v); }
+    };
+
+    inline Wide operator+(Wide a, Wide b) { return { _mm_add_pd(a.v, b.v) }; }
+    inline Wide operator-(Wide a, Wide b) { return { _mm_sub_pd(a.v, b.v) }; }
+    inline Wide operator*(Wide a, Wide b) { return { _mm_mul_pd(a.v, b.v) }; }
+    inline Wide operator/(Wide a, Wide b) { return { _mm_div_pd(a.v, b.v) }; }
+    inline Wide Sqrt(Wide a) { return { _mm_sqrt_pd(a.v) }; }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    struct Wide
+    {
+        static constexpr size_t Width = 2;
+        float64x2_t v;
+
+        static inline Wide Load(const double* p) { return { vld1q_f64(p) }; }
+        static inline Wide Set(double x) { return { vdupq_n_f64(x) }; }
+        inline void Store(double* p) const { vst1q_f64(p, v); }
+    };
+
+    inline Wide operator+(Wide a, Wide b) { return { vaddq_f64(a.v, b.v) }; }
+    inline Wide operator-(Wide a, Wide b) { return { vsubq_f64(a.v, b.v) }; }
+    inline Wide operator*(Wide a, Wide b) { return { vmulq_f64(a.v, b.v) }; }
+    inline Wide operator/(Wide a, Wide b) { return { vdivq_f64(a.v, b.v) }; }
+    inline Wide Sqrt(Wide a) { return { vsqrtq_f64(a.v) }; }
+#else
+    typedef Scalar Wide;
+#endif
+
+    template<typename L>
+    inline void CreateFromEuler(size_t i, const double* yaw, const double* pitch, const double* roll, QuaternionSpan out)
+    {
+        double cy[L::Width], sy[L::Width], cp[L::Width], sp[L::Width], cr[L::Width], sr[L::Width];
+        for (size_t l = 0; l < L::Width; l++)
+        {
+            cy[l] = cos(yaw[i + l] * 0.5);
+            sy[l] = sin(yaw[i + l] * 0.5);
+            cp[l] = cos(pitch[i + l] * 0.5);
+            sp[l] = sin(pitch[i + l] * 0.5);
+            cr[l] = cos(roll[i + l] * 0.5);
+            sr[l] = sin(roll[i + l] * 0.5);
+        }
+
+        const L vcy = L::Load(cy), vsy = L::Load(sy), vcp = L::Load(cp), vsp = L::Load(sp), vcr = L::Load(cr), vsr = L::Load(sr);
+        (vcy * vcp * vsr - vsy * vsp * vcr).Store(out.I + i);
+        (vsy * vcp * vsr + vcy * vsp * vcr).Store(out.J + i);
+        (vsy * vcp * vcr - vcy * vsp * vsr).Store(out.K + i);
+        (vcy * vcp * vcr + vsy * vsp * vsr).Store(out.U + i);
+    }
+
+    template<typename L>
+    inline void Multiply(size_t i, ConstQuaternionSpan a, ConstQuaternionSpan b, QuaternionSpan out)
+    {
+        const L aI = L::Load(a.I + i), aJ = L::Load(a.J + i), aK = L::Load(a.K + i), aU = L::Load(a.U + i);
+        const L bI = L::Load(b.I + i), bJ = L::Load(b.J + i), bK = L::Load(b.K + i), bU = L::Load(b.U + i);
+        (aI * bU + aU * bI + aJ * bK - aK * bJ).Store(out.I + i);
+        (aU * bJ - aI * bK + aJ * bU + aK * bI).Store(out.J + i);
+        (aU * bK + aI * bJ - aJ * bI + aK * bU).Store(out.K + i);
+        (aU * bU - aI * bI - aJ * bJ - aK * bK).Store(out.U + i);
+    }
+
+    template<typename L>
+    inline void Slerp(size_t i, ConstQuaternionSpan a, ConstQuaternionSpan b, const double* t, QuaternionSpan out)
+    {
+        // blend weights need acos/sin and a branch, so they are computed per lane
+        double w1[L::Width], w2[L::Width];
+        for (size_t l = 0; l < L::Width; l++)
+        {
+            const size_t n = i + l;
+            double n3 = a.I[n] * b.I[n] + a.J[n] * b.J[n] + a.K[n] * b.K[n] + a.U[n] * b.U[n];
+            bool flag = false;
+            if (n3 < 0)
+            {
+                flag = true;
+                n3 = -n3;
+            }
+            if (n3 > 0.999999)
+            {
+                w2[l] = 1 - t[n];
+                w1[l] = flag ? -t[n] : t[n];
+            }
+            else
+            {
+                const double n4 = acos(n3);
+                const double n5 = 1 / sin(n4);
+                w2[l] = sin((1 - t[n]) * n4) * n5;
+                w1[l] = flag ? -sin(t[n] * n4) * n5 : sin(t[n] * n4) * n5;
+            }
+        }
+
+        const L n1 = L::Load(w1), n2 = L::Load(w2);
+        const L qI = n2 * L::Load(a.I + i) + n1 * L::Load(b.I + i);
+        const L qJ = n2 * L::Load(a.J + i) + n1 * L::Load(b.J + i);
+        const L qK = n2 * L::Load(a.K + i) + n1 * L::Load(b.K + i);
+        const L qU = n2 * L::Load(a.U + i) + n1 * L::Load(b.U + i);
+        const L norm = Sqrt(qI * qI + qJ * qJ + qK * qK + qU * qU);
+        (qI / norm).Store(out.I + i);
+        (qJ / norm).Store(out.J + i);
+        (qK / norm).Store(out.K + i);
+        (qU / norm).Store(out.U + i);
+    }
+
+    template<typename L>
+    inline void ExtractEulerAngles(size_t i, ConstQuaternionSpan q, double* pitch, double* yaw, double* roll)
+    {
+        const L qI = L::Load(q.I + i), qJ = L::Load(q.J + i), qK = L::Load(q.K + i), qU = L::Load(q.U + i);
+        const L one = L::Set(1.0), two = L::Set(2.0);
+        const L sqx = qI * qI, sqy = qJ * qJ, sqz = qK * qK;
+
+        double test[L::Width], yawY[L::Width], yawX[L::Width], rollY[L::Width], rollX[L::Width];
+        (qU * qJ - qK * qI).Store(test);
+        (two * (qU * qK + qI * qJ)).Store(yawY);
+        (one - two * (sqy + sqz)).Store(yawX);
+        (two * (qU * qI + qJ * qK)).Store(rollY);
+        (one - two * (sqx + sqy)).Store(rollX);
+
+        for (size_t l = 0; l < L::Width; l++)
+        {
+            const size_t n = i + l;
+            if (test[l] > 0.4999999999999999)
+            {
+                pitch[n] = M_PI / 2;
+                yaw[n] = 2 * atan2(q.I[n], q.U[n]);
+                roll[n] = 0.0;
+            }
+            else if (test[l] < -0.4999999999999999)
+            {
+                pitch[n] = -M_PI / 2;
+                yaw[n] = -2 * atan2(q.I[n], q.U[n]);
+                roll[n] = 0.0;
+            }
+            else
+            {
+                pitch[n] = asin(2 * test[l]);
+                yaw[n] = atan2(yawY[l], yawX[l]);
+                roll[n] = atan2(rollY[l], rollX[l]);
+            }
+        }
+    }
+
+    template<typename Kernel>
+    inline void ForEachLane(size_t count, Kernel kernel)
+    {
+        size_t i = 0;
+        for (; i + Wide::Width <= count; i += Wide::Width)
+        {
+            kernel(Wide{}, i);
+        }
+        for (; i < count; i++)
+        {
+            kernel(Scalar{}, i);
+        }
+    }
+}
+
+/// Batch Quaternion::CreateFromEuler
+inline void CreateFromEulerBatch(const double* yaw, const double* pitch, const double* roll, QuaternionSpan out, size_t count)
+{
+    AbacusLanes::ForEachLane(count, [&](auto lanes, size_t i)
+    {
+        AbacusLanes::CreateFromEuler<decltype(lanes)>(i, yaw, pitch, roll, out);
+    });
+}
+
+/// Batch a * b
+inline void MultiplyBatch(ConstQuaternionSpan a, ConstQuaternionSpan b, QuaternionSpan out, size_t count)
+{
+    AbacusLanes::ForEachLane(count, [&](auto lanes, size_t i)
+    {
+        AbacusLanes::Multiply<decltype(lanes)>(i, a, b, out);
+    });
+}
+
+/// Batch Quaternion::Slerp
+inline void SlerpBatch(ConstQuaternionSpan a, ConstQuaternionSpan b, const double* t, QuaternionSpan out, size_t count)
+{
+    AbacusLanes::ForEachLane(count, [&](auto lanes, size_t i)
+    {
+        AbacusLanes::Slerp<decltype(lanes)>(i, a, b, t, out);
+    });
+
+    // clamped lanes just normalize an endpoint, which the scalar version does with different rounding
+    for (size_t i = 0; i < count; i++)
+    {
+        if (t[i] < 0 || t[i] > 1)
+        {
+            Quaternion q = Quaternion::Slerp(Quaternion(a.I[i], a.J[i], a.K[i], a.U[i]), Quaternion(b.I[i], b.J[i], b.K[i], b.U[i]), t[i]);
+            out.I[i] = q.I;
+            out.J[i] = q.J;
+            out.K[i] = q.K;
+            out.U[i] = q.U;
+        }
+    }
+}
+
+/// Batch Quaternion::ExtractEulerAngles; pitch, yaw and roll correspond to X, Y and Z of the scalar result
+inline void ExtractEulerAnglesBatch(ConstQuaternionSpan q, double* pitch, double* yaw, double* roll, size_t count)
+{
+    AbacusLanes::ForEachLane(count, [&](auto lanes, size_t i)
+    {
+        AbacusLanes::ExtractEulerAngles<decltype(lanes)>(i, q, pitch, yaw, roll);
+    });
+}
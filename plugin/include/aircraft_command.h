@@ -0,0 +1,123 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#pragma once
+
+#include "dto.h"
+#include "bounded_mpsc_queue.h"
+#include "network_aircraft.h"
+
+namespace xpilot
+{
+	enum class AircraftCommandType : uint8_t
+	{
+		AddAircraft,
+		FastPosition,
+		Heartbeat,
+		AircraftConfig,
+		DeleteAircraft,
+		DeleteAllAircraft
+	};
+
+	/// Fixed-size record for the aircraft messages handed from the socket worker to the flight loop.
+	/// Only trivially copyable members, so queueing it never allocates.
+	struct AircraftCommand
+	{
+		static constexpr size_t MaxCallsignLength = 31;
+		static constexpr size_t MaxCodeLength = 15;
+
+		AircraftCommandType Type = AircraftCommandType::Heartbeat;
+		int64_t QueuedAt = 0; // [us]
+		uint64_t Sequence = 0; // position among all queued main thread work, see XPilot::InvokeQueuedWork
+		char Callsign[MaxCallsignLength + 1] = {};
+
+		// AddAircraft
+		char Airline[MaxCodeLength + 1] = {};
+		char TypeCode[MaxCodeLength + 1] = {};
+
+		// AddAircraft, FastPosition
+		AircraftVisualState VisualState{};
+		Vector3 PositionalVelocities{};
+		Vector3 RotationalVelocities{};
+		double Speed = 0.0;
+
+		// AircraftConfig
+		std::optional<bool> FullConfig;
+		std::optional<bool> EnginesOn;
+		std::optional<bool> EnginesReversing;
+		std::optional<bool> OnGround;
+		std::optional<float> Flaps;
+		std::optional<bool> SpoilersDeployed;
+		std::optional<bool> GearDown;
+		std::optional<bool> BeaconLightsOn;
+		std::optional<bool> LandingLightsOn;
+		std::optional<bool> NavLightsOn;
+		std::optional<bool> StrobeLightsOn;
+		std::optional<bool> TaxiLightsOn;
+
+		std::string_view GetCallsign() const { return std::string_view(Callsign); }
+
+		/// Returns false if the value does not fit; the caller has to use the slow path instead
+		template<size_t N>
+		static bool CopyString(char(&target)[N], const std::string& value)
+		{
+			if (value.size() >= N)
+				return false;
+			std::memcpy(target, value.c_str(), value.size() + 1);
+			return true;
+		}
+
+		void SetConfig(const AircraftConfigDto& dto)
+		{
+			FullConfig = dto.fullConfig;
+			EnginesOn = dto.enginesOn;
+			EnginesReversing = dto.enginesReversing;
+			OnGround = dto.onGround;
+			Flaps = dto.flaps;
+			SpoilersDeployed = dto.spoilersDeployed;
+			GearDown = dto.gearDown;
+			BeaconLightsOn = dto.beaconLightsOn;
+			LandingLightsOn = dto.landingLightsOn;
+			NavLightsOn = dto.navLightsOn;
+			StrobeLightsOn = dto.strobeLightsOn;
+			TaxiLightsOn = dto.taxiLightsOn;
+		}
+
+		AircraftConfigDto GetConfig() const
+		{
+			AircraftConfigDto dto;
+			dto.callsign = Callsign;
+			dto.fullConfig = FullConfig;
+			dto.enginesOn = EnginesOn;
+			dto.enginesReversing = EnginesReversing;
+			dto.onGround = OnGround;
+			dto.flaps = Flaps;
+			dto.spoilersDeployed = SpoilersDeployed;
+			dto.gearDown = GearDown;
+			dto.beaconLightsOn = BeaconLightsOn;
+			dto.landingLightsOn = LandingLightsOn;
+			dto.navLightsOn = NavLightsOn;
+			dto.strobeLightsOn = StrobeLightsOn;
+			dto.taxiLightsOn = TaxiLightsOn;
+			return dto;
+		}
+	};
+
+	constexpr size_t AIRCRAFT_COMMAND_QUEUE_CAPACITY = 4096;
+	class AircraftCommandQueue : public BoundedMpscQueue<AircraftCommand, AIRCRAFT_COMMAND_QUEUE_CAPACITY> {};
+}
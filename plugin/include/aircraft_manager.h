@@ -18,7 +18,11 @@
 
 #pragma once
 
+#include "data_ref_access.h"
+#include "expiry_wheel.h"
+#include "model_matcher.h"
 #include "network_aircraft.h"
+#include "worker_pool.h"
 #include "xpilot.h"
 
 namespace xpilot
@@ -34,6 +38,21 @@ namespace xpilot
 	}
 	mapPlanesTy::iterator mapGetAircraftByIndex(int idx);
 
+	/// An added aircraft waiting for its model match and a share of the creation budget
+	struct PendingAircraft
+	{
+		uint64_t Ticket = 0;
+		std::string Callsign;
+		AircraftVisualState VisualState;
+		std::string Airline;
+		std::string TypeCode;
+		std::vector<AircraftConfigDto> Configs; // received before the aircraft exists
+		XPMP2::CSLModel* Model = nullptr;
+		bool Matched = false;
+		int64_t QueuedAt = 0; // [ms] when the match was requested
+		double Distance = 0.0; // ranking only, see CreatePendingAircraft
+	};
+
 	class AircraftManager
 	{
 	public:
@@ -47,11 +66,43 @@ namespace xpilot
 		void HandleRemovePlane(const std::string& callsign);
 		void RemoveAllPlanes();
 
+		/// Aircraft stay queued until the CSL packages are loaded, then their model matches start
+		void SetModelsReady();
+		bool AreModelsReady() const { return m_modelsReady; }
+
+	protected:
+		OwnedDataRef<int> m_pendingCount;
+		OwnedDataRef<int> m_burstSize;
+		OwnedDataRef<float> m_burstWorstFrame;
+		DataRefAccess<double> m_userLatitude;
+		DataRefAccess<double> m_userLongitude;
+
 	private:
 		NetworkAircraft* GetAircraft(const std::string& callsign);
 		static float AircraftMaintenanceCallback(float, float, int, void* ref);
 		static void AircraftNotifierCallback(XPMPPlaneID inPlaneID, XPMPPlaneNotification inNotification, void* ref);
 		XPilot* mEnv;
+		std::unique_ptr<WorkerPool> m_kinematicsPool;
+		ExpiryWheel<std::string> m_staleAircraft;
+		std::vector<std::string> m_expiredAircraft;
+
+		// new aircraft are created nearest first within a per-frame budget, see CreatePendingAircraft
+		std::vector<PendingAircraft> m_pendingAircraft;
+		std::unique_ptr<ModelMatcher> m_modelMatcher;
+		std::vector<ModelMatchResult> m_matchResults;
+		uint64_t m_nextTicket = 1;
+		bool m_modelsReady = false;
+		PendingAircraft* FindPending(const std::string& callsign);
+		bool RemovePending(const std::string& callsign);
+		void QueueModelMatch(PendingAircraft& pending);
+		void CreatePendingAircraft();
+
+		// a burst lasts from the first queued aircraft until the queue has drained
+		bool m_burstActive = false;
+		int64_t m_burstStart = 0; // [ms]
+		size_t m_burstCreated = 0;
+		float m_burstWorstFrameValue = 0.0f; // [ms]
+		void TrackBurst(float frameTime);
 
 		std::thread::id m_xplaneThread;
 		void ThisThreadIsXplane()
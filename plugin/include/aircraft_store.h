@@ -0,0 +1,217 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#pragma once
+
+#include "config.h"
+#include "vector3.hpp"
+
+namespace xpilot
+{
+	class NetworkAircraft;
+	class WorkerPool;
+
+	struct AircraftVisualState
+	{
+		double Lat;
+		double Lon;
+		double AltitudeTrue;
+		std::optional<double> AltitudeAgl = {};
+		double Pitch;
+		double Heading;
+		double Bank;
+		double NoseWheelAngle;
+	};
+
+	/// Origin of an aircraft's integration frame: its position at the last network fix, plus the
+	/// X-Plane local (OpenGL) coordinates of that point and of one metre east, up and north of it.
+	/// Between fixes the aircraft moves in metres relative to the anchor, so the per-frame path needs
+	/// neither trigonometry nor XPLMWorldToLocal.
+	struct LocalFrameAnchor
+	{
+		double Lat = 0.0;
+		double Lon = 0.0;
+		double AltitudeTrue = 0.0;
+		double LonScale = 1.0; // LongitudeScalingFactor(Lat)
+		Vector3 Origin;
+		Vector3 East;
+		Vector3 Up;
+		Vector3 North;
+		uint32_t FrameGeneration = 0;
+		bool Pending = true;
+	};
+
+	/// Animation level of detail, picked each frame from the camera distance
+	enum class AircraftLodTier : uint8_t
+	{
+		Near,	// everything, every frame
+		Mid,	// position every frame, animations every LOD_MID_FRAME_INTERVAL frames
+		Far,	// position and attitude only, every LOD_FAR_FRAME_INTERVAL frames
+		Count
+	};
+
+	/// Traffic quality picked by the frame budget governor. Every level keeps the reductions of the ones before it.
+	enum class TrafficQuality : uint8_t
+	{
+		Full,
+		ReducedFarUpdates,      // mid and far LOD intervals doubled
+		ReducedTerrainProbes,   // terrain sampling intervals doubled outside TERRAIN_LOD_NEAR_DISTANCE
+		ReducedLabelsAndSounds, // label distance capped, sounds muted outside the near tier
+		NearestOnly,            // only the nearest aircraft are rendered
+		Count
+	};
+
+	/// Settings the per-aircraft update reads, copied from Config once per flight loop
+	struct AircraftFrameSettings
+	{
+		AircraftLabelType LabelType = AircraftLabelType::Callsign;
+		int LabelColor = 0;
+		float LodNearDistance = 0.0f; // [m]
+		float LodFarDistance = 0.0f;  // [m]
+		uint32_t LabelRevision = 1;   // bumped when LabelType or LabelColor change
+		int MidFrameInterval = 1;     // [frames]
+		int FarFrameInterval = 1;     // [frames]
+		int64_t TerrainIntervalScale = 1;
+		bool MuteDistantSounds = false;
+	};
+
+	struct AircraftHandle
+	{
+		static constexpr uint32_t InvalidSlot = UINT32_MAX;
+
+		uint32_t Slot = InvalidSlot;
+		uint32_t Generation = 0;
+
+		bool IsValid() const { return Slot != InvalidSlot; }
+	};
+
+	/// Per-frame kinematic state of all network aircraft, kept in parallel arrays indexed by slot
+	/// so the extrapolation pass walks contiguous memory instead of chasing NetworkAircraft pointers.
+	/// Slots are recycled; a handle is only valid while its generation matches. Flight loop only.
+	class AircraftStore
+	{
+	public:
+		static AircraftStore& GetInstance();
+		AircraftStore(const AircraftStore&) = delete;
+		void operator=(const AircraftStore&) = delete;
+
+		AircraftHandle Allocate(const std::string& callsign, NetworkAircraft* owner);
+		void Release(AircraftHandle handle);
+
+		AircraftHandle Find(std::string_view callsign) const;
+		NetworkAircraft* FindAircraft(std::string_view callsign) const;
+		bool IsCurrent(AircraftHandle handle) const;
+
+		/// Number of slots ever allocated; iterate [0, SlotCount()) and skip inactive slots
+		size_t SlotCount() const { return m_active.size(); }
+		size_t ActiveCount() const { return m_activeCount; }
+		bool IsActive(size_t slot) const { return m_active[slot] != 0; }
+		NetworkAircraft* GetOwner(size_t slot) const { return m_owners[slot]; }
+		const std::string& GetCallsign(size_t slot) const { return m_callsigns[slot]; }
+
+		/// Batch kinematics stage: computes PredictedVisualState for every aircraft once per flight loop.
+		/// Called from each aircraft's UpdatePosition; only the first call of a flight loop does the work.
+		void PrepareFrame(int frameCounter, double interval);
+		void SetWorkerPool(WorkerPool* pool) { m_workerPool = pool; }
+		const AircraftFrameSettings& GetFrameSettings() const { return m_frameSettings; }
+
+		/// Frozen aircraft are parked with nothing left to animate; they skip all per-frame work
+		/// until a new packet or config arrives for them, or ThawAll is called
+		bool IsFrozen(size_t slot) const { return Frozen[slot] != 0; }
+		void Freeze(size_t slot);
+		void Thaw(size_t slot);
+		void ThawAll();
+		size_t FrozenCount() const { return m_frozenCount; }
+
+		/// Active, non-frozen aircraft per LOD tier, for diagnostics
+		std::array<size_t, static_cast<size_t>(AircraftLodTier::Count)> GetLodTierCounts() const;
+
+		/// Set by the frame budget governor, picked up by the next frame's settings
+		void SetTrafficQuality(TrafficQuality quality) { m_trafficQuality = quality; }
+		TrafficQuality GetTrafficQuality() const { return m_trafficQuality; }
+
+		/// Culled aircraft keep moving, so TCAS still sees them, but are not rendered.
+		/// Returns the number of aircraft culled.
+		size_t CullBeyondNearest(size_t limit);
+		void ClearCulled();
+		bool IsCulled(size_t slot) const { return Culled[slot] != 0; }
+		size_t CulledCount() const { return m_culledCount; }
+
+		/// Bumped whenever X-Plane moves the local coordinate system's reference point
+		uint32_t GetLocalFrameGeneration() const { return m_localFrameGeneration; }
+
+		// hot state, one entry per slot
+		std::vector<AircraftVisualState> VisualState;
+		std::vector<AircraftVisualState> PredictedVisualState;
+		std::vector<Vector3> PositionalVelocities;
+		std::vector<Vector3> PositionalErrorVelocities;
+		std::vector<Vector3> RotationalVelocities;
+		std::vector<Vector3> RotationalErrorVelocities;
+		std::vector<int64_t> ApplyErrorVelocitiesUntil;
+		std::vector<int64_t> LastVelocityUpdate;
+		std::vector<int64_t> LastUpdated;
+		std::vector<uint8_t> FirstRenderPending;
+		std::vector<Vector3> RenderedAttitude; // pitch, heading, bank last handed to XPMP2
+		std::vector<LocalFrameAnchor> Anchor;
+		std::vector<Vector3> AnchorOffset; // [m] east, up, north of the anchor (same axes as the velocities)
+		std::vector<uint8_t> Frozen;
+		std::vector<AircraftLodTier> LodTier;
+		std::vector<uint8_t> Culled;
+
+	private:
+		AircraftStore() = default;
+
+		// open addressing callsign -> slot index, linear probing with backward shift deletion
+		static constexpr uint32_t EmptyBucket = UINT32_MAX;
+		std::vector<uint32_t> m_buckets;
+		size_t FindBucket(std::string_view callsign, size_t hash) const;
+		void InsertBucket(uint32_t slot);
+		void EraseBucket(size_t bucket);
+		void Rehash(size_t bucketCount);
+		size_t BucketMask() const { return m_buckets.size() - 1; }
+
+		// cold state, one entry per slot
+		std::vector<std::string> m_callsigns;
+		std::vector<size_t> m_hashes;
+		std::vector<NetworkAircraft*> m_owners;
+		std::vector<uint32_t> m_generations;
+		std::vector<uint8_t> m_active;
+		std::vector<uint32_t> m_freeSlots;
+		size_t m_activeCount = 0;
+		size_t m_frozenCount = 0;
+		size_t m_culledCount = 0;
+
+		void SetCulled(size_t slot, bool culled);
+		TrafficQuality m_trafficQuality = TrafficQuality::Full;
+		std::vector<std::pair<float, uint32_t>> m_cullOrder; // camera distance, slot
+
+		void ExtrapolateRange(size_t begin, size_t end, double interval, int64_t now);
+		WorkerPool* m_workerPool = nullptr;
+		int m_lastFrameCounter = -1;
+
+		void RefreshFrameSettings();
+		AircraftFrameSettings m_frameSettings;
+
+		void CheckLocalFrame();
+		XPLMDataRef m_latRef = nullptr;
+		XPLMDataRef m_lonRef = nullptr;
+		uint32_t m_lastLatRef = 0; // bit pattern of the float dataref; any change moves the local frame
+		uint32_t m_lastLonRef = 0;
+		uint32_t m_localFrameGeneration = 0;
+	};
+}
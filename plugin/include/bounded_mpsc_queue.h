@@ -0,0 +1,106 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#pragma once
+
+namespace xpilot
+{
+	/// Bounded lock-free queue for any number of producers and a single consumer
+	/// (D. Vyukov's bounded MPMC design, with the consumer side simplified).
+	/// Capacity must be a power of two. Push never blocks, it fails when the queue is full.
+	template<typename T, size_t Capacity>
+	class BoundedMpscQueue
+	{
+		static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	public:
+		BoundedMpscQueue() : m_cells(new Cell[Capacity])
+		{
+			for (size_t i = 0; i < Capacity; i++)
+			{
+				m_cells[i].Sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		BoundedMpscQueue(const BoundedMpscQueue&) = delete;
+		BoundedMpscQueue& operator=(const BoundedMpscQueue&) = delete;
+
+		/// The item is only moved from if the push succeeds
+		template<typename U>
+		bool TryPush(U&& item)
+		{
+			size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				Cell& cell = m_cells[pos & (Capacity - 1)];
+				const size_t seq = cell.Sequence.load(std::memory_order_acquire);
+				const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+				if (diff == 0)
+				{
+					if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					{
+						cell.Data = std::forward<U>(item);
+						cell.Sequence.store(pos + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (diff < 0)
+				{
+					return false; // full
+				}
+				else
+				{
+					pos = m_enqueuePos.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		/// Consumer only
+		bool TryPop(T& item)
+		{
+			const size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+			Cell& cell = m_cells[pos & (Capacity - 1)];
+			const size_t seq = cell.Sequence.load(std::memory_order_acquire);
+			if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0)
+				return false; // empty
+
+			item = std::move(cell.Data);
+			cell.Sequence.store(pos + Capacity, std::memory_order_release);
+			m_dequeuePos.store(pos + 1, std::memory_order_relaxed);
+			return true;
+		}
+
+		size_t ApproximateSize() const
+		{
+			const size_t enqueued = m_enqueuePos.load(std::memory_order_relaxed);
+			const size_t dequeued = m_dequeuePos.load(std::memory_order_relaxed);
+			return enqueued > dequeued ? enqueued - dequeued : 0;
+		}
+
+	private:
+		struct Cell
+		{
+			std::atomic<size_t> Sequence;
+			T Data;
+		};
+
+		std::unique_ptr<Cell[]> m_cells;
+		alignas(64) std::atomic<size_t> m_enqueuePos{ 0 };
+		alignas(64) std::atomic<size_t> m_dequeuePos{ 0 };
+	};
+}
@@ -127,6 +127,21 @@ namespace xpilot
 		void SetLabelCutoffVis(bool value) { m_labelCutoffVis = value; }
 		bool GetLabelCutoffVis() const { return m_labelCutoffVis; }
 
+		void SetLodNearDistance(int distance) { m_lodNearDist = distance; }
+		int GetLodNearDistance() const { return m_lodNearDist; }
+
+		void SetLodFarDistance(int distance) { m_lodFarDist = distance; }
+		int GetLodFarDistance() const { return m_lodFarDist; }
+
+		void SetTrafficFrameBudget(int budget) { m_trafficFrameBudget = budget; }
+		int GetTrafficFrameBudget() const { return m_trafficFrameBudget; }
+
+		void SetGovernorAircraftLimit(int limit) { m_governorAircraftLimit = limit; }
+		int GetGovernorAircraftLimit() const { return m_governorAircraftLimit; }
+
+		void SetConsoleHistoryLimit(int limit) { m_consoleHistoryLimit = limit; }
+		int GetConsoleHistoryLimit() const { return m_consoleHistoryLimit; }
+
 		void SetLogLevel(int level) { m_logLevel = std::max(0, std::min(level, 5)); }
 		int GetLogLevel() const { return std::max(0, std::min(m_logLevel, 5)); }
 
@@ -201,6 +216,11 @@ namespace xpilot
 		NotificationPanelPosition m_notificationPanelPosition = NotificationPanelPosition::TopRight;
 		int m_maxLabelDist = 3;
 		bool m_labelCutoffVis = true;
+		int m_lodNearDist = 2; // [nm] full animation inside, reduced rate outside
+		int m_lodFarDist = 10; // [nm] position and attitude only outside
+		int m_trafficFrameBudget = 5; // [ms] per frame for traffic work, 0 disables the governor
+		int m_governorAircraftLimit = 50; // aircraft rendered once the governor has shed everything else
+		int m_consoleHistoryLimit = 500; // messages kept per text console tab
 		bool m_transmitIndicatorEnabled = false;
 		bool m_aircraftSoundsEnabled = true;
 		int m_aircraftSoundsVolume = 50;
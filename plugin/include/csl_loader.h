@@ -0,0 +1,65 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#pragma once
+
+#include "XPMPMultiplayer.h"
+
+namespace xpilot
+{
+	/// Reads the configured CSL packages on a worker thread, so X-Plane's load screen doesn't wait for the
+	/// folder scan and xsb_aircraft.txt parsing. The models land in XPMP2's staging catalogue and only
+	/// become visible to model matching once Commit has run on the flight loop.
+	class CslLoader
+	{
+	public:
+		CslLoader() = default;
+		~CslLoader();
+
+		CslLoader(const CslLoader&) = delete;
+		CslLoader& operator=(const CslLoader&) = delete;
+
+		void Start(std::vector<std::string> packagePaths);
+		bool IsStarted() const { return m_thread.joinable(); }
+		bool IsFinished() const { return m_finished; }
+
+		/// 0..1, by package folder and the share of its xsb_aircraft.txt files processed so far
+		float GetProgress() const { return m_progress; }
+
+		/// Makes the staged models available and logs the timing; flight loop only, once IsFinished
+		int Commit();
+
+	private:
+		void WorkerLoop();
+		static bool OnProgress(int filesDone, int filesTotal, void* ref);
+
+		std::thread m_thread;
+		std::vector<std::string> m_packagePaths;
+		std::atomic<bool> m_finished{ false };
+		std::atomic<bool> m_cancel{ false };
+		std::atomic<float> m_progress{ 0.0f };
+		size_t m_currentPackage = 0; // worker only
+
+		// written by the worker, read by Commit after m_finished
+		int m_packageFiles = 0;
+		int m_modelsRead = 0;
+		double m_scanMs = 0.0;
+		double m_parseMs = 0.0;
+		int64_t m_startedAt = 0; // [us]
+	};
+}
@@ -0,0 +1,42 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#pragma once
+
+#include "ipc_metrics.h"
+#include "xp_img_window.h"
+
+namespace xpilot
+{
+	class XPilot;
+
+	class DebugWindow : public XPImgWindow
+	{
+	public:
+		DebugWindow(XPilot* instance);
+		~DebugWindow() final = default;
+	protected:
+		void buildInterface() override;
+		void RenderIpcStatistics();
+		void RenderAircraftStatistics();
+		void RenderFrameProfile();
+		void RenderIpcRecording();
+	private:
+		XPilot* m_env;
+	};
+}
@@ -9,6 +9,7 @@ namespace dto
 	const std::string DELETE_ALL_AIRCRAFT = "DELALL";
 	const std::string AIRCRAFT_CONFIG = "ACCONF";
 	const std::string FAST_POSITION_UPDATE = "FSTPOS";
+	const std::string FAST_POSITION_DELTA = "FSTPOSD";
 	const std::string HEARTBEAT = "HB";
 	const std::string PLUGIN_VER = "VER";
 	const std::string VALIDATE_CSL = "CSL";
@@ -140,7 +141,10 @@ struct FastPositionUpdateDto
 	double vb;
 	double noseWheelAngle;
 	double speed;
-	MSGPACK_DEFINE(callsign, latitude, longitude, altitudeTrue, altitudeAgl, heading, bank, pitch, vx, vy, vz, vp, vh, vb, noseWheelAngle, speed);
+	int64_t fsdReceiveTime = 0; // [ms since epoch] FSD packet received by the client
+	int64_t ipcSendTime = 0; // [ms since epoch] handed to nng by the client
+	uint64_t clientSendFailures = 0; // nng send failures on the client since startup
+	MSGPACK_DEFINE(callsign, latitude, longitude, altitudeTrue, altitudeAgl, heading, bank, pitch, vx, vy, vz, vp, vh, vb, noseWheelAngle, speed, fsdReceiveTime, ipcSendTime, clientSendFailures);
 
 	static std::string getName()
 	{
@@ -148,6 +152,60 @@ struct FastPositionUpdateDto
 	}
 };
 
+// Sent by the client to visual machines once a keyframe (FSTPOS) has been delivered.
+// Each entry is the difference between the quantized position and the previous one.
+struct FastPositionDeltaDto
+{
+	std::string callsign;
+	std::vector<int64_t> delta;
+	MSGPACK_DEFINE(callsign, delta);
+
+	static std::string getName()
+	{
+		return FAST_POSITION_DELTA;
+	}
+};
+
+constexpr size_t QUANTIZED_POSITION_FIELDS = 15;
+typedef std::array<int64_t, QUANTIZED_POSITION_FIELDS> QuantizedPosition;
+
+inline int64_t quantize(double value, double scale)
+{
+	return std::isfinite(value) ? std::llround(value * scale) : 0;
+}
+
+// Must match the client's quantizePosition
+inline QuantizedPosition quantizePosition(const FastPositionUpdateDto& dto)
+{
+	return {
+		quantize(dto.latitude, 1e7), quantize(dto.longitude, 1e7),
+		quantize(dto.altitudeTrue, 100), quantize(dto.altitudeAgl, 100),
+		quantize(dto.heading, 100), quantize(dto.bank, 100), quantize(dto.pitch, 100),
+		quantize(dto.vx, 1000), quantize(dto.vy, 1000), quantize(dto.vz, 1000),
+		quantize(dto.vp, 10000), quantize(dto.vh, 10000), quantize(dto.vb, 10000),
+		quantize(dto.noseWheelAngle, 100), quantize(dto.speed, 100)
+	};
+}
+
+inline void dequantizePosition(const QuantizedPosition& q, FastPositionUpdateDto& dto)
+{
+	dto.latitude = q[0] / 1e7;
+	dto.longitude = q[1] / 1e7;
+	dto.altitudeTrue = q[2] / 100.0;
+	dto.altitudeAgl = q[3] / 100.0;
+	dto.heading = q[4] / 100.0;
+	dto.bank = q[5] / 100.0;
+	dto.pitch = q[6] / 100.0;
+	dto.vx = q[7] / 1000.0;
+	dto.vy = q[8] / 1000.0;
+	dto.vz = q[9] / 1000.0;
+	dto.vp = q[10] / 10000.0;
+	dto.vh = q[11] / 10000.0;
+	dto.vb = q[12] / 10000.0;
+	dto.noseWheelAngle = q[13] / 100.0;
+	dto.speed = q[14] / 100.0;
+}
+
 struct HeartbeatDto
 {
 	std::string callsign;
@@ -159,10 +217,14 @@ struct HeartbeatDto
 	}
 };
 
+// PluginVersionDto::capabilities; a plugin from before the field existed reports none
+constexpr int PLUGIN_CAPABILITY_POSITION_DELTAS = 1 << 0; // understands FSTPOSD frames
+
 struct PluginVersionDto
 {
 	int version;
-	MSGPACK_DEFINE(version);
+	int capabilities = 0;
+	MSGPACK_DEFINE(version, capabilities);
 
 	static std::string getName()
 	{
@@ -0,0 +1,100 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#pragma once
+
+#include "latency_histogram.h"
+#include "utilities.h"
+
+#include "XPMPMultiplayer.h"
+
+namespace xpilot
+{
+	enum class FrameSection
+	{
+		CommandQueue,   // queued callbacks and aircraft commands drained by the main flight loop
+		Maintenance,    // AircraftMaintenanceCallback
+		Kinematics,     // batch extrapolation pass of the aircraft store (part of UpdatePosition)
+		UpdatePosition, // XPMP2: all NetworkAircraft::UpdatePosition calls
+		ClampToGround,  // XPMP2
+		Instances,      // XPMP2: instance positions and contrails
+		Sound,          // XPMP2
+		Remote,         // XPMP2: feeding remote clients
+		AiMulti,        // XPMP2: AI/multiplayer (TCAS) dataRefs
+		Labels,         // XPMP2: label drawing
+		Count
+	};
+
+	/// Per-frame cost of the plugin's own flight loop work and of XPMP2's sections. Every section
+	/// records one sample per frame into a histogram. Nothing is timed while disabled.
+	class FrameProfiler
+	{
+	public:
+		static FrameProfiler& GetInstance();
+		FrameProfiler(const FrameProfiler&) = delete;
+		void operator=(const FrameProfiler&) = delete;
+
+		/// Also installs or removes the XPMP2 profiling callback; flight loop only
+		void SetEnabled(bool enabled);
+		bool IsEnabled() const { return m_enabled; }
+
+		void Record(FrameSection section, int64_t micros);
+		LatencySummary Summarize(FrameSection section, bool reset) { return m_histograms[static_cast<size_t>(section)].Summarize(reset); }
+
+		/// Time recorded since the last call, without the nested Kinematics section; flight loop only
+		int64_t TakeFrameTotal();
+
+		static const char* GetName(FrameSection section);
+		static const char* GetDataRefName(FrameSection section);
+
+	private:
+		FrameProfiler() = default;
+		static void XpmpProfileCallback(XPMPProfileSection section, double micros, void* ref);
+		bool m_enabled = false;
+		int64_t m_frameTotal = 0; // [us]
+		std::array<LatencyHistogram, static_cast<size_t>(FrameSection::Count)> m_histograms;
+	};
+
+	/// Records the time until it goes out of scope as one sample of a section, if profiling is enabled
+	class ScopedFrameTimer
+	{
+	public:
+		ScopedFrameTimer(FrameSection section) :
+			m_section(section),
+			m_active(FrameProfiler::GetInstance().IsEnabled()),
+			m_start(m_active ? PrecisionTimestampMicros() : 0)
+		{
+		}
+
+		~ScopedFrameTimer()
+		{
+			if (m_active)
+			{
+				FrameProfiler::GetInstance().Record(m_section, PrecisionTimestampMicros() - m_start);
+			}
+		}
+
+		ScopedFrameTimer(const ScopedFrameTimer&) = delete;
+		ScopedFrameTimer& operator=(const ScopedFrameTimer&) = delete;
+
+	private:
+		FrameSection m_section;
+		bool m_active;
+		int64_t m_start;
+	};
+}
@@ -2,6 +2,7 @@
 #define GeoCalc_h
 
 #include <cmath>
+#include <cstddef>
 
 const double EARTH_RADIUS_NM = 3437.670013352;
 const double PI_OVER_ONE_EIGHTY = 0.0174532925;
@@ -108,4 +109,23 @@ static double GreatCircleDistance(double lon1, double lat1, double lon2, double
 	return 3437.670013352 * num6;
 }
 
+// Batch variants for the per-frame aircraft pass. Both are dominated by the libm calls,
+// so they stay plain loops the compiler is free to unroll.
+
+static void LongitudeScalingFactorBatch(const double* lat, double* out, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		out[i] = LongitudeScalingFactor(lat[i]);
+	}
+}
+
+static void GreatCircleDistanceBatch(const double* lon1, const double* lat1, const double* lon2, const double* lat2, double* out, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		out[i] = GreatCircleDistance(lon1[i], lat1[i], lon2[i], lat2[i]);
+	}
+}
+
 #endif // !GeoCalc_h
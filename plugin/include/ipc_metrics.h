@@ -0,0 +1,99 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#pragma once
+
+#include "latency_histogram.h"
+
+namespace xpilot
+{
+	constexpr int IPC_METRICS_WINDOW_SECONDS = 5;
+
+	enum class IpcLatency
+	{
+		ClientHop,      // FSD packet received by the client -> handed to nng
+		Transit,        // handed to nng by the client -> received by the socket worker
+		QueueWait,      // queued by the socket worker -> invoked in the flight loop
+		Apply,          // execution time of the queued callback
+		ApplyToRender,  // position applied -> next UpdatePosition of that aircraft
+		Count
+	};
+
+	enum class IpcMessageType
+	{
+		AddAircraft,
+		FastPosition,
+		Heartbeat,
+		AircraftConfig,
+		DeleteAircraft,
+		Other,
+		Count
+	};
+
+	/// Process-wide IPC counters, fed from the socket worker and the flight loop
+	class IpcMetrics
+	{
+	public:
+		static IpcMetrics& GetInstance();
+		IpcMetrics(const IpcMetrics&) = delete;
+		void operator=(const IpcMetrics&) = delete;
+
+		void Record(IpcLatency metric, int64_t micros) { m_histograms[static_cast<size_t>(metric)].Record(micros); }
+		LatencySummary Summarize(IpcLatency metric, bool reset) { return m_histograms[static_cast<size_t>(metric)].Summarize(reset); }
+
+		static const char* GetName(IpcLatency metric);
+		static const char* GetDataRefName(IpcLatency metric);
+		static const char* GetName(IpcMessageType type);
+
+		void CountMessage(const std::string& type);
+		uint64_t GetMessageCount(IpcMessageType type) const { return m_messageCounts[static_cast<size_t>(type)].load(std::memory_order_relaxed); }
+
+		/// Tracks the depth of the main thread callback queue, keeping the high-water mark for the current window
+		void RecordQueueDepth(size_t depth)
+		{
+			QueueDepth.store(depth, std::memory_order_relaxed);
+			size_t prev = QueueDepthPeak.load(std::memory_order_relaxed);
+			while (depth > prev && !QueueDepthPeak.compare_exchange_weak(prev, depth, std::memory_order_relaxed)) {}
+		}
+
+		/// Tracks the depth of the outbound queue plus the flight loop's backlog, same window as above
+		void RecordOutboundDepth(size_t depth)
+		{
+			size_t prev = OutboundDepthPeak.load(std::memory_order_relaxed);
+			while (depth > prev && !OutboundDepthPeak.compare_exchange_weak(prev, depth, std::memory_order_relaxed)) {}
+		}
+
+		std::atomic<uint64_t> MessagesReceived{ 0 };
+		std::atomic<uint64_t> SendFailures{ 0 };
+		std::atomic<uint64_t> ClientSendFailures{ 0 };
+		std::atomic<uint64_t> DeltaFramesDiscarded{ 0 };
+		std::atomic<uint64_t> CoalescedCommands{ 0 };
+		std::atomic<uint64_t> QueueFullDropped{ 0 };
+		std::atomic<uint64_t> QueueFullSpilled{ 0 };
+		std::atomic<size_t> QueueDepth{ 0 };
+		std::atomic<size_t> QueueDepthPeak{ 0 };
+		std::atomic<uint64_t> OutboundDropped{ 0 };
+		std::atomic<uint64_t> OutboundCoalesced{ 0 };
+		std::atomic<size_t> OutboundDepthPeak{ 0 };
+
+	private:
+		IpcMetrics() = default;
+		std::array<LatencyHistogram, static_cast<size_t>(IpcLatency::Count)> m_histograms;
+		std::array<std::atomic<uint64_t>, static_cast<size_t>(IpcMessageType::Count)> m_messageCounts{};
+	};
+}
@@ -0,0 +1,66 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#pragma once
+
+namespace xpilot
+{
+	constexpr int IPC_REPLAY_POLL_INTERVAL = 10; // [ms] receive timeout of the socket worker, bounds replay timing jitter
+
+	/// Captures the aircraft traffic messages received from the client together with their arrival times, and
+	/// plays such a capture back through the socket worker's decoding path. Replaying a busy session while
+	/// disconnected makes the traffic load reproducible, so frame profiles can be compared between builds.
+	/// Start and Stop are called from the flight loop, Record and Replay from the socket thread.
+	class IpcRecording
+	{
+	public:
+		bool StartRecording(const std::string& path);
+		void StopRecording();
+		bool IsRecording() const { return m_recording; }
+
+		bool StartReplay(const std::string& path);
+		void StopReplay();
+		bool IsReplaying() const { return m_replaying; }
+
+		/// Messages written so far, or replayed so far
+		size_t GetMessageCount() const { return m_messageCount; }
+		size_t GetReplayLength() const { return m_replayLength; }
+
+		void Record(const char* buffer, size_t length);
+
+		/// Hands every message that is due to deliver; returns true once, when the last message was delivered
+		bool Replay(const std::function<void(const char*, size_t)>& deliver);
+
+	private:
+		struct Message
+		{
+			int64_t Offset; // [us] since the start of the recording
+			std::vector<char> Data;
+		};
+
+		std::mutex m_mutex;
+		std::ofstream m_file;
+		std::vector<Message> m_messages;
+		size_t m_next = 0;
+		int64_t m_start = 0; // [us]
+		std::atomic<bool> m_recording{ false };
+		std::atomic<bool> m_replaying{ false };
+		std::atomic<size_t> m_messageCount{ 0 };
+		std::atomic<size_t> m_replayLength{ 0 };
+	};
+}
@@ -0,0 +1,154 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#pragma once
+
+#include "owned_data_ref.h"
+
+namespace xpilot
+{
+	struct LatencySummary
+	{
+		uint64_t Count = 0;
+		float P50 = 0.0f; // [ms]
+		float P95 = 0.0f; // [ms]
+		float P99 = 0.0f; // [ms]
+		float Max = 0.0f; // [ms]
+	};
+
+	/// Log-linear histogram of microsecond samples. Recording is lock-free so that
+	/// the socket thread and the flight loop can feed the same histogram; each
+	/// power of two is split into 8 sub-buckets (~12% resolution).
+	class LatencyHistogram
+	{
+	public:
+		void Record(int64_t micros)
+		{
+			if (micros < 0)
+				micros = 0;
+
+			m_buckets[BucketIndex(static_cast<uint64_t>(micros))].fetch_add(1, std::memory_order_relaxed);
+			m_count.fetch_add(1, std::memory_order_relaxed);
+
+			int64_t prev = m_max.load(std::memory_order_relaxed);
+			while (micros > prev && !m_max.compare_exchange_weak(prev, micros, std::memory_order_relaxed)) {}
+		}
+
+		/// Computes percentiles for everything recorded so far, optionally starting a new window
+		LatencySummary Summarize(bool reset)
+		{
+			std::array<uint64_t, BucketCount> counts{};
+			uint64_t total = 0;
+			for (size_t i = 0; i < BucketCount; i++)
+			{
+				counts[i] = reset ? m_buckets[i].exchange(0, std::memory_order_relaxed) : m_buckets[i].load(std::memory_order_relaxed);
+				total += counts[i];
+			}
+			int64_t max = reset ? m_max.exchange(0, std::memory_order_relaxed) : m_max.load(std::memory_order_relaxed);
+			if (reset)
+			{
+				m_count.store(0, std::memory_order_relaxed);
+			}
+
+			LatencySummary summary;
+			summary.Count = total;
+			summary.Max = max / 1000.0f;
+			if (total == 0)
+				return summary;
+
+			summary.P50 = ValueAt(counts, total, 0.50) / 1000.0f;
+			summary.P95 = ValueAt(counts, total, 0.95) / 1000.0f;
+			summary.P99 = ValueAt(counts, total, 0.99) / 1000.0f;
+			return summary;
+		}
+
+		uint64_t Count() const { return m_count.load(std::memory_order_relaxed); }
+
+	private:
+		static constexpr int SubBucketBits = 3;
+		static constexpr int SubBuckets = 1 << SubBucketBits;
+		static constexpr int LinearLimit = SubBuckets * 2;
+		static constexpr size_t BucketCount = LinearLimit + (64 - SubBucketBits - 1) * SubBuckets;
+
+		static size_t BucketIndex(uint64_t value)
+		{
+			if (value < LinearLimit)
+				return static_cast<size_t>(value);
+
+			int msb = 63;
+			while (!(value & (uint64_t(1) << msb)))
+				msb--;
+
+			const uint64_t sub = (value >> (msb - SubBucketBits)) & (SubBuckets - 1);
+			return LinearLimit + (msb - SubBucketBits - 1) * SubBuckets + static_cast<size_t>(sub);
+		}
+
+		static double BucketMidpoint(size_t index)
+		{
+			if (index < LinearLimit)
+				return static_cast<double>(index);
+
+			const size_t offset = index - LinearLimit;
+			const int msb = static_cast<int>(offset / SubBuckets) + SubBucketBits + 1;
+			const uint64_t sub = offset % SubBuckets;
+			const double lower = std::ldexp(1.0, msb) + sub * std::ldexp(1.0, msb - SubBucketBits);
+			return lower + std::ldexp(1.0, msb - SubBucketBits) / 2.0;
+		}
+
+		static double ValueAt(const std::array<uint64_t, BucketCount>& counts, uint64_t total, double quantile)
+		{
+			const uint64_t rank = static_cast<uint64_t>(std::ceil(quantile * total));
+			uint64_t seen = 0;
+			for (size_t i = 0; i < BucketCount; i++)
+			{
+				seen += counts[i];
+				if (seen >= rank && counts[i] > 0)
+					return BucketMidpoint(i);
+			}
+			return 0.0;
+		}
+
+		std::array<std::atomic<uint64_t>, BucketCount> m_buckets{};
+		std::atomic<uint64_t> m_count{ 0 };
+		std::atomic<int64_t> m_max{ 0 };
+	};
+
+	/// Publishes the percentiles of a histogram as <prefix>_p50, <prefix>_p95 and <prefix>_p99 [ms]
+	class LatencyDataRefs
+	{
+	public:
+		LatencyDataRefs(const std::string& prefix) :
+			m_p50(prefix + "_p50", ReadOnly),
+			m_p95(prefix + "_p95", ReadOnly),
+			m_p99(prefix + "_p99", ReadOnly)
+		{
+		}
+
+		void Publish(const LatencySummary& summary)
+		{
+			m_p50 = summary.P50;
+			m_p95 = summary.P95;
+			m_p99 = summary.P99;
+		}
+
+	private:
+		OwnedDataRef<float> m_p50;
+		OwnedDataRef<float> m_p95;
+		OwnedDataRef<float> m_p99;
+	};
+}
@@ -0,0 +1,66 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#pragma once
+
+#include "aircraft_command.h"
+
+namespace xpilot
+{
+	/// Work the socket worker hands to the flight loop. Aircraft commands go through a lock-free queue,
+	/// everything else is a callback queued under a mutex. Both draw their sequence numbers from the same
+	/// counter, so Invoke runs them in the order they were queued.
+	class MainThreadQueue
+	{
+	public:
+		/// dispatch applies one aircraft command on the flight loop
+		explicit MainThreadQueue(std::function<void(const AircraftCommand&)> dispatch);
+
+		MainThreadQueue(const MainThreadQueue&) = delete;
+		MainThreadQueue& operator=(const MainThreadQueue&) = delete;
+
+		/// Any thread
+		void QueueCallback(const std::function<void()>& cb);
+		/// Any thread; see the implementation for what happens while the command queue is full
+		void QueueCommand(AircraftCommand& command);
+		/// Flight loop only
+		void Invoke();
+
+	private:
+		struct QueuedCallback
+		{
+			std::function<void()> Callback;
+			int64_t QueuedAt; // [us]
+			uint64_t Sequence;
+		};
+
+		std::function<void(const AircraftCommand&)> m_dispatch;
+		std::atomic<uint64_t> m_workSequence{ 0 };
+
+		std::mutex m_mutex;
+		std::deque<QueuedCallback> m_queuedCallbacks;
+		std::atomic<bool> m_spillPending{ false }; // a command went to the callback queue, see QueueCommand
+
+		std::unique_ptr<AircraftCommandQueue> m_commandQueue;
+		std::vector<AircraftCommand> m_commandBatch; // flight loop only
+		std::vector<bool> m_commandSuperseded; // flight loop only
+		std::unordered_set<std::string_view> m_coalescedPositions; // flight loop only
+		std::unordered_set<std::string_view> m_coalescedHeartbeats; // flight loop only
+		void CoalesceCommandBatch();
+	};
+}
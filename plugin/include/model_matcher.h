@@ -0,0 +1,69 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#pragma once
+
+#include "XPMPAircraft.h"
+
+namespace xpilot
+{
+	struct ModelMatchResult
+	{
+		uint64_t Ticket;
+		XPMP2::CSLModel* Model; // nullptr if there are no models; Create then matches on its own
+	};
+
+	/// Runs XPMP2's CSL model matching on a background thread, so creating an aircraft on the flight loop only
+	/// has to instantiate the model it was handed. Matching only reads XPMP2's live model catalogue, which
+	/// changes when the CSL loader commits, before AircraftManager requests any match.
+	class ModelMatcher
+	{
+	public:
+		ModelMatcher();
+		~ModelMatcher();
+
+		ModelMatcher(const ModelMatcher&) = delete;
+		ModelMatcher& operator=(const ModelMatcher&) = delete;
+
+		/// The result comes back from Collect under the same ticket
+		void Request(uint64_t ticket, const std::string& typeCode, const std::string& airline);
+
+		/// Appends the matches finished since the last call; flight loop only
+		void Collect(std::vector<ModelMatchResult>& results);
+
+		/// Drops requests that have not started; a match already running still reports under its ticket
+		void Clear();
+
+	private:
+		struct MatchRequest
+		{
+			uint64_t Ticket;
+			std::string TypeCode;
+			std::string Airline;
+		};
+
+		void WorkerLoop();
+
+		std::mutex m_mutex;
+		std::condition_variable m_requestAvailable;
+		std::deque<MatchRequest> m_requests;
+		std::vector<ModelMatchResult> m_results;
+		bool m_stopping = false;
+		std::thread m_thread; // last: the worker starts in the constructor and uses all of the above
+	};
+}
@@ -19,6 +19,7 @@
 #pragma once
 
 #include "dto.h"
+#include "snapshot.h"
 #include "xpilot.h"
 #include "xp_img_window.h"
 
@@ -29,35 +30,47 @@ namespace xpilot
 	class NearbyAtcList
 	{
 	public:
-		std::string GetCallsign() const { return m_callsign; }
-		std::string GetFrequency() const { return m_frequency; }
-		std::string GetRealName() const { return m_realName; }
+		const std::string& GetCallsign() const { return m_callsign; }
+		const std::string& GetLabel() const { return m_label; }
+		const std::string& GetFrequency() const { return m_frequency; }
+		const std::string& GetRealName() const { return m_realName; }
 		int GetXplaneFrequency() const { return m_xplaneFrequency; }
-		void SetCallsign(const std::string& value) { m_callsign = value; }
+		void SetCallsign(const std::string& value) { m_callsign = value; m_label = " " + value; }
 		void SetFrequency(const std::string& value) { m_frequency = value; }
 		void SetRealName(const std::string& value) { m_realName = value; }
 		void SetXplaneFrequency(const int value) { m_xplaneFrequency = value; }
 	private:
 		std::string m_callsign;
+		std::string m_label; // callsign as shown in the table
 		std::string m_frequency;
 		std::string m_realName;
 		int m_xplaneFrequency = 0;
 	};
 
+	/// One facility group of the nearby ATC window, e.g. Tower, with its stations sorted by callsign
+	struct NearbyAtcFacility
+	{
+		std::string Header;
+		std::string Label; // header as shown above the table
+		std::vector<NearbyAtcList> Stations;
+	};
+
 	class NearbyAtcWindow : public XPImgWindow
 	{
 	public:
 		NearbyAtcWindow(XPilot* instance);
 		~NearbyAtcWindow() final = default;
+		/// Safe from any thread; sorts the stations into facilities here so rendering picks up ready-made
+		/// tables on its next frame
 		void UpdateList(const NearbyAtcDto& data);
 		void ClearList();
 	protected:
 		void buildInterface() override;
 		void RenderAtcStationEntry(const NearbyAtcList& station);
-		void RenderAtcTable(const std::string& headerText, const std::vector<std::string>& callsignSuffixes);
+		void RenderAtcTable(const NearbyAtcFacility& facility);
 	private:
 		XPilot* m_env;
-		std::mutex m_mutex;
+		Snapshot<std::vector<NearbyAtcFacility>> m_facilities; // non-empty facilities in display order
 		DataRefAccess<int> m_com1Frequency;
 		DataRefAccess<int> m_com2Frequency;
 	};
@@ -20,8 +20,9 @@
 
 #define INCLUDE_FMOD_SOUND 1
 
-#include "vector3.hpp"
-#include "terrain_probe.h"
+#include "aircraft_store.h"
+#include "terrain_cache.h"
+#include "terrain_elevation_history.h"
 #include "xpilot_api.h"
 
 #include "XPMPAircraft.h"
@@ -34,36 +35,26 @@
 
 namespace xpilot
 {
-	struct AircraftVisualState
+	/// Matches one field of a CSL model's classification. The spec is a list of alternatives separated
+	/// by '|'; within an alternative '#' matches a digit, '?' any character and a trailing '*' any remainder.
+	/// Alternatives without wildcards are looked up in a hash set.
+	class FlightModelField
 	{
-		double Lat;
-		double Lon;
-		double AltitudeTrue;
-		std::optional<double> AltitudeAgl = {};
-		double Pitch;
-		double Heading;
-		double Bank;
-		double NoseWheelAngle;
-	};
-
-	struct WorldPoint
-	{
-		double Latitude;
-		double Longitude;
-	};
-
-	struct TerrainElevationData
-	{
-		int64_t Timestamp;
-		WorldPoint Location;
-		double RemoteValue;
-		double LocalValue;
+	public:
+		FlightModelField(const char* spec);
+		bool Matches(std::string_view value) const;
+	private:
+		bool m_any = false;
+		std::unordered_set<std::string> m_exact;
+		std::vector<std::string> m_patterns;
 	};
 
 	struct FlightModelInfo
 	{
 		std::string category;
-		std::string regex;
+		FlightModelField wtc;            // doc8643 wake turbulence category: L, M, H, J, -
+		FlightModelField classification; // doc8643 classification: L2J, H1T, ...
+		FlightModelField icaoType;
 	};
 
 	class FlightModel
@@ -77,15 +68,23 @@ namespace xpilot
 	public:
 		static void InitializeModels();
 		static std::vector<FlightModelInfo> modelMatches;
+		static std::unordered_map<std::string, FlightModel> modelCache; // by "wtc;classification;type"
 	};
 
-	constexpr long TERRAIN_ELEVATION_DATA_USABLE_AGE = 2000;
 	constexpr double MAX_USABLE_ALTITUDE_AGL = 100.0;
-	constexpr double TERRAIN_ELEVATION_MAX_SLOPE = 3.0;
 	constexpr double MIN_AGL_FOR_CLIMBOUT = 50.0;
 	constexpr double TERRAIN_OFFSET_WINDOW_LANDING = 2.0;
 	constexpr double TERRAIN_OFFSET_WINDOW_CLIMBOUT = 10.0;
 	constexpr double MIN_TERRAIN_OFFSET_MAGNITUDE = 0.1;
+	constexpr float TERRAIN_LOD_NEAR_DISTANCE = 500.0f;     // [m] camera distance sampled every frame
+	constexpr float TERRAIN_LOD_MID_DISTANCE = 2000.0f;     // [m]
+	constexpr int64_t TERRAIN_LOD_MID_INTERVAL = 100;       // [ms]
+	constexpr int64_t TERRAIN_LOD_FAR_INTERVAL = 250;       // [ms]
+	constexpr double TERRAIN_LOD_VERTICAL_SPEED = 1.0;      // [m/s] above this, near the ground, sample every frame
+	constexpr double TERRAIN_LOD_VERTICAL_MAX_AGL = 2500.0; // [ft]
+	constexpr int LOD_MID_FRAME_INTERVAL = 3;               // [frames] between animation updates of mid-range aircraft
+	constexpr int LOD_FAR_FRAME_INTERVAL = 4;               // [frames] between position updates of far aircraft
+	constexpr int LOD_REDUCED_RATE_FACTOR = 2;              // interval multiplier while the frame budget governor sheds work
 
 	inline double CalculateNormalizedDelta(double start, double end, double lowerBound, double upperBound)
 	{
@@ -136,7 +135,9 @@ namespace xpilot
 	{
 	public:
 		NetworkAircraft(const std::string& _callsign, const AircraftVisualState& _visualState, const std::string& _icaoType,
-			const std::string& _icaoAirline, const std::string& _livery, XPMPPlaneID _modeS_id, const std::string& _modelName);
+			const std::string& _icaoAirline, const std::string& _livery, XPMPPlaneID _modeS_id, const std::string& _modelName,
+			XPMP2::CSLModel* _model = nullptr);
+		virtual ~NetworkAircraft();
 
 		void copyBulkData(XPilotAPIAircraft::XPilotAPIBulkData* pOut, size_t size) const;
 		void copyBulkData(XPilotAPIAircraft::XPilotAPIBulkInfoTexts* pOut, size_t size) const;
@@ -145,13 +146,12 @@ namespace xpilot
 		void RecordTerrainElevationHistory(double currentTimestamp);
 		void UpdateVelocityVectors();
 
-		void UpdateStaticLabel();
+		void UpdateStaticLabel(AircraftLabelType labelType);
 
 		float GetLift() const override;
 
 		FlightModel GetFlightModel(const XPMP2::CSLModelInfo_t model);
 
-		bool IsFirstRenderPending = true;
 		bool IsReportedOnGround = false;
 		bool IsGearDown = false;
 		bool IsEnginesRunning = false;
@@ -169,32 +169,52 @@ namespace xpilot
 		XPMPPlaneRadar_t Radar;
 		FlightModel AircraftFlightModel;
 
-		TerrainProbe LocalTerrainProbe;
 		std::optional<double> LocalTerrainElevation = {};
+		std::optional<double> SampledTerrainElevation = {};
+		int64_t NextTerrainSampleTime = 0;
 		std::optional<double> AdjustedAltitude = {};
 		double TargetTerrainOffset = 0.0;
 		double TerrainOffset = 0.0;
 		double TerrainOffsetMagnitude = 0.0;
-		std::list<TerrainElevationData> TerrainElevationHistory;
+		xpilot::TerrainElevationHistory TerrainElevationHistory;
 		bool HasUsableTerrainElevationData;
 
-		int64_t LastUpdated;
-		AircraftVisualState VisualState;
-		AircraftVisualState PredictedVisualState;
-
-		Vector3 PositionalVelocities;
-		Vector3 PositionalErrorVelocities;
-		Vector3 RotationalVelocities;
-		Vector3 RotationalErrorVelocities;
-		int64_t ApplyErrorVelocitiesUntil;
-		int64_t LastVelocityUpdate;
+		int64_t PositionAppliedAt = 0; // [us] pending apply -> render latency sample
+		float PositionElapsed = 0.0f;  // [s] since the position was last handed to XPMP2
+		float AnimationElapsed = 0.0f; // [s] since engine, prop and tire angles were last advanced
+
+		// kinematic state lives in the AircraftStore slot owned by this aircraft
+		AircraftHandle GetHandle() const { return m_handle; }
+		int64_t& LastUpdated() { return m_store.LastUpdated[m_handle.Slot]; }
+		AircraftVisualState& VisualState() { return m_store.VisualState[m_handle.Slot]; }
+		AircraftVisualState& PredictedVisualState() { return m_store.PredictedVisualState[m_handle.Slot]; }
+		Vector3& PositionalVelocities() { return m_store.PositionalVelocities[m_handle.Slot]; }
+		Vector3& PositionalErrorVelocities() { return m_store.PositionalErrorVelocities[m_handle.Slot]; }
+		Vector3& RotationalVelocities() { return m_store.RotationalVelocities[m_handle.Slot]; }
+		Vector3& RotationalErrorVelocities() { return m_store.RotationalErrorVelocities[m_handle.Slot]; }
+		int64_t& ApplyErrorVelocitiesUntil() { return m_store.ApplyErrorVelocitiesUntil[m_handle.Slot]; }
+		int64_t& LastVelocityUpdate() { return m_store.LastVelocityUpdate[m_handle.Slot]; }
+		bool IsFirstRenderPending() const { return m_store.FirstRenderPending[m_handle.Slot] != 0; }
+		bool IsFrozen() const { return m_store.IsFrozen(m_handle.Slot); }
+		void Thaw() { m_store.Thaw(m_handle.Slot); }
 
 	protected:
 		virtual void UpdatePosition(float, int) override;
-		AircraftVisualState ExtrapolatePosition(Vector3 velocityVector, Vector3 rotationVector, double interval);
 		void PerformGroundClamping(float frameRate);
+		void UpdateLocalFrameAnchor();
+		bool CanFreeze(int64_t currentTimestamp);
+		AircraftLodTier GetLodTier();
+		void UpdateAnimation(int64_t currentTimestamp);
+		int64_t GetTerrainSampleInterval();
+		bool IsNearTerrain();
+		bool IsTerrainCacheEligible();
 		void EnsureAboveGround();
 		void ClearRotationalVelocities();
 		std::string aircraftLabel;
+		uint32_t m_labelRevision = 0; // AircraftFrameSettings::LabelRevision the label was built for
+
+	private:
+		AircraftStore& m_store;
+		AircraftHandle m_handle;
 	};
 }
\ No newline at end of file
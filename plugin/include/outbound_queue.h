@@ -0,0 +1,71 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#pragma once
+
+#include "bounded_mpsc_queue.h"
+
+namespace xpilot
+{
+	/// What happens to a message for the client while the outbound queue is full
+	enum class OutboundPolicy : uint8_t
+	{
+		Retry,      // held back and sent in order once there is room
+		Coalesce,   // aircraft added/deleted notices; only the latest one per callsign matters
+		Drop        // requests the user can simply repeat
+	};
+
+	/// An encoded message for the client. The flight loop packs it, the socket worker sends it.
+	struct OutboundMessage
+	{
+		OutboundPolicy Policy = OutboundPolicy::Retry;
+		std::string Key; // Coalesce only
+		std::string Data;
+	};
+
+	constexpr size_t OUTBOUND_QUEUE_CAPACITY = 256;
+	constexpr size_t OUTBOUND_BACKLOG_CAPACITY = 1024; // held back by the flight loop while the queue is full
+	class OutboundQueue : public BoundedMpscQueue<OutboundMessage, OUTBOUND_QUEUE_CAPACITY> {};
+
+	/// Messages for the client, packed by the flight loop and sent by the socket worker, so a stalled client
+	/// can't hold up a frame; see Queue for what happens while the queue is full
+	class OutboundChannel
+	{
+	public:
+		/// send returns false if the client can't take the message right now
+		explicit OutboundChannel(std::function<bool(const OutboundMessage&)> send);
+
+		OutboundChannel(const OutboundChannel&) = delete;
+		OutboundChannel& operator=(const OutboundChannel&) = delete;
+
+		/// Flight loop only
+		void Queue(OutboundMessage&& message);
+		/// Moves held back messages into the queue as far as there is room; flight loop only
+		void FlushBacklog();
+		/// Socket worker, or the flight loop once it has stopped
+		void Drain();
+		/// Sends what is left while the client still reads, then forgets the rest; after the socket worker has stopped
+		void Close();
+
+	private:
+		std::function<bool(const OutboundMessage&)> m_send;
+		std::unique_ptr<OutboundQueue> m_queue;
+		std::deque<OutboundMessage> m_backlog; // flight loop only
+		std::optional<OutboundMessage> m_pending; // socket worker only; the client couldn't take it yet
+	};
+}
@@ -47,6 +47,9 @@ inline int ToggleTcasCommandHandler(XPLMCommandRef inCommand, XPLMCommandPhase i
 inline XPLMCommandRef ToggleAircraftLabelsCommand = NULL;
 inline int ToggleAircraftLabelsCommandHandler(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void* inRefcon);
 
+inline XPLMCommandRef ToggleDebugWindowCommand = NULL;
+inline int ToggleDebugWindowCommandHandler(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void* inRefcon);
+
 inline XPLMCommandRef ContactAtcCommand = XPLMFindCommand("sim/operation/contact_atc");
 inline int ContactAtcCommandHandler(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void* inRefcon);
 
@@ -58,4 +61,5 @@ static int MenuDefaultAtis = 0;
 static int MenuTextMessageConsole = 0;
 static int MenuNotificationPanel = 0;
 static int MenuToggleTcas = 0;
-static int MenuToggleAircraftLabels = 0;
\ No newline at end of file
+static int MenuToggleAircraftLabels = 0;
+static int MenuDebugWindow = 0;
\ No newline at end of file
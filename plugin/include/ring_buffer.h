@@ -0,0 +1,76 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#pragma once
+
+namespace xpilot
+{
+	/// Fixed-capacity circular buffer. Pushing onto a full buffer overwrites the oldest element,
+	/// so it never allocates after construction. Not thread safe.
+	template<typename T, size_t Capacity>
+	class RingBuffer
+	{
+		static_assert(Capacity > 0, "Capacity must not be zero");
+
+	public:
+		void PushBack(const T& item)
+		{
+			m_items[(m_head + m_size) % Capacity] = item;
+			if (m_size < Capacity)
+			{
+				m_size++;
+			}
+			else
+			{
+				m_head = (m_head + 1) % Capacity;
+			}
+		}
+
+		void PopFront()
+		{
+			if (m_size > 0)
+			{
+				m_head = (m_head + 1) % Capacity;
+				m_size--;
+			}
+		}
+
+		void Clear()
+		{
+			m_head = 0;
+			m_size = 0;
+		}
+
+		/// Element at position index, counted from the oldest
+		const T& operator[](size_t index) const { return m_items[(m_head + index) % Capacity]; }
+		T& operator[](size_t index) { return m_items[(m_head + index) % Capacity]; }
+
+		const T& Front() const { return (*this)[0]; }
+		const T& Back() const { return (*this)[m_size - 1]; }
+
+		size_t Size() const { return m_size; }
+		bool Empty() const { return m_size == 0; }
+		bool Full() const { return m_size == Capacity; }
+		static constexpr size_t GetCapacity() { return Capacity; }
+
+	private:
+		std::array<T, Capacity> m_items{};
+		size_t m_head = 0;
+		size_t m_size = 0;
+	};
+}
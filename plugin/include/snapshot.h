@@ -0,0 +1,41 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#pragma once
+
+namespace xpilot
+{
+	/// Holds the latest immutable version of some state (read-copy-update). The writer publishes a complete
+	/// new copy, a reader keeps whichever copy was current for as long as it needs it, so the render path
+	/// never waits for a writer and a writer never waits for a frame.
+	template<typename T>
+	class Snapshot
+	{
+	public:
+		Snapshot() : m_current(std::make_shared<const T>()) {}
+
+		Snapshot(const Snapshot&) = delete;
+		Snapshot& operator=(const Snapshot&) = delete;
+
+		std::shared_ptr<const T> Get() const { return std::atomic_load(&m_current); }
+		void Publish(T&& value) { std::atomic_store(&m_current, std::shared_ptr<const T>(std::make_shared<const T>(std::move(value)))); }
+
+	private:
+		std::shared_ptr<const T> m_current;
+	};
+}
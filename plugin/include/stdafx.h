@@ -10,6 +10,7 @@
 #include <cmath>
 #include <cstdarg>
 #include <cstdint>
+#include <condition_variable>
 #include <cstring>
 #include <ctime>
 #include <deque>
@@ -29,7 +30,10 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 // External library headers
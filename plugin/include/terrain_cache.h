@@ -0,0 +1,70 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#pragma once
+
+#include "terrain_probe.h"
+
+namespace xpilot
+{
+	constexpr double TERRAIN_CACHE_CELL_SIZE = 0.0001; // [deg] ~11 m of latitude
+	constexpr int64_t TERRAIN_CACHE_SAMPLE_LIFETIME = 60000; // [ms] unused samples are evicted after this
+	constexpr int64_t TERRAIN_CACHE_SWEEP_INTERVAL = 10000; // [ms]
+
+	/// Terrain elevation shared by all network aircraft. Probes the corners of a small lat/lon grid
+	/// once, caches them and interpolates in between, so aircraft taxiing over the same apron reuse
+	/// each other's probes. Airborne aircraft rarely share cells and probe directly instead, which
+	/// keeps the grid to the airports. Flight loop only.
+	class TerrainCache
+	{
+	public:
+		static TerrainCache& GetInstance();
+		TerrainCache(const TerrainCache&) = delete;
+		void operator=(const TerrainCache&) = delete;
+
+		/// Terrain elevation in feet, 0 where the probe does not hit terrain (same as TerrainProbe)
+		double GetTerrainElevation(double degLat, double degLon);
+		/// Terrain elevation in feet from a single probe, bypassing the grid
+		double ProbeTerrainElevation(double degLat, double degLon);
+
+		/// Drops all samples, e.g. after new scenery was loaded
+		void Invalidate();
+		/// Evicts samples that have not been used for a while
+		void Sweep();
+		/// Releases the probe; must be called before the plugin is disabled
+		void Shutdown();
+
+		size_t GetSampleCount() const { return m_samples.size(); }
+
+	private:
+		TerrainCache() = default;
+
+		struct Sample
+		{
+			double Elevation;
+			int64_t LastUsed;
+		};
+
+		double GetCornerElevation(int64_t latIndex, int64_t lonIndex, int64_t now);
+		TerrainProbe& GetProbe();
+
+		std::unique_ptr<TerrainProbe> m_probe;
+		std::unordered_map<uint64_t, Sample> m_samples;
+		int64_t m_lastSweep = 0;
+	};
+}
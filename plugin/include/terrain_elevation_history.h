@@ -0,0 +1,61 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#pragma once
+
+#include "ring_buffer.h"
+
+namespace xpilot
+{
+	struct WorldPoint
+	{
+		double Latitude;
+		double Longitude;
+	};
+
+	struct TerrainElevationData
+	{
+		int64_t Timestamp;
+		WorldPoint Location;
+		double RemoteValue;
+		double LocalValue;
+	};
+
+	constexpr long TERRAIN_ELEVATION_DATA_USABLE_AGE = 2000;
+	constexpr size_t TERRAIN_ELEVATION_HISTORY_CAPACITY = 64; // samples; covers the usable age at over 30 updates per second
+	constexpr double TERRAIN_ELEVATION_MAX_SLOPE = 3.0;
+
+	/// The terrain elevations recorded under an aircraft near the ground over the last couple of seconds.
+	/// The terrain offset is only trusted when they span TERRAIN_ELEVATION_DATA_USABLE_AGE and neither the
+	/// remote nor the local terrain between the oldest and the newest sample is steeper than
+	/// TERRAIN_ELEVATION_MAX_SLOPE.
+	class TerrainElevationHistory
+	{
+	public:
+		/// Drops the samples that are too old to count at currentTimestamp
+		void Trim(double currentTimestamp);
+		/// Samples must be recorded in timestamp order
+		void Record(const TerrainElevationData& sample);
+		bool IsUsable() const;
+
+		const RingBuffer<TerrainElevationData, TERRAIN_ELEVATION_HISTORY_CAPACITY>& Samples() const { return m_samples; }
+
+	private:
+		RingBuffer<TerrainElevationData, TERRAIN_ELEVATION_HISTORY_CAPACITY> m_samples;
+	};
+}
@@ -28,13 +28,51 @@ namespace xpilot
 	class ConsoleMessage
 	{
 	public:
-		std::string GetMessage() { return m_message; }
-		void SetMessage(std::string value) { m_message = value; }
-		void SetColor(rgb color) { m_color = color; }
-		ImVec4 GetColor() const { return ImVec4(m_color.red / 255.0f, m_color.green / 255.0f, m_color.blue / 255.0f, 1.0f); }
+		const std::string& GetMessage() const { return m_message; }
+		void SetMessage(std::string value) { m_message = std::move(value); }
+		void SetColor(rgb color) { m_color = ImVec4(color.red / 255.0f, color.green / 255.0f, color.blue / 255.0f, 1.0f); }
+		const ImVec4& GetColor() const { return m_color; }
+		uint64_t GetSequence() const { return m_sequence; }
+		void SetSequence(uint64_t value) { m_sequence = value; }
 	private:
 		std::string m_message;
-		rgb m_color;
+		ImVec4 m_color;
+		uint64_t m_sequence = 0;
+	};
+
+	/// One screen line of a console message, as laid out for the current window width
+	struct ConsoleLine
+	{
+		uint64_t Message; // sequence number of the message
+		uint32_t Start; // byte range within the message text
+		uint32_t End;
+	};
+
+	constexpr size_t CONSOLE_HISTORY_CAPACITY = 2000; // upper limit for the configurable history length
+
+	/// Message history of one console tab. Keeps the newest messages up to the configured limit and splits
+	/// each one into screen lines once, so a frame only draws the lines scrolled into view.
+	class ConsoleHistory
+	{
+	public:
+		void Add(const std::string& message, const rgb& color);
+		void Clear();
+
+		/// Draws into the current child window
+		void Render(bool scrollToBottom);
+
+		const std::deque<ConsoleMessage>& GetMessages() const { return m_messages; }
+		const std::deque<ConsoleLine>& GetLines() const { return m_lines; }
+		size_t GetLaidOutCount() const { return m_laidOut; }
+
+	private:
+		void Layout(const ConsoleMessage& message, float wrapWidth);
+
+		std::deque<ConsoleMessage> m_messages; // grows to the configured limit only, evicted text is freed
+		std::deque<ConsoleLine> m_lines;
+		uint64_t m_nextSequence = 0;
+		size_t m_laidOut = 0; // oldest messages already split into m_lines
+		float m_wrapWidth = 0.0f; // width m_lines were laid out for
 	};
 
 	struct Tab
@@ -43,7 +81,7 @@ namespace xpilot
 		std::string textInput;
 		bool isOpen;
 		bool scrollToBottom;
-		std::list<ConsoleMessage> messageHistory;
+		ConsoleHistory messageHistory;
 	};
 
 	enum class ConsoleTabType
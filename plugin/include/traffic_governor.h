@@ -0,0 +1,85 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#pragma once
+
+#include "aircraft_store.h"
+#include "owned_data_ref.h"
+
+namespace xpilot
+{
+	constexpr int64_t GOVERNOR_WINDOW = 1000;            // [ms] frames averaged per decision
+	constexpr int GOVERNOR_SHED_WINDOWS = 2;             // consecutive overloaded windows before shedding a level
+	constexpr int GOVERNOR_RESTORE_WINDOWS = 10;         // consecutive windows with headroom before restoring a level
+	constexpr int GOVERNOR_MAX_RESTORE_WINDOWS = 160;    // backoff limit when restoring keeps overloading again
+	constexpr int64_t GOVERNOR_RESTORE_BACKOFF = 60000;  // [ms] shedding this soon after a restore doubles the restore delay
+	constexpr float GOVERNOR_HEADROOM = 0.6f;            // share of the budget traffic has to stay under to restore
+	constexpr float GOVERNOR_MIN_FPS = 25.0f;            // shed below this, ahead of FrameRateMonitor's 20 fps disconnect
+	constexpr float GOVERNOR_CRITICAL_FPS = 20.0f;       // shed every window below this
+	constexpr float GOVERNOR_RESTORE_FPS = 30.0f;
+	constexpr float GOVERNOR_MIN_TRAFFIC_SHARE = 0.1f;   // low frame rates only count if traffic is at least this share of the frame
+	constexpr float GOVERNOR_LABEL_DISTANCE = 1.0f;      // [nm]
+
+	/// Keeps the per-frame cost of network aircraft within Config's traffic frame budget. Averages the frame
+	/// profiler's totals over GOVERNOR_WINDOW and steps the store's TrafficQuality down while traffic is over
+	/// budget or the frame rate approaches the automatic disconnect, and back up once there is headroom.
+	/// Every change is logged and published under xpilot/governor/. Flight loop only.
+	class TrafficGovernor
+	{
+	public:
+		TrafficGovernor();
+		~TrafficGovernor();
+
+		/// Needs the frame profiler, so it has to stay enabled while this returns true
+		bool IsEnabled() const;
+		void Update(float frameRatePeriod);
+
+		TrafficQuality GetQuality() const { return m_quality; }
+		float GetTrafficMilliseconds() const { return m_trafficMs; }
+		float GetFramesPerSecond() const { return m_fps; }
+		const std::string& GetReason() const { return m_reason; }
+
+		static const char* GetName(TrafficQuality quality);
+
+	protected:
+		OwnedDataRef<int> m_levelDataRef;
+		OwnedDataRef<float> m_trafficMsDataRef;
+		OwnedDataRef<float> m_budgetMsDataRef;
+		OwnedDataRef<int> m_culledDataRef;
+		OwnedDataRef<std::string> m_reasonDataRef;
+
+	private:
+		void Evaluate(float budgetMs);
+		void SetQuality(TrafficQuality quality, const std::string& reason);
+		void ApplyLabelDistance();
+
+		TrafficQuality m_quality = TrafficQuality::Full;
+		std::string m_reason;
+		float m_trafficMs = 0.0f;
+		float m_fps = 0.0f;
+		int m_overloadedWindows = 0;
+		int m_headroomWindows = 0;
+		int m_restoreWindows = GOVERNOR_RESTORE_WINDOWS;
+		int64_t m_lastRestore = 0;
+
+		int64_t m_windowStart = 0;
+		int64_t m_windowTrafficUs = 0;
+		double m_windowFrameTime = 0.0; // [s]
+		int m_windowFrames = 0;
+	};
+}
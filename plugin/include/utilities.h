@@ -215,6 +215,21 @@ inline int64_t PrecisionTimestamp()
 	return duration_cast<milliseconds>(dur).count();
 }
 
+inline int64_t PrecisionTimestampMicros()
+{
+	using namespace std::chrono;
+	steady_clock::duration dur{ steady_clock::now().time_since_epoch() };
+	return duration_cast<microseconds>(dur).count();
+}
+
+// wall clock time, used for timestamps that are shared with the client process
+inline int64_t UnixTimestampMillis()
+{
+	using namespace std::chrono;
+	system_clock::duration dur{ system_clock::now().time_since_epoch() };
+	return duration_cast<milliseconds>(dur).count();
+}
+
 inline rgb IntToRgb(int v)
 {
 	rgb result{};
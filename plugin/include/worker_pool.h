@@ -0,0 +1,59 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#pragma once
+
+namespace xpilot
+{
+	/// Small fixed pool for data-parallel work inside a single flight loop callback.
+	/// The calling thread takes part in the work and ParallelFor returns once every range is done.
+	class WorkerPool
+	{
+	public:
+		explicit WorkerPool(size_t threadCount);
+		~WorkerPool();
+
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+		/// Splits [0, count) into chunks of at least minChunk items and runs fn(begin, end) on each
+		void ParallelFor(size_t count, size_t minChunk, const std::function<void(size_t, size_t)>& fn);
+
+		size_t ThreadCount() const { return m_threads.size(); }
+
+		/// Worker count for a pool that leaves the X-Plane main thread and one core for the sim
+		static size_t DefaultThreadCount();
+
+	private:
+		void WorkerLoop();
+		void RunChunks();
+
+		std::vector<std::thread> m_threads;
+		std::mutex m_mutex;
+		std::condition_variable m_workAvailable;
+		std::condition_variable m_workDone;
+		bool m_stopping = false;
+		uint64_t m_generation = 0;
+		size_t m_busyWorkers = 0;
+
+		const std::function<void(size_t, size_t)>* m_job = nullptr;
+		size_t m_jobCount = 0;
+		size_t m_jobChunk = 0;
+		std::atomic<size_t> m_nextIndex{ 0 };
+	};
+}
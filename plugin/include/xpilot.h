@@ -18,8 +18,13 @@
 
 #pragma once
 
+#include "csl_loader.h"
 #include "data_ref_access.h"
 #include "dto.h"
+#include "frame_profiler.h"
+#include "ipc_metrics.h"
+#include "ipc_recording.h"
+#include "outbound_queue.h"
 #include "owned_data_ref.h"
 #include "text_message_console.h"
 #include "utilities.h"
@@ -39,6 +44,10 @@ namespace xpilot
 	class TextMessageConsole;
 	class NearbyAtcWindow;
 	class SettingsWindow;
+	class DebugWindow;
+	class TrafficGovernor;
+	class MainThreadQueue;
+	struct AircraftCommand;
 
 	class XPilot
 	{
@@ -85,9 +94,24 @@ namespace xpilot
 		void ToggleSettingsWindow();
 		void ToggleNearbyAtcWindow();
 		void ToggleTextMessageConsole();
+		void ToggleDebugWindow();
 		void SetNotificationPanelAlwaysVisible(bool visible);
 		bool GetNotificationPanelAlwaysVisible() const;
 
+		const LatencySummary& GetIpcLatencySummary(IpcLatency metric) const { return m_ipcLatencySummaries[static_cast<size_t>(metric)]; }
+		float GetIpcMessageRate(IpcMessageType type) const { return m_ipcMessageRates[static_cast<size_t>(type)]; }
+		float GetIpcMessagesPerSecond() const { return m_ipcMessagesPerSecond; }
+		int GetIpcQueueDepthPeak() const { return m_ipcQueueDepthPeakValue; }
+		int GetIpcOutboundDepthPeak() const { return m_ipcOutboundDepthPeakValue; }
+		bool StartIpcRecording();
+		void StopIpcRecording();
+		bool StartIpcReplay();
+		void StopIpcReplay();
+		const IpcRecording& GetIpcRecording() const { return m_ipcRecording; }
+
+		const TrafficGovernor& GetTrafficGovernor() const { return *m_trafficGovernor; }
+		const LatencySummary& GetFrameProfileSummary(FrameSection section) const { return m_frameProfileSummaries[static_cast<size_t>(section)]; }
+
 	protected:
 		OwnedDataRef<int> m_pttPressed;
 		OwnedDataRef<int> m_networkLoginStatus;
@@ -97,6 +121,7 @@ namespace xpilot
 		OwnedDataRef<float> m_volumeSignalLevel;
 		OwnedDataRef<int> m_aiControlled;
 		OwnedDataRef<int> m_aircraftCount;
+		OwnedDataRef<int> m_frozenAircraftCount;
 		OwnedDataRef<int> m_pluginVersion;
 		OwnedDataRef<std::string> m_selcalCode;
 		OwnedDataRef<int> m_selcalReceived;
@@ -106,6 +131,15 @@ namespace xpilot
 		OwnedDataRef<int> m_com1OnHeadset;
 		OwnedDataRef<int> m_com2OnHeadset;
 		OwnedDataRef<int> m_splitAudioChannels;
+		OwnedDataRef<int> m_ipcMessagesReceived;
+		OwnedDataRef<int> m_ipcSendFailures;
+		OwnedDataRef<int> m_ipcClientSendFailures;
+		OwnedDataRef<float> m_ipcMessagesPerSecond;
+		OwnedDataRef<int> m_ipcQueueDepthPeak;
+		OwnedDataRef<int> m_ipcOutboundDropped;
+		OwnedDataRef<int> m_ipcOutboundDepthPeak;
+		OwnedDataRef<int> m_profilerEnabled;
+		OwnedDataRef<float> m_cslLoadProgress;
 		DataRefAccess<int> m_xplaneAtisEnabled;
 		DataRefAccess<int> m_overrideAutoTune;
 		DataRefAccess<float> m_frameRatePeriod;
@@ -122,28 +156,66 @@ namespace xpilot
 		static float MainFlightLoop(float, float, int, void* ref);
 		bool InitializeXPMP();
 
+		// CSL packages load in the background; aircraft and CSL validation wait for the commit
+		CslLoader m_cslLoader;
+		bool m_cslValidationPending = false; // flight loop only
+		void PollCslLoader();
+		void SendCslValidation();
+
 		bool m_keepSocketAlive = false;
 		nng_socket m_socket;
 		std::unique_ptr<std::thread> m_socketThread;
 
 		void SocketWorker();
+		static void PipeEvent(nng_pipe pipe, nng_pipe_ev event, void* arg);
+		std::atomic<bool> m_pipeChanged{ false }; // set by nng when the client (re)connects or goes away
+		void HandleMessage(const char* buffer, size_t length, bool live);
 		void ProcessPacket(const BaseDto& dto);
+		void QueueFastPositionUpdate(const FastPositionUpdateDto& dto);
+		std::unordered_map<std::string, QuantizedPosition> m_positionBaselines; // socket thread only
 
-		std::mutex m_mutex;
-		std::deque<std::function<void()>> m_queuedCallbacks;
-		void InvokeQueuedCallbacks();
+		// work for the flight loop from the socket worker, see MainThreadQueue for ordering and coalescing
+		std::unique_ptr<MainThreadQueue> m_mainThreadQueue;
 		void QueueCallback(const std::function<void()>& cb);
+		void QueueCommand(AircraftCommand& command);
+		void DispatchCommand(const AircraftCommand& command);
+
+		// messages for the client, see OutboundChannel::Queue for what happens while the client isn't reading
+		std::unique_ptr<OutboundChannel> m_outbound;
+		bool SendOutbound(const OutboundMessage& message); // false if the client can't take it right now
+
+		void PublishIpcMetrics();
+		std::vector<std::unique_ptr<LatencyDataRefs>> m_ipcLatencyDataRefs;
+		std::array<LatencySummary, static_cast<size_t>(IpcLatency::Count)> m_ipcLatencySummaries{};
+		int64_t m_lastIpcMetricsPublish = 0;
+		uint64_t m_ipcLastMessagesReceived = 0;
+		std::array<uint64_t, static_cast<size_t>(IpcMessageType::Count)> m_ipcLastMessageCounts{};
+		std::array<float, static_cast<size_t>(IpcMessageType::Count)> m_ipcMessageRates{};
+		int m_ipcQueueDepthPeakValue = 0;
+		int m_ipcOutboundDepthPeakValue = 0;
+
+		void PublishFrameProfile();
+		std::vector<std::unique_ptr<LatencyDataRefs>> m_frameProfileDataRefs;
+		std::array<LatencySummary, static_cast<size_t>(FrameSection::Count)> m_frameProfileSummaries{};
+		int64_t m_lastFrameProfilePublish = 0;
+
+		IpcRecording m_ipcRecording;
+		bool m_replayReportPending = false; // flight loop only
+		void FinishIpcReplay();
 
 		XPLMDataRef m_bulkDataQuick{}, m_bulkDataExpensive{};
 		static int GetBulkData(void* inRefcon, void* outData, int inStartPos, int inNumBytes);
 
 		std::unique_ptr<FrameRateMonitor> m_frameRateMonitor;
+		std::unique_ptr<TrafficGovernor> m_trafficGovernor;
 		std::unique_ptr<AircraftManager> m_aircraftManager;
 		std::unique_ptr<NotificationPanel> m_notificationPanel;
 		std::unique_ptr<TextMessageConsole> m_textMessageConsole;
 		std::unique_ptr<NearbyAtcWindow> m_nearbyAtcWindow;
 		std::unique_ptr<SettingsWindow> m_settingsWindow;
+		std::unique_ptr<DebugWindow> m_debugWindow;
 
+		/// Packs the message and leaves the send to the socket worker; flight loop only
 		template<class T>
 		void SendDto(const T& dto)
 		{
@@ -153,8 +225,18 @@ namespace xpilot
 				if (dtoBuf.size() == 0)
 					return;
 
-				std::vector<unsigned char> dgBuffer(dtoBuf.data(), dtoBuf.data() + dtoBuf.size());
-				nng_send(m_socket, reinterpret_cast<char*>(dgBuffer.data()), dgBuffer.size(), NNG_FLAG_NONBLOCK);
+				OutboundMessage message;
+				message.Data.assign(dtoBuf.data(), dtoBuf.size());
+				if constexpr (std::is_same_v<T, AircraftAddedDto> || std::is_same_v<T, AircraftDeletedDto>)
+				{
+					message.Policy = OutboundPolicy::Coalesce;
+					message.Key = dto.callsign;
+				}
+				else if constexpr (std::is_same_v<T, RequestMetarDto> || std::is_same_v<T, RequestStationInfoDto>)
+				{
+					message.Policy = OutboundPolicy::Drop;
+				}
+				m_outbound->Queue(std::move(message));
 			}
 		}
 	};
@@ -17,6 +17,7 @@
 */
 
 #include "aircraft_manager.h"
+#include "geo_calc.hpp"
 
 namespace xpilot
 {
@@ -37,11 +38,26 @@ namespace xpilot
 		return mapPlanes.end();
 	}
 
+	constexpr int64_t STALE_AIRCRAFT_TIMEOUT = 30 * 1000; // [ms] without a heartbeat
+	constexpr int64_t STALE_AIRCRAFT_TICK = 1000;         // [ms] expiry resolution
+	constexpr size_t STALE_AIRCRAFT_SLOTS = 64;            // one revolution covers the timeout
+	constexpr int64_t AIRCRAFT_CREATION_BUDGET = 2000;     // [us] per frame, an eighth of 60 fps; at least one aircraft is created
+	constexpr int64_t MODEL_MATCH_TIMEOUT = 5000;          // [ms] after which an aircraft is created without a match
+
 	AircraftManager::AircraftManager(XPilot* instance) :
-		mEnv(instance)
+		m_pendingCount("xpilot/aircraft_creation/pending", ReadOnly),
+		m_burstSize("xpilot/aircraft_creation/burst_size", ReadOnly),
+		m_burstWorstFrame("xpilot/aircraft_creation/burst_worst_frame_ms", ReadOnly),
+		m_userLatitude("sim/flightmodel/position/latitude", ReadOnly),
+		m_userLongitude("sim/flightmodel/position/longitude", ReadOnly),
+		mEnv(instance),
+		m_staleAircraft(STALE_AIRCRAFT_TICK, STALE_AIRCRAFT_SLOTS),
+		m_modelMatcher(std::make_unique<ModelMatcher>())
 	{
 		FlightModel::InitializeModels();
 		ThisThreadIsXplane();
+		m_kinematicsPool = std::make_unique<WorkerPool>(WorkerPool::DefaultThreadCount());
+		AircraftStore::GetInstance().SetWorkerPool(m_kinematicsPool.get());
 		XPLMRegisterFlightLoopCallback(&AircraftManager::AircraftMaintenanceCallback, -1.0f, this);
 		XPMPRegisterPlaneNotifierFunc(&AircraftManager::AircraftNotifierCallback, this);
 	}
@@ -50,6 +66,8 @@ namespace xpilot
 	{
 		XPLMUnregisterFlightLoopCallback(&AircraftManager::AircraftMaintenanceCallback, nullptr);
 		XPMPUnregisterPlaneNotifierFunc(&AircraftManager::AircraftNotifierCallback, nullptr);
+		AircraftStore::GetInstance().SetWorkerPool(nullptr);
+		TerrainCache::GetInstance().Shutdown();
 	}
 
 	void AircraftManager::HandleAddPlane(const std::string& callsign, const AircraftVisualState& visualState,
@@ -61,17 +79,181 @@ namespace xpilot
 			return;
 		}
 
-		NetworkAircraft* plane = new NetworkAircraft(callsign.c_str(), visualState, typeCode.c_str(), airline.c_str(), "", 0, "");
-		mapPlanes.emplace(callsign, std::move(plane));
+		if (PendingAircraft* pending = FindPending(callsign))
+		{
+			pending->VisualState = visualState;
+			if (pending->TypeCode != typeCode || pending->Airline != airline)
+			{
+				pending->TypeCode = typeCode;
+				pending->Airline = airline;
+				QueueModelMatch(*pending);
+			}
+			return;
+		}
+
+		if (!m_burstActive)
+		{
+			m_burstActive = true;
+			m_burstStart = PrecisionTimestamp();
+			m_burstCreated = 0;
+			m_burstWorstFrameValue = 0.0f;
+		}
+
+		PendingAircraft pending;
+		pending.Callsign = callsign;
+		pending.VisualState = visualState;
+		pending.Airline = airline;
+		pending.TypeCode = typeCode;
+		QueueModelMatch(pending);
+		m_pendingAircraft.push_back(std::move(pending));
+		m_pendingCount = static_cast<int>(m_pendingAircraft.size());
+		m_staleAircraft.Arm(callsign, PrecisionTimestamp() + STALE_AIRCRAFT_TIMEOUT);
+	}
+
+	void AircraftManager::QueueModelMatch(PendingAircraft& pending)
+	{
+		pending.Ticket = m_nextTicket++;
+		pending.Model = nullptr;
+		pending.Matched = false;
+		pending.QueuedAt = PrecisionTimestamp();
+		if (m_modelsReady)
+		{
+			m_modelMatcher->Request(pending.Ticket, pending.TypeCode, pending.Airline);
+		}
+	}
+
+	void AircraftManager::SetModelsReady()
+	{
+		m_modelsReady = true;
+		for (auto& pending : m_pendingAircraft)
+		{
+			QueueModelMatch(pending);
+		}
+	}
+
+	void AircraftManager::CreatePendingAircraft()
+	{
+		if (m_pendingAircraft.empty() || !m_modelsReady)
+			return;
+
+		m_matchResults.clear();
+		m_modelMatcher->Collect(m_matchResults);
+		for (const auto& result : m_matchResults)
+		{
+			for (auto& pending : m_pendingAircraft)
+			{
+				if (pending.Ticket == result.Ticket)
+				{
+					pending.Model = result.Model;
+					pending.Matched = true;
+					break;
+				}
+			}
+		}
+
+		// rank by flat distance to the user's aircraft, nearest first; good enough to order a queue
+		const double userLat = m_userLatitude;
+		const double userLon = m_userLongitude;
+		const double lonScale = LongitudeScalingFactor(userLat);
+		const int64_t now = PrecisionTimestamp();
+		for (auto& pending : m_pendingAircraft)
+		{
+			const double dLat = pending.VisualState.Lat - userLat;
+			const double dLon = CalculateNormalizedDelta(userLon, pending.VisualState.Lon, -180.0, 180.0) * lonScale;
+			pending.Distance = dLat * dLat + dLon * dLon;
+			if (!pending.Matched && now - pending.QueuedAt > MODEL_MATCH_TIMEOUT)
+			{
+				pending.Matched = true; // let Create match on its own
+			}
+		}
+		std::sort(m_pendingAircraft.begin(), m_pendingAircraft.end(), [](const PendingAircraft& a, const PendingAircraft& b)
+		{
+			return a.Distance < b.Distance;
+		});
+
+		const int64_t start = PrecisionTimestampMicros();
+		size_t created = 0;
+		for (auto& pending : m_pendingAircraft)
+		{
+			if (!pending.Matched)
+				continue;
+			if (created > 0 && PrecisionTimestampMicros() - start >= AIRCRAFT_CREATION_BUDGET)
+				break;
+
+			NetworkAircraft* plane = new NetworkAircraft(pending.Callsign.c_str(), pending.VisualState, pending.TypeCode.c_str(),
+				pending.Airline.c_str(), "", 0, "", pending.Model);
+			mapPlanes.emplace(pending.Callsign, std::move(plane));
+			for (const auto& config : pending.Configs)
+			{
+				HandleAircraftConfig(pending.Callsign, config);
+			}
+			pending.Ticket = 0; // created
+			created++;
+		}
+
+		m_pendingAircraft.erase(std::remove_if(m_pendingAircraft.begin(), m_pendingAircraft.end(), [](const PendingAircraft& pending)
+		{
+			return pending.Ticket == 0;
+		}), m_pendingAircraft.end());
+		m_pendingCount = static_cast<int>(m_pendingAircraft.size());
+		m_burstCreated += created;
+	}
+
+	void AircraftManager::TrackBurst(float frameTime)
+	{
+		if (!m_burstActive)
+			return;
+
+		// the frame that just ended is the one that created aircraft
+		m_burstWorstFrameValue = std::max(m_burstWorstFrameValue, frameTime * 1000.0f);
+		m_burstWorstFrame = m_burstWorstFrameValue;
+		m_burstSize = static_cast<int>(m_burstCreated);
+
+		if (m_pendingAircraft.empty())
+		{
+			m_burstActive = false;
+			LOG_MSG(logINFO, "Created %zu aircraft in %lld ms, worst frame %.1f ms", m_burstCreated,
+				static_cast<long long>(PrecisionTimestamp() - m_burstStart), m_burstWorstFrameValue);
+		}
+	}
+
+	PendingAircraft* AircraftManager::FindPending(const std::string& callsign)
+	{
+		for (auto& pending : m_pendingAircraft)
+		{
+			if (pending.Callsign == callsign)
+				return &pending;
+		}
+		return nullptr;
+	}
+
+	bool AircraftManager::RemovePending(const std::string& callsign)
+	{
+		const auto it = std::find_if(m_pendingAircraft.begin(), m_pendingAircraft.end(), [&](const PendingAircraft& pending)
+		{
+			return pending.Callsign == callsign;
+		});
+		if (it == m_pendingAircraft.end())
+			return false;
+
+		m_pendingAircraft.erase(it);
+		m_pendingCount = static_cast<int>(m_pendingAircraft.size());
+		return true;
 	}
 
 	void AircraftManager::HandleAircraftConfig(const std::string& callsign, const AircraftConfigDto& config)
 	{
-		auto planeIt = mapPlanes.find(callsign);
-		if (planeIt == mapPlanes.end()) return;
+		NetworkAircraft* plane = GetAircraft(callsign);
+		if (!plane)
+		{
+			if (PendingAircraft* pending = FindPending(callsign))
+			{
+				pending->Configs.push_back(config);
+			}
+			return;
+		}
 
-		NetworkAircraft* plane = planeIt->second.get();
-		if (!plane) return;
+		plane->Thaw();
 
 		if (config.flaps.has_value())
 		{
@@ -154,19 +336,31 @@ namespace xpilot
 
 	void AircraftManager::HandleRemovePlane(const std::string& callsign)
 	{
+		// never created, so the client was never told it was added either
+		if (RemovePending(callsign))
+		{
+			m_staleAircraft.Cancel(callsign);
+			return;
+		}
+
 		auto aircraft = GetAircraft(callsign);
 		if (!aircraft) return;
 
 		mapPlanes.erase(callsign);
+		m_staleAircraft.Cancel(callsign);
 		mEnv->AircraftDeleted(callsign);
 	}
 
 	void AircraftManager::RemoveAllPlanes()
 	{
 		mapPlanes.clear();
+		m_pendingAircraft.clear();
+		m_pendingCount = 0;
+		m_modelMatcher->Clear();
+		m_staleAircraft.Clear();
 	}
 
-	float AircraftManager::AircraftMaintenanceCallback(float, float inElapsedTimeSinceLastFlightLoop, int, void* ref)
+	float AircraftManager::AircraftMaintenanceCallback(float inElapsedSinceLastCall, float, int, void* ref)
 	{
 		auto* instance = static_cast<AircraftManager*>(ref);
 
@@ -177,23 +371,24 @@ namespace xpilot
 				return -1.0f;
 			}
 
+			ScopedFrameTimer timer(FrameSection::Maintenance);
+
+			instance->TrackBurst(inElapsedSinceLastCall);
+			instance->CreatePendingAircraft();
+
 			// The client will take care of any stale aircraft (if the last position packet was more than 15 seconds ago).
 			// If the client doesn't close cleanly for some reason, the aircraft might not get deleted from the sim.
-			std::list<std::string> stalePlanes;
-			for (const auto& plane : mapPlanes)
-			{
-				int64_t timeSinceLastUpdate = PrecisionTimestamp() - plane.second->LastUpdated;
-				if (timeSinceLastUpdate > 30 * 1000)
-				{
-					stalePlanes.push_back(plane.first);
-					LOG_MSG(logINFO, "Removing Stale Aircraft: %s", plane.first.c_str());
-				}
-			}
-
-			for (const auto& plane : stalePlanes)
+			// Heartbeats re-arm each aircraft's deadline, so this only touches aircraft that actually expired.
+			instance->m_expiredAircraft.clear();
+			instance->m_staleAircraft.Advance(PrecisionTimestamp(), instance->m_expiredAircraft);
+			for (const auto& plane : instance->m_expiredAircraft)
 			{
+				LOG_MSG(logINFO, "Removing Stale Aircraft: %s", plane.c_str());
 				mapPlanes.erase(plane);
+				instance->RemovePending(plane);
 			}
+
+			TerrainCache::GetInstance().Sweep();
 		}
 
 		return -1.0f;
@@ -220,28 +415,40 @@ namespace xpilot
 	{
 		auto aircraft = GetAircraft(callsign);
 		if (!aircraft)
+		{
+			if (PendingAircraft* pending = FindPending(callsign))
+			{
+				pending->VisualState = visualState; // spawn where it is now
+			}
 			return;
+		}
 
-		aircraft->PositionalVelocities = positionalVector;
-		aircraft->RotationalVelocities = rotationalVector;
-		aircraft->VisualState = visualState;
+		aircraft->PositionalVelocities() = positionalVector;
+		aircraft->RotationalVelocities() = rotationalVector;
+		aircraft->VisualState() = visualState;
 		aircraft->GroundSpeed = speed;
 		aircraft->UpdateVelocityVectors();
+		aircraft->PositionAppliedAt = PrecisionTimestampMicros();
 	}
 
 	void AircraftManager::HandleHeartbeat(const std::string& callsign)
 	{
 		auto aircraft = GetAircraft(callsign);
 		if (!aircraft)
+		{
+			if (FindPending(callsign))
+			{
+				m_staleAircraft.Arm(callsign, PrecisionTimestamp() + STALE_AIRCRAFT_TIMEOUT);
+			}
 			return;
+		}
 
-		aircraft->LastUpdated = PrecisionTimestamp();
+		aircraft->LastUpdated() = PrecisionTimestamp();
+		m_staleAircraft.Arm(callsign, aircraft->LastUpdated() + STALE_AIRCRAFT_TIMEOUT);
 	}
 
 	NetworkAircraft* AircraftManager::GetAircraft(const std::string& callsign)
 	{
-		auto planeIt = mapPlanes.find(callsign);
-		if (planeIt == mapPlanes.end()) return nullptr;
-		return planeIt->second.get();
+		return AircraftStore::GetInstance().FindAircraft(callsign);
 	}
 }
@@ -0,0 +1,478 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "abacus.hpp"
+#include "aircraft_store.h"
+#include "frame_profiler.h"
+#include "geo_calc.hpp"
+#include "network_aircraft.h"
+#include "utilities.h"
+#include "worker_pool.h"
+
+namespace xpilot
+{
+	constexpr size_t MIN_BUCKET_COUNT = 64;
+	constexpr size_t KINEMATICS_MIN_CHUNK = 64; // aircraft per worker task
+	constexpr int64_t ROTATIONAL_VELOCITY_TIMEOUT = 500; // [ms] without a fast position update
+
+	AircraftStore& AircraftStore::GetInstance()
+	{
+		static AircraftStore store;
+		return store;
+	}
+
+	AircraftHandle AircraftStore::Allocate(const std::string& callsign, NetworkAircraft* owner)
+	{
+		if ((m_activeCount + 1) * 4 > m_buckets.size() * 3)
+		{
+			Rehash((std::max)(m_buckets.size() * 2, MIN_BUCKET_COUNT));
+		}
+
+		uint32_t slot;
+		if (!m_freeSlots.empty())
+		{
+			slot = m_freeSlots.back();
+			m_freeSlots.pop_back();
+		}
+		else
+		{
+			slot = static_cast<uint32_t>(m_active.size());
+			VisualState.emplace_back();
+			PredictedVisualState.emplace_back();
+			PositionalVelocities.emplace_back();
+			PositionalErrorVelocities.emplace_back();
+			RotationalVelocities.emplace_back();
+			RotationalErrorVelocities.emplace_back();
+			ApplyErrorVelocitiesUntil.emplace_back();
+			LastVelocityUpdate.emplace_back();
+			LastUpdated.emplace_back();
+			FirstRenderPending.emplace_back();
+			RenderedAttitude.emplace_back();
+			Anchor.emplace_back();
+			AnchorOffset.emplace_back();
+			Frozen.emplace_back();
+			LodTier.emplace_back();
+			Culled.emplace_back();
+			m_callsigns.emplace_back();
+			m_hashes.emplace_back();
+			m_owners.emplace_back();
+			m_generations.emplace_back();
+			m_active.emplace_back();
+		}
+
+		VisualState[slot] = {};
+		PredictedVisualState[slot] = {};
+		PositionalVelocities[slot] = Vector3::Zero();
+		PositionalErrorVelocities[slot] = Vector3::Zero();
+		RotationalVelocities[slot] = Vector3::Zero();
+		RotationalErrorVelocities[slot] = Vector3::Zero();
+		ApplyErrorVelocitiesUntil[slot] = 0;
+		LastVelocityUpdate[slot] = 0;
+		LastUpdated[slot] = 0;
+		FirstRenderPending[slot] = 1;
+		RenderedAttitude[slot] = Vector3::Zero();
+		Anchor[slot] = {};
+		AnchorOffset[slot] = Vector3::Zero();
+		Frozen[slot] = 0;
+		LodTier[slot] = AircraftLodTier::Near;
+		Culled[slot] = 0;
+		m_callsigns[slot] = callsign;
+		m_hashes[slot] = std::hash<std::string_view>{}(callsign);
+		m_owners[slot] = owner;
+		m_active[slot] = 1;
+		m_activeCount++;
+		InsertBucket(slot);
+
+		return { slot, m_generations[slot] };
+	}
+
+	void AircraftStore::Release(AircraftHandle handle)
+	{
+		if (!IsCurrent(handle))
+			return;
+
+		const size_t bucket = FindBucket(m_callsigns[handle.Slot], m_hashes[handle.Slot]);
+		if (bucket != SIZE_MAX && m_buckets[bucket] == handle.Slot)
+		{
+			EraseBucket(bucket);
+		}
+
+		Thaw(handle.Slot);
+		SetCulled(handle.Slot, false);
+		m_callsigns[handle.Slot].clear();
+		m_owners[handle.Slot] = nullptr;
+		m_active[handle.Slot] = 0;
+		m_generations[handle.Slot]++;
+		m_freeSlots.push_back(handle.Slot);
+		m_activeCount--;
+	}
+
+	AircraftHandle AircraftStore::Find(std::string_view callsign) const
+	{
+		const size_t bucket = FindBucket(callsign, std::hash<std::string_view>{}(callsign));
+		if (bucket == SIZE_MAX)
+			return {};
+
+		const uint32_t slot = m_buckets[bucket];
+		return { slot, m_generations[slot] };
+	}
+
+	NetworkAircraft* AircraftStore::FindAircraft(std::string_view callsign) const
+	{
+		const AircraftHandle handle = Find(callsign);
+		return handle.IsValid() ? m_owners[handle.Slot] : nullptr;
+	}
+
+	bool AircraftStore::IsCurrent(AircraftHandle handle) const
+	{
+		return handle.IsValid()
+			&& handle.Slot < m_active.size()
+			&& m_active[handle.Slot]
+			&& m_generations[handle.Slot] == handle.Generation;
+	}
+
+	void AircraftStore::PrepareFrame(int frameCounter, double interval)
+	{
+		if (frameCounter == m_lastFrameCounter)
+			return;
+		m_lastFrameCounter = frameCounter;
+		ScopedFrameTimer timer(FrameSection::Kinematics);
+		RefreshFrameSettings();
+		CheckLocalFrame();
+
+		const int64_t now = PrecisionTimestamp();
+		if (m_workerPool)
+		{
+			m_workerPool->ParallelFor(SlotCount(), KINEMATICS_MIN_CHUNK, [&](size_t begin, size_t end)
+			{
+				ExtrapolateRange(begin, end, interval, now);
+			});
+		}
+		else
+		{
+			ExtrapolateRange(0, SlotCount(), interval, now);
+		}
+	}
+
+	void AircraftStore::Freeze(size_t slot)
+	{
+		if (!Frozen[slot])
+		{
+			Frozen[slot] = 1;
+			m_frozenCount++;
+		}
+	}
+
+	void AircraftStore::Thaw(size_t slot)
+	{
+		if (Frozen[slot])
+		{
+			Frozen[slot] = 0;
+			m_frozenCount--;
+		}
+	}
+
+	void AircraftStore::ThawAll()
+	{
+		std::fill(Frozen.begin(), Frozen.end(), 0);
+		m_frozenCount = 0;
+	}
+
+	std::array<size_t, static_cast<size_t>(AircraftLodTier::Count)> AircraftStore::GetLodTierCounts() const
+	{
+		std::array<size_t, static_cast<size_t>(AircraftLodTier::Count)> counts{};
+		for (size_t i = 0; i < m_active.size(); i++)
+		{
+			if (m_active[i] && !Frozen[i])
+			{
+				counts[static_cast<size_t>(LodTier[i])]++;
+			}
+		}
+		return counts;
+	}
+
+	size_t AircraftStore::CullBeyondNearest(size_t limit)
+	{
+		m_cullOrder.clear();
+		for (size_t i = 0; i < m_active.size(); i++)
+		{
+			if (m_active[i])
+			{
+				m_cullOrder.emplace_back(m_owners[i]->GetCameraDist(), static_cast<uint32_t>(i));
+			}
+		}
+
+		if (m_cullOrder.size() > limit)
+		{
+			std::nth_element(m_cullOrder.begin(), m_cullOrder.begin() + limit, m_cullOrder.end());
+		}
+
+		for (size_t i = 0; i < m_cullOrder.size(); i++)
+		{
+			SetCulled(m_cullOrder[i].second, i >= limit);
+		}
+		return m_culledCount;
+	}
+
+	void AircraftStore::ClearCulled()
+	{
+		for (size_t i = 0; i < Culled.size(); i++)
+		{
+			SetCulled(i, false);
+		}
+	}
+
+	void AircraftStore::SetCulled(size_t slot, bool culled)
+	{
+		if (IsCulled(slot) == culled)
+			return;
+
+		Culled[slot] = culled ? 1 : 0;
+		if (culled)
+			m_culledCount++;
+		else
+			m_culledCount--;
+		Thaw(slot); // frozen aircraft only pick up the change once they run UpdatePosition again
+	}
+
+	void AircraftStore::RefreshFrameSettings()
+	{
+		const Config& config = Config::GetInstance();
+
+		AircraftFrameSettings settings;
+		settings.LabelType = config.GetAircraftLabelType();
+		settings.LabelColor = config.GetAircraftLabelColor();
+		settings.LodNearDistance = static_cast<float>(config.GetLodNearDistance() * METERS_PER_NM);
+		settings.LodFarDistance = static_cast<float>(config.GetLodFarDistance() * METERS_PER_NM);
+		settings.LabelRevision = m_frameSettings.LabelRevision;
+
+		const bool reducedUpdates = m_trafficQuality >= TrafficQuality::ReducedFarUpdates;
+		settings.MidFrameInterval = reducedUpdates ? LOD_MID_FRAME_INTERVAL * LOD_REDUCED_RATE_FACTOR : LOD_MID_FRAME_INTERVAL;
+		settings.FarFrameInterval = reducedUpdates ? LOD_FAR_FRAME_INTERVAL * LOD_REDUCED_RATE_FACTOR : LOD_FAR_FRAME_INTERVAL;
+		settings.TerrainIntervalScale = m_trafficQuality >= TrafficQuality::ReducedTerrainProbes ? LOD_REDUCED_RATE_FACTOR : 1;
+		settings.MuteDistantSounds = m_trafficQuality >= TrafficQuality::ReducedLabelsAndSounds;
+
+		if (settings.LabelType != m_frameSettings.LabelType || settings.LabelColor != m_frameSettings.LabelColor)
+		{
+			settings.LabelRevision++;
+		}
+		m_frameSettings = settings;
+	}
+
+	void AircraftStore::CheckLocalFrame()
+	{
+		if (!m_latRef || !m_lonRef)
+		{
+			m_latRef = XPLMFindDataRef("sim/flightmodel/position/lat_ref");
+			m_lonRef = XPLMFindDataRef("sim/flightmodel/position/lon_ref");
+			if (!m_latRef || !m_lonRef)
+				return;
+		}
+
+		const float latRefValue = XPLMGetDataf(m_latRef);
+		const float lonRefValue = XPLMGetDataf(m_lonRef);
+		uint32_t latRef, lonRef;
+		std::memcpy(&latRef, &latRefValue, sizeof(latRef));
+		std::memcpy(&lonRef, &lonRefValue, sizeof(lonRef));
+		if (latRef != m_lastLatRef || lonRef != m_lastLonRef)
+		{
+			m_lastLatRef = latRef;
+			m_lastLonRef = lonRef;
+			m_localFrameGeneration++;
+			ThawAll(); // frozen aircraft have to be placed in the new frame
+		}
+	}
+
+	namespace
+	{
+		constexpr size_t KINEMATICS_BLOCK_SIZE = 64;
+
+		/// Scratch arrays for one block of aircraft, laid out for the batch kernels in abacus.hpp
+		struct KinematicsBlock
+		{
+			size_t Count = 0;
+			size_t Slots[KINEMATICS_BLOCK_SIZE];
+			Vector3 Velocity[KINEMATICS_BLOCK_SIZE];
+			int RotationLane[KINEMATICS_BLOCK_SIZE];
+
+			size_t Rotating = 0;
+			double Heading[KINEMATICS_BLOCK_SIZE], Pitch[KINEMATICS_BLOCK_SIZE], Bank[KINEMATICS_BLOCK_SIZE];
+			double DeltaYaw[KINEMATICS_BLOCK_SIZE], DeltaPitch[KINEMATICS_BLOCK_SIZE], DeltaRoll[KINEMATICS_BLOCK_SIZE];
+			double SlerpT[KINEMATICS_BLOCK_SIZE];
+			double QI[4][KINEMATICS_BLOCK_SIZE], QJ[4][KINEMATICS_BLOCK_SIZE], QK[4][KINEMATICS_BLOCK_SIZE], QU[4][KINEMATICS_BLOCK_SIZE];
+
+			QuaternionSpan Quaternions(size_t n) { return { QI[n], QJ[n], QK[n], QU[n] }; }
+		};
+	}
+
+	void AircraftStore::ExtrapolateRange(size_t begin, size_t end, double interval, int64_t now)
+	{
+		KinematicsBlock block;
+		const QuaternionSpan current = block.Quaternions(0);
+		const QuaternionSpan delta = block.Quaternions(1);
+		const QuaternionSpan identity = block.Quaternions(2);
+		const QuaternionSpan rotated = block.Quaternions(3);
+		std::fill(identity.I, identity.I + KINEMATICS_BLOCK_SIZE, 0.0);
+		std::fill(identity.J, identity.J + KINEMATICS_BLOCK_SIZE, 0.0);
+		std::fill(identity.K, identity.K + KINEMATICS_BLOCK_SIZE, 0.0);
+		std::fill(identity.U, identity.U + KINEMATICS_BLOCK_SIZE, 1.0);
+		const double slerpT = interval > 1.0 ? 1.0 : interval;
+
+		for (size_t blockBegin = begin; blockBegin < end; blockBegin += KINEMATICS_BLOCK_SIZE)
+		{
+			const size_t blockEnd = (std::min)(blockBegin + KINEMATICS_BLOCK_SIZE, end);
+			block.Count = 0;
+			block.Rotating = 0;
+
+			for (size_t i = blockBegin; i < blockEnd; i++)
+			{
+				if (!m_active[i] || FirstRenderPending[i] || Frozen[i])
+					continue;
+
+				AircraftVisualState& predicted = PredictedVisualState[i];
+				const AircraftVisualState& visual = VisualState[i];
+
+				if (now - LastVelocityUpdate[i] > ROTATIONAL_VELOCITY_TIMEOUT)
+				{
+					RotationalVelocities[i] = Vector3::Zero();
+					RotationalErrorVelocities[i] = Vector3::Zero();
+					predicted.Pitch = visual.Pitch;
+					predicted.Bank = visual.Bank;
+					predicted.Heading = visual.Heading;
+				}
+
+				Vector3 velocity = PositionalVelocities[i];
+				Vector3 rotation = RotationalVelocities[i];
+				if (now <= ApplyErrorVelocitiesUntil[i])
+				{
+					velocity += PositionalErrorVelocities[i];
+					rotation += RotationalErrorVelocities[i];
+				}
+
+				const size_t n = block.Count++;
+				block.Slots[n] = i;
+				block.Velocity[n] = velocity;
+				block.RotationLane[n] = -1;
+
+				if (rotation != Vector3::Zero())
+				{
+					const size_t r = block.Rotating++;
+					block.RotationLane[n] = static_cast<int>(r);
+					block.Heading[r] = DegreesToRadians(predicted.Heading);
+					block.Pitch[r] = DegreesToRadians(predicted.Pitch);
+					block.Bank[r] = DegreesToRadians(predicted.Bank);
+					block.DeltaYaw[r] = rotation.Y;
+					block.DeltaPitch[r] = rotation.X;
+					block.DeltaRoll[r] = rotation.Z;
+					block.SlerpT[r] = slerpT;
+				}
+			}
+
+			// current * slerp(identity, delta, t), reusing the input arrays for the Euler output
+			CreateFromEulerBatch(block.Heading, block.Pitch, block.Bank, current, block.Rotating);
+			CreateFromEulerBatch(block.DeltaYaw, block.DeltaPitch, block.DeltaRoll, delta, block.Rotating);
+			SlerpBatch(identity, delta, block.SlerpT, rotated, block.Rotating);
+			MultiplyBatch(current, rotated, delta, block.Rotating);
+			ExtractEulerAnglesBatch(delta, block.Pitch, block.Heading, block.Bank, block.Rotating);
+
+			for (size_t n = 0; n < block.Count; n++)
+			{
+				const size_t i = block.Slots[n];
+				const LocalFrameAnchor& anchor = Anchor[i];
+				Vector3& offset = AnchorOffset[i];
+				offset += block.Velocity[n] * interval;
+
+				// linear in the anchor's tangent plane; lat/lon are only kept for terrain and error vectors
+				AircraftVisualState next{};
+				next.Lat = NormalizeDegrees(anchor.Lat + MetersToDegrees(offset.Z), -90.0, 90.0);
+				next.Lon = NormalizeDegrees(anchor.Lon + MetersToDegrees(offset.X / anchor.LonScale), -180.0, 180.0);
+				next.AltitudeTrue = anchor.AltitudeTrue + offset.Y * 3.28084;
+
+				const int r = block.RotationLane[n];
+				if (r < 0)
+				{
+					next.Pitch = RenderedAttitude[i].X;
+					next.Heading = RenderedAttitude[i].Y;
+					next.Bank = RenderedAttitude[i].Z;
+				}
+				else
+				{
+					next.Pitch = RadiansToDegrees(block.Pitch[r]);
+					next.Heading = RadiansToDegrees(block.Heading[r]);
+					next.Bank = RadiansToDegrees(block.Bank[r]);
+				}
+
+				PredictedVisualState[i] = next;
+			}
+		}
+	}
+
+	size_t AircraftStore::FindBucket(std::string_view callsign, size_t hash) const
+	{
+		if (m_buckets.empty())
+			return SIZE_MAX;
+
+		for (size_t i = hash & BucketMask();; i = (i + 1) & BucketMask())
+		{
+			const uint32_t slot = m_buckets[i];
+			if (slot == EmptyBucket)
+				return SIZE_MAX;
+			if (m_hashes[slot] == hash && m_callsigns[slot] == callsign)
+				return i;
+		}
+	}
+
+	void AircraftStore::InsertBucket(uint32_t slot)
+	{
+		size_t i = m_hashes[slot] & BucketMask();
+		while (m_buckets[i] != EmptyBucket)
+		{
+			i = (i + 1) & BucketMask();
+		}
+		m_buckets[i] = slot;
+	}
+
+	void AircraftStore::EraseBucket(size_t bucket)
+	{
+		// shift following entries of the probe chain back so lookups never need tombstones
+		size_t hole = bucket;
+		for (size_t i = (hole + 1) & BucketMask(); m_buckets[i] != EmptyBucket; i = (i + 1) & BucketMask())
+		{
+			const size_t home = m_hashes[m_buckets[i]] & BucketMask();
+			const bool movable = hole <= i ? (home <= hole || home > i) : (home <= hole && home > i);
+			if (movable)
+			{
+				m_buckets[hole] = m_buckets[i];
+				hole = i;
+			}
+		}
+		m_buckets[hole] = EmptyBucket;
+	}
+
+	void AircraftStore::Rehash(size_t bucketCount)
+	{
+		m_buckets.assign(bucketCount, EmptyBucket);
+		for (uint32_t slot = 0; slot < m_active.size(); slot++)
+		{
+			if (m_active[slot])
+			{
+				InsertBucket(slot);
+			}
+		}
+	}
+}
@@ -137,6 +137,26 @@ namespace xpilot
 			{
 				SetLabelCutoffVis(jf["LabelCutoffVis"]);
 			}
+			if (jf.contains("LodNearDist"))
+			{
+				SetLodNearDistance(std::max(1, std::min(jf.at("LodNearDist").get<int>(), 20)));
+			}
+			if (jf.contains("LodFarDist"))
+			{
+				SetLodFarDistance(std::max(GetLodNearDistance() + 1, std::min(jf.at("LodFarDist").get<int>(), 40)));
+			}
+			if (jf.contains("TrafficFrameBudget"))
+			{
+				SetTrafficFrameBudget(std::max(0, std::min(jf.at("TrafficFrameBudget").get<int>(), 20)));
+			}
+			if (jf.contains("GovernorAircraftLimit"))
+			{
+				SetGovernorAircraftLimit(std::max(10, std::min(jf.at("GovernorAircraftLimit").get<int>(), 200)));
+			}
+			if (jf.contains("ConsoleHistoryLimit"))
+			{
+				SetConsoleHistoryLimit(std::max(100, std::min(jf.at("ConsoleHistoryLimit").get<int>(), 2000)));
+			}
 			if (jf.contains("LogLevel"))
 			{
 				SetLogLevel(jf["LogLevel"]);
@@ -224,6 +244,11 @@ namespace xpilot
 		j["DisableTcas"] = GetTcasDisabled();
 		j["MaxLabelDist"] = GetMaxLabelDistance();
 		j["LabelCutoffVis"] = GetLabelCutoffVis();
+		j["LodNearDist"] = GetLodNearDistance();
+		j["LodFarDist"] = GetLodFarDistance();
+		j["TrafficFrameBudget"] = GetTrafficFrameBudget();
+		j["GovernorAircraftLimit"] = GetGovernorAircraftLimit();
+		j["ConsoleHistoryLimit"] = GetConsoleHistoryLimit();
 		j["LogLevel"] = GetLogLevel();
 		j["EnableTransmitIndicator"] = GetTransmitIndicatorEnabled();
 		j["EnableAircraftSounds"] = GetAircraftSoundsEnabled();
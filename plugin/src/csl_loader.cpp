@@ -0,0 +1,90 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "csl_loader.h"
+#include "utilities.h"
+
+namespace xpilot
+{
+	CslLoader::~CslLoader()
+	{
+		m_cancel = true;
+		if (m_thread.joinable())
+		{
+			m_thread.join();
+		}
+	}
+
+	void CslLoader::Start(std::vector<std::string> packagePaths)
+	{
+		m_packagePaths = std::move(packagePaths);
+		m_startedAt = PrecisionTimestampMicros();
+		m_thread = std::thread(&CslLoader::WorkerLoop, this);
+	}
+
+	int CslLoader::Commit()
+	{
+		const int64_t indexStart = PrecisionTimestampMicros();
+		const int added = XPMPCommitStagedCSLPackages();
+		const int64_t end = PrecisionTimestampMicros();
+
+		LOG_MSG(logMSG, "Loaded %d CSL models from %d xsb_aircraft.txt files in %.0f ms (scan %.0f ms, parse %.0f ms, index %.1f ms)",
+			added, m_packageFiles, (end - m_startedAt) / 1000.0, m_scanMs, m_parseMs, (end - indexStart) / 1000.0);
+		if (added < m_modelsRead)
+		{
+			LOG_MSG(logINFO, "Skipped %d duplicate CSL models", m_modelsRead - added);
+		}
+		return added;
+	}
+
+	void CslLoader::WorkerLoop()
+	{
+		for (m_currentPackage = 0; m_currentPackage < m_packagePaths.size() && !m_cancel; m_currentPackage++)
+		{
+			const std::string& path = m_packagePaths[m_currentPackage];
+			XPMPCSLLoadStats_t stats;
+			try
+			{
+				const char* err = XPMPStageCSLPackage(path.c_str(), &stats, &CslLoader::OnProgress, this);
+				if (*err)
+				{
+					LOG_MSG(logERROR, "Error loading CSL package %s: %s", path.c_str(), err);
+				}
+			}
+			catch (std::exception& e)
+			{
+				LOG_MSG(logERROR, "Error loading CSL package %s: %s", path.c_str(), e.what());
+			}
+			m_packageFiles += stats.numPkgFiles;
+			m_modelsRead += stats.numModels;
+			m_scanMs += stats.scanMs;
+			m_parseMs += stats.parseMs;
+			m_progress = static_cast<float>(m_currentPackage + 1) / m_packagePaths.size();
+		}
+		m_progress = 1.0f;
+		m_finished = true;
+	}
+
+	bool CslLoader::OnProgress(int filesDone, int filesTotal, void* ref)
+	{
+		auto* instance = static_cast<CslLoader*>(ref);
+		const float packageShare = filesTotal > 0 ? static_cast<float>(filesDone) / filesTotal : 1.0f;
+		instance->m_progress = (instance->m_currentPackage + packageShare) / instance->m_packagePaths.size();
+		return !instance->m_cancel;
+	}
+}
@@ -0,0 +1,215 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "aircraft_store.h"
+#include "debug_window.h"
+#include "traffic_governor.h"
+#include "xpilot.h"
+
+namespace xpilot
+{
+	DebugWindow::DebugWindow(XPilot* instance) :
+		XPImgWindow(WND_MODE_FLOAT_CENTERED, WND_STYLE_SOLID, WndRect(0, 300, 560, 0)),
+		m_env(instance)
+	{
+		SetWindowTitle("xPilot Diagnostics");
+		SetWindowResizingLimits(560, 300, 1024, 1024);
+	}
+
+	void DebugWindow::buildInterface()
+	{
+		RenderIpcStatistics();
+		RenderAircraftStatistics();
+		RenderFrameProfile();
+		RenderIpcRecording();
+	}
+
+	void DebugWindow::RenderIpcRecording()
+	{
+		if (!ImGui::CollapsingHeader("Traffic Recording"))
+			return;
+
+		const IpcRecording& recording = m_env->GetIpcRecording();
+		if (recording.IsRecording())
+		{
+			ImGui::Text("Recording: %zu messages", recording.GetMessageCount());
+			if (ImGui::Button("Stop Recording"))
+			{
+				m_env->StopIpcRecording();
+			}
+		}
+		else if (recording.IsReplaying())
+		{
+			ImGui::Text("Replaying: %zu of %zu messages", recording.GetMessageCount(), recording.GetReplayLength());
+			if (ImGui::Button("Stop Replay"))
+			{
+				m_env->StopIpcReplay();
+			}
+		}
+		else
+		{
+			if (ImGui::Button("Record Traffic"))
+			{
+				m_env->StartIpcRecording();
+			}
+			ImGui::SameLine();
+			if (ImGui::Button("Replay Recording"))
+			{
+				m_env->StartIpcReplay();
+			}
+		}
+		ImGui::TextWrapped("Records the aircraft traffic sent by the client to Resources/ipc_recording.bin. "
+			"A replay runs while disconnected; the frame profile then covers the whole replay and is written to the log when it ends.");
+	}
+
+	void DebugWindow::RenderFrameProfile()
+	{
+		if (!ImGui::CollapsingHeader("Frame Profile", ImGuiTreeNodeFlags_DefaultOpen))
+			return;
+
+		if (ImGui::BeginTable("#frameprofile", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders))
+		{
+			ImGui::TableSetupColumn("Section", ImGuiTableColumnFlags_WidthStretch);
+			ImGui::TableSetupColumn("p50 us", ImGuiTableColumnFlags_WidthFixed, 60);
+			ImGui::TableSetupColumn("p95 us", ImGuiTableColumnFlags_WidthFixed, 60);
+			ImGui::TableSetupColumn("p99 us", ImGuiTableColumnFlags_WidthFixed, 60);
+			ImGui::TableSetupColumn("max us", ImGuiTableColumnFlags_WidthFixed, 60);
+			ImGui::TableHeadersRow();
+
+			for (size_t i = 0; i < static_cast<size_t>(FrameSection::Count); i++)
+			{
+				const auto section = static_cast<FrameSection>(i);
+				const LatencySummary& summary = m_env->GetFrameProfileSummary(section);
+
+				ImGui::TableNextRow();
+				ImGui::TableSetColumnIndex(0);
+				ImGui::TextUnformatted(FrameProfiler::GetName(section));
+				ImGui::TableSetColumnIndex(1);
+				ImGui::Text("%.0f", summary.P50 * 1000.0f);
+				ImGui::TableSetColumnIndex(2);
+				ImGui::Text("%.0f", summary.P95 * 1000.0f);
+				ImGui::TableSetColumnIndex(3);
+				ImGui::Text("%.0f", summary.P99 * 1000.0f);
+				ImGui::TableSetColumnIndex(4);
+				ImGui::Text("%.0f", summary.Max * 1000.0f);
+			}
+			ImGui::EndTable();
+		}
+		ImGui::TextDisabled("Time per frame, with %zu aircraft. Kinematics is part of UpdatePosition.", AircraftStore::GetInstance().ActiveCount());
+	}
+
+	void DebugWindow::RenderAircraftStatistics()
+	{
+		if (!ImGui::CollapsingHeader("Aircraft", ImGuiTreeNodeFlags_DefaultOpen))
+			return;
+
+		const AircraftStore& store = AircraftStore::GetInstance();
+		const auto tiers = store.GetLodTierCounts();
+		ImGui::Text("Active: %zu, frozen: %zu", store.ActiveCount(), store.FrozenCount());
+		ImGui::Text("Near: %zu, mid: %zu, far: %zu",
+			tiers[static_cast<size_t>(AircraftLodTier::Near)],
+			tiers[static_cast<size_t>(AircraftLodTier::Mid)],
+			tiers[static_cast<size_t>(AircraftLodTier::Far)]);
+
+		const TrafficGovernor& governor = m_env->GetTrafficGovernor();
+		if (!governor.IsEnabled())
+		{
+			ImGui::TextDisabled("Traffic governor: off");
+			return;
+		}
+		ImGui::Text("Traffic governor: %s, %.1f ms per frame at %.0f fps, not drawn: %zu",
+			TrafficGovernor::GetName(governor.GetQuality()), governor.GetTrafficMilliseconds(), governor.GetFramesPerSecond(), store.CulledCount());
+		if (!governor.GetReason().empty())
+		{
+			ImGui::TextDisabled("Last change: %s", governor.GetReason().c_str());
+		}
+	}
+
+	void DebugWindow::RenderIpcStatistics()
+	{
+		if (!ImGui::CollapsingHeader("IPC Latency", ImGuiTreeNodeFlags_DefaultOpen))
+			return;
+
+		if (ImGui::BeginTable("#ipclatency", 6, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders))
+		{
+			ImGui::TableSetupColumn("Stage", ImGuiTableColumnFlags_WidthStretch);
+			ImGui::TableSetupColumn("Samples", ImGuiTableColumnFlags_WidthFixed, 60);
+			ImGui::TableSetupColumn("p50 ms", ImGuiTableColumnFlags_WidthFixed, 60);
+			ImGui::TableSetupColumn("p95 ms", ImGuiTableColumnFlags_WidthFixed, 60);
+			ImGui::TableSetupColumn("p99 ms", ImGuiTableColumnFlags_WidthFixed, 60);
+			ImGui::TableSetupColumn("max ms", ImGuiTableColumnFlags_WidthFixed, 60);
+			ImGui::TableHeadersRow();
+
+			for (size_t i = 0; i < static_cast<size_t>(IpcLatency::Count); i++)
+			{
+				const auto metric = static_cast<IpcLatency>(i);
+				const LatencySummary& summary = m_env->GetIpcLatencySummary(metric);
+
+				ImGui::TableNextRow();
+				ImGui::TableSetColumnIndex(0);
+				ImGui::TextUnformatted(IpcMetrics::GetName(metric));
+				ImGui::TableSetColumnIndex(1);
+				ImGui::Text("%llu", static_cast<unsigned long long>(summary.Count));
+				ImGui::TableSetColumnIndex(2);
+				ImGui::Text("%.2f", summary.P50);
+				ImGui::TableSetColumnIndex(3);
+				ImGui::Text("%.2f", summary.P95);
+				ImGui::TableSetColumnIndex(4);
+				ImGui::Text("%.2f", summary.P99);
+				ImGui::TableSetColumnIndex(5);
+				ImGui::Text("%.2f", summary.Max);
+			}
+			ImGui::EndTable();
+		}
+
+		const IpcMetrics& metrics = IpcMetrics::GetInstance();
+		ImGui::Text("Messages received: %llu (%.1f/s)", static_cast<unsigned long long>(metrics.MessagesReceived.load()), m_env->GetIpcMessagesPerSecond());
+		ImGui::Text("Command queue: %zu now, %d peak", metrics.QueueDepth.load(), m_env->GetIpcQueueDepthPeak());
+		ImGui::Text("Dropped (plugin -> client): %llu", static_cast<unsigned long long>(metrics.SendFailures.load()));
+		ImGui::Text("Dropped (client -> plugin): %llu", static_cast<unsigned long long>(metrics.ClientSendFailures.load()));
+		ImGui::Text("Delta frames without keyframe: %llu", static_cast<unsigned long long>(metrics.DeltaFramesDiscarded.load()));
+		ImGui::Text("Superseded positions/heartbeats: %llu", static_cast<unsigned long long>(metrics.CoalescedCommands.load()));
+		ImGui::Text("Command queue full, dropped/spilled: %llu/%llu", static_cast<unsigned long long>(metrics.QueueFullDropped.load()),
+			static_cast<unsigned long long>(metrics.QueueFullSpilled.load()));
+		ImGui::Text("Outbound queue: %d peak, %llu dropped, %llu coalesced", m_env->GetIpcOutboundDepthPeak(),
+			static_cast<unsigned long long>(metrics.OutboundDropped.load()), static_cast<unsigned long long>(metrics.OutboundCoalesced.load()));
+		ImGui::TextDisabled("Percentiles, rates and peaks cover the last %d seconds.", IPC_METRICS_WINDOW_SECONDS);
+
+		if (ImGui::BeginTable("#ipcrates", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders))
+		{
+			ImGui::TableSetupColumn("Message", ImGuiTableColumnFlags_WidthStretch);
+			ImGui::TableSetupColumn("Total", ImGuiTableColumnFlags_WidthFixed, 90);
+			ImGui::TableSetupColumn("Per second", ImGuiTableColumnFlags_WidthFixed, 90);
+			ImGui::TableHeadersRow();
+
+			for (size_t i = 0; i < static_cast<size_t>(IpcMessageType::Count); i++)
+			{
+				const auto type = static_cast<IpcMessageType>(i);
+
+				ImGui::TableNextRow();
+				ImGui::TableSetColumnIndex(0);
+				ImGui::TextUnformatted(IpcMetrics::GetName(type));
+				ImGui::TableSetColumnIndex(1);
+				ImGui::Text("%llu", static_cast<unsigned long long>(metrics.GetMessageCount(type)));
+				ImGui::TableSetColumnIndex(2);
+				ImGui::Text("%.1f", m_env->GetIpcMessageRate(type));
+			}
+			ImGui::EndTable();
+		}
+	}
+}
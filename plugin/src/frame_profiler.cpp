@@ -0,0 +1,110 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "frame_profiler.h"
+
+namespace xpilot
+{
+	FrameProfiler& FrameProfiler::GetInstance()
+	{
+		static FrameProfiler profiler;
+		return profiler;
+	}
+
+	void FrameProfiler::SetEnabled(bool enabled)
+	{
+		if (enabled == m_enabled)
+			return;
+
+		m_enabled = enabled;
+		XPMPSetProfileCallback(enabled ? &FrameProfiler::XpmpProfileCallback : nullptr, this);
+	}
+
+	void FrameProfiler::Record(FrameSection section, int64_t micros)
+	{
+		m_histograms[static_cast<size_t>(section)].Record(micros);
+		if (section != FrameSection::Kinematics)
+		{
+			m_frameTotal += micros;
+		}
+	}
+
+	int64_t FrameProfiler::TakeFrameTotal()
+	{
+		const int64_t total = m_frameTotal;
+		m_frameTotal = 0;
+		return total;
+	}
+
+	void FrameProfiler::XpmpProfileCallback(XPMPProfileSection section, double micros, void* ref)
+	{
+		auto* profiler = static_cast<FrameProfiler*>(ref);
+		if (!profiler)
+			return;
+
+		FrameSection frameSection;
+		switch (section)
+		{
+			case XPMP_PROFILE_UPDATE_POSITION: frameSection = FrameSection::UpdatePosition; break;
+			case XPMP_PROFILE_CLAMP_TO_GROUND: frameSection = FrameSection::ClampToGround; break;
+			case XPMP_PROFILE_INSTANCES: frameSection = FrameSection::Instances; break;
+			case XPMP_PROFILE_SOUND: frameSection = FrameSection::Sound; break;
+			case XPMP_PROFILE_REMOTE: frameSection = FrameSection::Remote; break;
+			case XPMP_PROFILE_AI_MULTI: frameSection = FrameSection::AiMulti; break;
+			case XPMP_PROFILE_LABELS: frameSection = FrameSection::Labels; break;
+			default: return;
+		}
+		profiler->Record(frameSection, std::llround(micros));
+	}
+
+	const char* FrameProfiler::GetName(FrameSection section)
+	{
+		switch (section)
+		{
+			case FrameSection::CommandQueue: return "Command queue";
+			case FrameSection::Maintenance: return "Aircraft maintenance";
+			case FrameSection::Kinematics: return "Kinematics batch";
+			case FrameSection::UpdatePosition: return "UpdatePosition";
+			case FrameSection::ClampToGround: return "Clamp to ground";
+			case FrameSection::Instances: return "Instances";
+			case FrameSection::Sound: return "Sound";
+			case FrameSection::Remote: return "Remote";
+			case FrameSection::AiMulti: return "AI / TCAS";
+			case FrameSection::Labels: return "Labels";
+			default: return "";
+		}
+	}
+
+	const char* FrameProfiler::GetDataRefName(FrameSection section)
+	{
+		switch (section)
+		{
+			case FrameSection::CommandQueue: return "xpilot/profiler/command_queue";
+			case FrameSection::Maintenance: return "xpilot/profiler/maintenance";
+			case FrameSection::Kinematics: return "xpilot/profiler/kinematics";
+			case FrameSection::UpdatePosition: return "xpilot/profiler/update_position";
+			case FrameSection::ClampToGround: return "xpilot/profiler/clamp_to_ground";
+			case FrameSection::Instances: return "xpilot/profiler/instances";
+			case FrameSection::Sound: return "xpilot/profiler/sound";
+			case FrameSection::Remote: return "xpilot/profiler/remote";
+			case FrameSection::AiMulti: return "xpilot/profiler/ai_multi";
+			case FrameSection::Labels: return "xpilot/profiler/labels";
+			default: return "";
+		}
+	}
+}
@@ -0,0 +1,87 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "dto.h"
+#include "ipc_metrics.h"
+
+namespace xpilot
+{
+	IpcMetrics& IpcMetrics::GetInstance()
+	{
+		static IpcMetrics metrics;
+		return metrics;
+	}
+
+	const char* IpcMetrics::GetName(IpcLatency metric)
+	{
+		switch (metric)
+		{
+			case IpcLatency::ClientHop: return "Client (FSD -> IPC)";
+			case IpcLatency::Transit: return "IPC transit";
+			case IpcLatency::QueueWait: return "Queue wait";
+			case IpcLatency::Apply: return "Apply";
+			case IpcLatency::ApplyToRender: return "Apply -> render";
+			default: return "";
+		}
+	}
+
+	const char* IpcMetrics::GetName(IpcMessageType type)
+	{
+		switch (type)
+		{
+			case IpcMessageType::AddAircraft: return "Add aircraft";
+			case IpcMessageType::FastPosition: return "Fast position";
+			case IpcMessageType::Heartbeat: return "Heartbeat";
+			case IpcMessageType::AircraftConfig: return "Aircraft config";
+			case IpcMessageType::DeleteAircraft: return "Delete aircraft";
+			case IpcMessageType::Other: return "Other";
+			default: return "";
+		}
+	}
+
+	void IpcMetrics::CountMessage(const std::string& type)
+	{
+		IpcMessageType messageType = IpcMessageType::Other;
+		if (type == dto::FAST_POSITION_UPDATE || type == dto::FAST_POSITION_DELTA)
+			messageType = IpcMessageType::FastPosition;
+		else if (type == dto::HEARTBEAT)
+			messageType = IpcMessageType::Heartbeat;
+		else if (type == dto::AIRCRAFT_CONFIG)
+			messageType = IpcMessageType::AircraftConfig;
+		else if (type == dto::ADD_AIRCRAFT)
+			messageType = IpcMessageType::AddAircraft;
+		else if (type == dto::DELETE_AIRCRAFT)
+			messageType = IpcMessageType::DeleteAircraft;
+
+		MessagesReceived.fetch_add(1, std::memory_order_relaxed);
+		m_messageCounts[static_cast<size_t>(messageType)].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	const char* IpcMetrics::GetDataRefName(IpcLatency metric)
+	{
+		switch (metric)
+		{
+			case IpcLatency::ClientHop: return "xpilot/ipc/client_hop";
+			case IpcLatency::Transit: return "xpilot/ipc/transit";
+			case IpcLatency::QueueWait: return "xpilot/ipc/queue_wait";
+			case IpcLatency::Apply: return "xpilot/ipc/apply";
+			case IpcLatency::ApplyToRender: return "xpilot/ipc/apply_to_render";
+			default: return "";
+		}
+	}
+}
@@ -0,0 +1,142 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "ipc_recording.h"
+#include "utilities.h"
+
+namespace xpilot
+{
+	// file layout: the magic, then per message its offset [us] as int64, its length as uint32 and the raw msgpack bytes
+	constexpr char IPC_RECORDING_MAGIC[] = "XPIPC1";
+	constexpr size_t IPC_RECORDING_MAGIC_LENGTH = sizeof(IPC_RECORDING_MAGIC) - 1;
+
+	bool IpcRecording::StartRecording(const std::string& path)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_recording || m_replaying)
+			return false;
+
+		m_file.open(path, std::ios::binary | std::ios::trunc);
+		if (!m_file)
+		{
+			LOG_MSG(logERROR, "Could not open IPC recording %s", path.c_str());
+			return false;
+		}
+
+		m_file.write(IPC_RECORDING_MAGIC, IPC_RECORDING_MAGIC_LENGTH);
+		m_start = PrecisionTimestampMicros();
+		m_messageCount = 0;
+		m_recording = true;
+		LOG_MSG(logMSG, "Recording IPC traffic to %s", path.c_str());
+		return true;
+	}
+
+	void IpcRecording::StopRecording()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_recording)
+			return;
+
+		m_recording = false;
+		m_file.close();
+		LOG_MSG(logMSG, "Stopped recording IPC traffic after %zu messages", m_messageCount.load());
+	}
+
+	void IpcRecording::Record(const char* buffer, size_t length)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_recording)
+			return;
+
+		const int64_t offset = PrecisionTimestampMicros() - m_start;
+		const uint32_t size = static_cast<uint32_t>(length);
+		m_file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+		m_file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+		m_file.write(buffer, length);
+		m_messageCount++;
+	}
+
+	bool IpcRecording::StartReplay(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		char magic[IPC_RECORDING_MAGIC_LENGTH] = {};
+		if (!file || !file.read(magic, IPC_RECORDING_MAGIC_LENGTH) || std::memcmp(magic, IPC_RECORDING_MAGIC, IPC_RECORDING_MAGIC_LENGTH) != 0)
+		{
+			LOG_MSG(logERROR, "%s is not an IPC recording", path.c_str());
+			return false;
+		}
+
+		std::vector<Message> messages;
+		Message message;
+		uint32_t size;
+		while (file.read(reinterpret_cast<char*>(&message.Offset), sizeof(message.Offset))
+			&& file.read(reinterpret_cast<char*>(&size), sizeof(size)))
+		{
+			message.Data.resize(size);
+			if (!file.read(message.Data.data(), size))
+				break; // truncated by a crash while recording, keep what is complete
+			messages.push_back(std::move(message));
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_recording || m_replaying)
+			return false;
+
+		m_messages = std::move(messages);
+		m_next = 0;
+		m_start = PrecisionTimestampMicros();
+		m_messageCount = 0;
+		m_replayLength = m_messages.size();
+		m_replaying = true;
+		LOG_MSG(logMSG, "Replaying %zu IPC messages from %s", m_messages.size(), path.c_str());
+		return true;
+	}
+
+	void IpcRecording::StopReplay()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_replaying)
+			return;
+
+		m_replaying = false;
+		m_messages.clear();
+		LOG_MSG(logMSG, "Stopped IPC replay after %zu of %zu messages", m_messageCount.load(), m_replayLength.load());
+	}
+
+	bool IpcRecording::Replay(const std::function<void(const char*, size_t)>& deliver)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_replaying)
+			return false;
+
+		const int64_t elapsed = PrecisionTimestampMicros() - m_start;
+		while (m_next < m_messages.size() && m_messages[m_next].Offset <= elapsed)
+		{
+			const Message& message = m_messages[m_next++];
+			deliver(message.Data.data(), message.Data.size());
+			m_messageCount++;
+		}
+
+		if (m_next < m_messages.size())
+			return false;
+
+		m_replaying = false;
+		m_messages.clear();
+		return true;
+	}
+}
@@ -0,0 +1,159 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "main_thread_queue.h"
+#include "ipc_metrics.h"
+#include "utilities.h"
+
+namespace xpilot
+{
+	MainThreadQueue::MainThreadQueue(std::function<void(const AircraftCommand&)> dispatch) :
+		m_dispatch(std::move(dispatch)),
+		m_commandQueue(std::make_unique<AircraftCommandQueue>())
+	{
+		m_commandBatch.reserve(AIRCRAFT_COMMAND_QUEUE_CAPACITY);
+	}
+
+	void MainThreadQueue::QueueCallback(const std::function<void()>& cb)
+	{
+		std::lock_guard<std::mutex> lck(m_mutex);
+		m_queuedCallbacks.push_back({ cb, PrecisionTimestampMicros(), m_workSequence++ });
+		IpcMetrics::GetInstance().RecordQueueDepth(m_queuedCallbacks.size());
+	}
+
+	void MainThreadQueue::QueueCommand(AircraftCommand& command)
+	{
+		command.QueuedAt = PrecisionTimestampMicros();
+		command.Sequence = m_workSequence++;
+		if (m_spillPending.load(std::memory_order_acquire) || !m_commandQueue->TryPush(command))
+		{
+			// The flight loop is behind (paused sim, loading scenery). Don't hold up the socket worker, it also
+			// sends to the client: a newer position or heartbeat will follow, everything else takes the slower
+			// callback queue, which keeps its place in the sequence. Until Invoke has taken the spilled
+			// commands, later ones follow them even if the queue has room again; otherwise a command popped
+			// in the same pass could overtake a spilled add or delete of the same aircraft.
+			IpcMetrics& metrics = IpcMetrics::GetInstance();
+			switch (command.Type)
+			{
+				case AircraftCommandType::FastPosition:
+				case AircraftCommandType::Heartbeat:
+					metrics.QueueFullDropped++;
+					return;
+				default:
+				{
+					metrics.QueueFullSpilled++;
+					std::lock_guard<std::mutex> lck(m_mutex);
+					m_queuedCallbacks.push_back({ [this, command] { m_dispatch(command); }, command.QueuedAt, command.Sequence });
+					m_spillPending.store(true, std::memory_order_release);
+					metrics.RecordQueueDepth(m_queuedCallbacks.size());
+					return;
+				}
+			}
+		}
+		IpcMetrics::GetInstance().RecordQueueDepth(m_commandQueue->ApproximateSize());
+	}
+
+	void MainThreadQueue::CoalesceCommandBatch()
+	{
+		// Walk backwards so that only the newest position and heartbeat of each aircraft is applied.
+		// An add or delete is a barrier: anything queued before it must still be applied in order.
+		m_coalescedPositions.clear();
+		m_coalescedHeartbeats.clear();
+		std::vector<bool>& skip = m_commandSuperseded;
+		skip.assign(m_commandBatch.size(), false);
+		uint64_t coalesced = 0;
+
+		for (size_t i = m_commandBatch.size(); i-- > 0;)
+		{
+			const AircraftCommand& cmd = m_commandBatch[i];
+			switch (cmd.Type)
+			{
+				case AircraftCommandType::FastPosition:
+					skip[i] = !m_coalescedPositions.insert(cmd.GetCallsign()).second;
+					break;
+				case AircraftCommandType::Heartbeat:
+					skip[i] = !m_coalescedHeartbeats.insert(cmd.GetCallsign()).second;
+					break;
+				case AircraftCommandType::AddAircraft:
+				case AircraftCommandType::DeleteAircraft:
+					m_coalescedPositions.erase(cmd.GetCallsign());
+					m_coalescedHeartbeats.erase(cmd.GetCallsign());
+					break;
+				case AircraftCommandType::DeleteAllAircraft:
+					m_coalescedPositions.clear();
+					m_coalescedHeartbeats.clear();
+					break;
+				case AircraftCommandType::AircraftConfig:
+					break;
+			}
+			if (skip[i])
+				coalesced++;
+		}
+
+		IpcMetrics::GetInstance().CoalescedCommands += coalesced;
+	}
+
+	void MainThreadQueue::Invoke()
+	{
+		// Callbacks first: a command pushed after this swap can't be older than any callback taken here.
+		std::deque<QueuedCallback> callbacks;
+		{
+			std::lock_guard<std::mutex> lck(m_mutex);
+			std::swap(callbacks, m_queuedCallbacks);
+			m_spillPending.store(false, std::memory_order_release);
+		}
+
+		m_commandBatch.clear();
+		AircraftCommand command;
+		while (m_commandQueue->TryPop(command))
+		{
+			m_commandBatch.push_back(command);
+		}
+		CoalesceCommandBatch();
+
+		IpcMetrics& metrics = IpcMetrics::GetInstance();
+		metrics.QueueDepth = 0;
+
+		// both lists are in sequence order; merge them so work runs in the order it was queued
+		size_t next = 0;
+		auto dispatchCommandsBefore = [&](uint64_t sequence)
+		{
+			for (; next < m_commandBatch.size() && m_commandBatch[next].Sequence < sequence; next++)
+			{
+				if (m_commandSuperseded[next])
+					continue;
+
+				const int64_t start = PrecisionTimestampMicros();
+				metrics.Record(IpcLatency::QueueWait, start - m_commandBatch[next].QueuedAt);
+				m_dispatch(m_commandBatch[next]);
+				metrics.Record(IpcLatency::Apply, PrecisionTimestampMicros() - start);
+			}
+		};
+
+		for (const auto& cb : callbacks)
+		{
+			dispatchCommandsBefore(cb.Sequence);
+
+			const int64_t start = PrecisionTimestampMicros();
+			metrics.Record(IpcLatency::QueueWait, start - cb.QueuedAt);
+			cb.Callback();
+			metrics.Record(IpcLatency::Apply, PrecisionTimestampMicros() - start);
+		}
+		dispatchCommandsBefore(UINT64_MAX);
+	}
+}
@@ -0,0 +1,84 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "model_matcher.h"
+
+namespace xpilot
+{
+	ModelMatcher::ModelMatcher() :
+		m_thread(&ModelMatcher::WorkerLoop, this)
+	{
+	}
+
+	ModelMatcher::~ModelMatcher()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stopping = true;
+		}
+		m_requestAvailable.notify_all();
+		if (m_thread.joinable())
+		{
+			m_thread.join();
+		}
+	}
+
+	void ModelMatcher::Request(uint64_t ticket, const std::string& typeCode, const std::string& airline)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_requests.push_back({ ticket, typeCode, airline });
+		}
+		m_requestAvailable.notify_one();
+	}
+
+	void ModelMatcher::Collect(std::vector<ModelMatchResult>& results)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		results.insert(results.end(), m_results.begin(), m_results.end());
+		m_results.clear();
+	}
+
+	void ModelMatcher::Clear()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_requests.clear();
+		m_results.clear();
+	}
+
+	void ModelMatcher::WorkerLoop()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		for (;;)
+		{
+			m_requestAvailable.wait(lock, [this] { return m_stopping || !m_requests.empty(); });
+			if (m_stopping)
+				return;
+
+			MatchRequest request = std::move(m_requests.front());
+			m_requests.pop_front();
+
+			lock.unlock();
+			XPMP2::CSLModel* model = nullptr;
+			XPMP2::ModelMatch(request.TypeCode, request.Airline, "", model);
+			lock.lock();
+
+			m_results.push_back({ request.Ticket, model });
+		}
+	}
+}
@@ -20,7 +20,37 @@
 
 namespace xpilot
 {
-	static std::list<NearbyAtcList> nearbyList;
+	struct FacilityType
+	{
+		const char* Header;
+		std::vector<std::string> CallsignSuffixes;
+	};
+
+	// in display order
+	static const std::vector<FacilityType> FacilityTypes =
+	{
+		{ "Center/FSS", { "_CTR", "_FSS" } },
+		{ "Approach/Departure", { "_APP", "_DEP" } },
+		{ "Tower", { "_TWR" } },
+		{ "Ground", { "_GND" } },
+		{ "Clearance Delivery", { "_DEL" } },
+		{ "ATIS", { "_ATIS" } },
+	};
+
+	static int ClassifyStation(const std::string& callsign)
+	{
+		for (size_t i = 0; i < FacilityTypes.size(); i++)
+		{
+			for (const auto& suffix : FacilityTypes[i].CallsignSuffixes)
+			{
+				if (ends_with<std::string>(callsign, suffix))
+				{
+					return (int)i;
+				}
+			}
+		}
+		return -1;
+	}
 
 	NearbyAtcWindow::NearbyAtcWindow(XPilot* instance) :
 		XPImgWindow(WND_MODE_FLOAT_CENTERED, WND_STYLE_SOLID, WndRect(0, 300, 500, 0)),
@@ -34,30 +64,42 @@ namespace xpilot
 
 	void NearbyAtcWindow::UpdateList(const NearbyAtcDto& data)
 	{
-		std::lock_guard<std::mutex> lock(m_mutex);
+		std::vector<NearbyAtcFacility> facilities(FacilityTypes.size());
+		for (auto& station : data.stations)
 		{
-			nearbyList.clear();
-			if (!data.stations.empty())
+			const int type = ClassifyStation(station.callsign);
+			if (type < 0)
+				continue;
+
+			NearbyAtcList atc;
+			atc.SetCallsign(station.callsign);
+			atc.SetFrequency(station.frequency);
+			atc.SetXplaneFrequency(station.xplaneFrequency);
+			atc.SetRealName(station.name);
+			facilities[type].Stations.push_back(std::move(atc));
+		}
+
+		for (size_t i = 0; i < facilities.size(); i++)
+		{
+			facilities[i].Header = FacilityTypes[i].Header;
+			facilities[i].Label = " " + facilities[i].Header;
+			std::sort(facilities[i].Stations.begin(), facilities[i].Stations.end(), [](const NearbyAtcList& a, const NearbyAtcList& b)
 			{
-				for (auto& station : data.stations)
-				{
-					NearbyAtcList atc;
-					atc.SetCallsign(station.callsign);
-					atc.SetFrequency(station.frequency);
-					atc.SetXplaneFrequency(station.xplaneFrequency);
-					atc.SetRealName(station.name);
-					nearbyList.push_back(atc);
-				}
-			}
+				return a.GetCallsign() < b.GetCallsign();
+			});
 		}
+
+		facilities.erase(std::remove_if(facilities.begin(), facilities.end(), [](const NearbyAtcFacility& f)
+		{
+			return f.Stations.empty();
+		}), facilities.end());
+
+		m_facilities.Publish(std::move(facilities));
 	}
 
 	void NearbyAtcWindow::ClearList()
 	{
-		std::lock_guard<std::mutex> lock(m_mutex);
-		{
-			nearbyList.clear();
-		}
+		m_facilities.Publish({});
 	}
 
 	void NearbyAtcWindow::buildInterface()
@@ -73,117 +115,95 @@ namespace xpilot
 			SetWindowTitle("Nearby ATC");
 		}
 
-		std::lock_guard lock(m_mutex);
+		// held for this frame only; a list published meanwhile shows up on the next one
+		const auto facilities = m_facilities.Get();
+		if (ImGui::BeginChild("OnlineControllers"))
 		{
-			if (ImGui::BeginChild("OnlineControllers"))
+			for (const auto& facility : *facilities)
 			{
-				RenderAtcTable("Center/FSS", { "_CTR", "_FSS" });
-				RenderAtcTable("Approach/Departure", { "_APP", "_DEP" });
-				RenderAtcTable("Tower", { "_TWR" });
-				RenderAtcTable("Ground", { "_GND" });
-				RenderAtcTable("Clearance Delivery", { "_DEL" });
-				RenderAtcTable("ATIS", { "_ATIS" });
-
-				if (m_env->IsNetworkConnected())
-				{
-					ImGui::PushStyleColor(ImGuiCol_TableRowBg, headerColor.Value);
-					if (ImGui::BeginTable("#unicom", 4, ImGuiTableFlags_RowBg))
-					{
-						ImGui::TableSetupColumn("#callsign", ImGuiTableColumnFlags_WidthFixed, 110);
-						ImGui::TableSetupColumn("#frequency", ImGuiTableColumnFlags_WidthFixed, 100);
-						ImGui::TableSetupColumn("#name", ImGuiTableColumnFlags_WidthStretch);
-						ImGui::TableSetupColumn("#actions", ImGuiTableColumnFlags_WidthFixed, 90);
-
-						ImGui::TableNextRow();
-
-						ImGui::TableSetColumnIndex(0);
-						ImGui::AlignTextToFramePadding();
-						ImGui::Text(" UNICOM");
-
-						ImGui::TableSetColumnIndex(1);
-						ImGui::Text("122.800");
-
-						ImGui::TableSetColumnIndex(3);
-
-						ImGui::SameLine(22);
-						std::string btn1 = "Frequency1#UNICOM";
-						ImGui::PushID(btn1.c_str());
-						if (ImGui::ButtonIcon(ICON_FA_HEADSET, "Tune COM1 Frequency"))
-						{
-							m_com1Frequency = 122800;
-						}
-						ImGui::PopID();
-
-						ImGui::SameLine();
-						std::string btn2 = "Frequency2#UNICOM";
-						ImGui::PushID(btn2.c_str());
-						if (ImGui::ButtonIcon(ICON_FA_HEADSET, "Tune COM2 Frequency"))
-						{
-							m_com2Frequency = 122800;
-						}
-						ImGui::PopID();
-
-						ImGui::EndTable();
-					}
-					ImGui::PopStyleColor();
-				}
-
-				ImGui::EndChild();
+				RenderAtcTable(facility);
 			}
-		}
-	}
 
-	void NearbyAtcWindow::RenderAtcTable(const std::string& headerText,
-		const std::vector<std::string>& callsignSuffixes)
-	{
-		for (const auto& callsignSuffix : callsignSuffixes)
-		{
-			const auto count = std::count_if(nearbyList.begin(), nearbyList.end(), [&](const NearbyAtcList& v)
-			{
-				return ends_with<std::string>(v.GetCallsign(), callsignSuffix);
-			});
-
-			if (count > 0)
+			if (m_env->IsNetworkConnected())
 			{
-				std::string headerTextWithSpace = " " + headerText;
-
-				// Render the header and table as before
-				ImGui::PushStyleColor(ImGuiCol_ChildBg, ImColor(1, 100, 173).Value);
-				ImGui::BeginChild(headerText.c_str(), ImVec2(600, 21));
-				ImGui::AlignTextToFramePadding();
-				ImGui::TextUnformatted(headerTextWithSpace.c_str());
-				ImGui::EndChild();
-				ImGui::PopStyleColor();
-
-				if (ImGui::BeginTable(headerText.c_str(), 4, ImGuiTableFlags_RowBg))
+				ImGui::PushStyleColor(ImGuiCol_TableRowBg, headerColor.Value);
+				if (ImGui::BeginTable("#unicom", 4, ImGuiTableFlags_RowBg))
 				{
 					ImGui::TableSetupColumn("#callsign", ImGuiTableColumnFlags_WidthFixed, 110);
 					ImGui::TableSetupColumn("#frequency", ImGuiTableColumnFlags_WidthFixed, 100);
 					ImGui::TableSetupColumn("#name", ImGuiTableColumnFlags_WidthStretch);
 					ImGui::TableSetupColumn("#actions", ImGuiTableColumnFlags_WidthFixed, 90);
 
-					for (auto& station : nearbyList)
+					ImGui::TableNextRow();
+
+					ImGui::TableSetColumnIndex(0);
+					ImGui::AlignTextToFramePadding();
+					ImGui::Text(" UNICOM");
+
+					ImGui::TableSetColumnIndex(1);
+					ImGui::Text("122.800");
+
+					ImGui::TableSetColumnIndex(3);
+
+					ImGui::SameLine(22);
+					std::string btn1 = "Frequency1#UNICOM";
+					ImGui::PushID(btn1.c_str());
+					if (ImGui::ButtonIcon(ICON_FA_HEADSET, "Tune COM1 Frequency"))
 					{
-						if (ends_with<std::string>(station.GetCallsign(), callsignSuffix))
-						{
-							RenderAtcStationEntry(station);
-						}
+						m_com1Frequency = 122800;
 					}
+					ImGui::PopID();
+
+					ImGui::SameLine();
+					std::string btn2 = "Frequency2#UNICOM";
+					ImGui::PushID(btn2.c_str());
+					if (ImGui::ButtonIcon(ICON_FA_HEADSET, "Tune COM2 Frequency"))
+					{
+						m_com2Frequency = 122800;
+					}
+					ImGui::PopID();
+
 					ImGui::EndTable();
 				}
+				ImGui::PopStyleColor();
+			}
+
+			ImGui::EndChild();
+		}
+	}
+
+	void NearbyAtcWindow::RenderAtcTable(const NearbyAtcFacility& facility)
+	{
+		ImGui::PushStyleColor(ImGuiCol_ChildBg, ImColor(1, 100, 173).Value);
+		ImGui::BeginChild(facility.Header.c_str(), ImVec2(600, 21));
+		ImGui::AlignTextToFramePadding();
+		ImGui::TextUnformatted(facility.Label.c_str());
+		ImGui::EndChild();
+		ImGui::PopStyleColor();
+
+		if (ImGui::BeginTable(facility.Header.c_str(), 4, ImGuiTableFlags_RowBg))
+		{
+			ImGui::TableSetupColumn("#callsign", ImGuiTableColumnFlags_WidthFixed, 110);
+			ImGui::TableSetupColumn("#frequency", ImGuiTableColumnFlags_WidthFixed, 100);
+			ImGui::TableSetupColumn("#name", ImGuiTableColumnFlags_WidthStretch);
+			ImGui::TableSetupColumn("#actions", ImGuiTableColumnFlags_WidthFixed, 90);
+
+			for (const auto& station : facility.Stations)
+			{
+				RenderAtcStationEntry(station);
 			}
+			ImGui::EndTable();
 		}
 	}
 
 	void NearbyAtcWindow::RenderAtcStationEntry(const NearbyAtcList& station)
 	{
 		ImGui::TableNextRow();
+		ImGui::PushID(station.GetCallsign().c_str());
 
 		ImGui::TableSetColumnIndex(0);
-		char buf[32];
-		sprintf(buf, " %s", station.GetCallsign().c_str());
 		ImGui::AlignTextToFramePadding();
-		ImGui::TextUnformatted(buf);
+		ImGui::TextUnformatted(station.GetLabel().c_str());
 
 		ImGui::TableSetColumnIndex(1);
 		ImGui::TextUnformatted(station.GetFrequency().c_str());
@@ -192,8 +212,7 @@ namespace xpilot
 		ImGui::TextUnformatted(station.GetRealName().c_str());
 
 		ImGui::TableSetColumnIndex(3);
-		const std::string btn1 = "RequestInfo#" + station.GetCallsign();
-		ImGui::PushID(btn1.c_str());
+		ImGui::PushID("RequestInfo");
 		if (ImGui::ButtonIcon(ICON_FA_INFO, "Request Station Information"))
 		{
 			m_env->RequestStationInfo(station.GetCallsign());
@@ -201,8 +220,7 @@ namespace xpilot
 		ImGui::PopID();
 
 		ImGui::SameLine();
-		const std::string btn2 = "Frequency1#" + station.GetCallsign();
-		ImGui::PushID(btn2.c_str());
+		ImGui::PushID("Frequency1");
 		if (ImGui::ButtonIcon(ICON_FA_HEADSET, "Tune COM1 Frequency"))
 		{
 			m_com1Frequency = station.GetXplaneFrequency();
@@ -210,12 +228,13 @@ namespace xpilot
 		ImGui::PopID();
 
 		ImGui::SameLine();
-		const std::string btn3 = "Frequency2#" + station.GetCallsign();
-		ImGui::PushID(btn3.c_str());
+		ImGui::PushID("Frequency2");
 		if (ImGui::ButtonIcon(ICON_FA_HEADSET, "Tune COM2 Frequency"))
 		{
 			m_com2Frequency = station.GetXplaneFrequency();
 		}
 		ImGui::PopID();
+
+		ImGui::PopID();
 	}
-}
\ No newline at end of file
+}
@@ -18,11 +18,11 @@
 
 #include "config.h"
 #include "geo_calc.hpp"
+#include "ipc_metrics.h"
 #include "network_aircraft.h"
 #include "abacus.hpp"
 #include "utilities.h"
 
-#include <regex>
 
 namespace xpilot
 {
@@ -33,94 +33,38 @@ namespace xpilot
 		const std::string& _icaoAirline,
 		const std::string& _livery,
 		XPMPPlaneID _modeS_id,
-		const std::string& _modelName) :
-		XPMP2::Aircraft()
+		const std::string& _modelName,
+		XPMP2::CSLModel* _model) :
+		XPMP2::Aircraft(),
+		m_store(AircraftStore::GetInstance()),
+		m_handle(m_store.Allocate(_callsign, this))
 	{
 		strScpy(acInfoTexts.flightNum, _callsign.c_str(), sizeof(acInfoTexts.flightNum));
 		strScpy(acInfoTexts.tailNum, _callsign.c_str(), sizeof(acInfoTexts.tailNum));
 		strScpy(acInfoTexts.icaoAcType, _icaoType.c_str(), sizeof(acInfoTexts.icaoAcType));
 		strScpy(acInfoTexts.icaoAirline, _icaoAirline.c_str(), sizeof(acInfoTexts.icaoAirline));
 
-		Create(_icaoType, _icaoAirline, _livery, _modeS_id, _modelName);
+		Create(_icaoType, _icaoAirline, _livery, _modeS_id, _modelName, _model);
 
 		SetVisible(true);
 		SetLocation(_visualState.Lat, _visualState.Lon, _visualState.AltitudeTrue);
 		SetHeading(_visualState.Heading);
 		SetPitch(_visualState.Pitch);
 		SetRoll(_visualState.Bank);
-
-		IsFirstRenderPending = true;
-		LastVelocityUpdate = PrecisionTimestamp();
-		LastUpdated = PrecisionTimestamp();
-		PredictedVisualState = _visualState;
-		VisualState = _visualState;
-		PositionalVelocities = Vector3::Zero();
-		RotationalVelocities = Vector3::Zero();
+		m_store.RenderedAttitude[m_handle.Slot] = Vector3(GetPitch(), GetHeading(), GetRoll());
+
+		LastVelocityUpdate() = PrecisionTimestamp();
+		LastUpdated() = PrecisionTimestamp();
+		PredictedVisualState() = _visualState;
+		VisualState() = _visualState;
+		PositionalVelocities() = Vector3::Zero();
+		RotationalVelocities() = Vector3::Zero();
 		AircraftFlightModel = GetFlightModel(GetModelInfo());
 	}
 
-	AircraftVisualState NetworkAircraft::ExtrapolatePosition(
-		Vector3 velocityVector,
-		Vector3 rotationVector,
-		double interval)
+	NetworkAircraft::~NetworkAircraft()
 	{
-		double lat_change = MetersToDegrees(velocityVector.Z * interval);
-		double new_lat = NormalizeDegrees(PredictedVisualState.Lat + lat_change, -90.0, 90.0);
-
-		double lon_change = MetersToDegrees(velocityVector.X * interval / LongitudeScalingFactor(PredictedVisualState.Lat));
-		double new_lon = NormalizeDegrees(PredictedVisualState.Lon + lon_change, -180.0, 180.0);
-
-		double alt_change = velocityVector.Y * interval * 3.28084;
-		double new_alt = PredictedVisualState.AltitudeTrue + alt_change;
-
-		double pitch;
-		double bank;
-		double heading;
-
-		if (rotationVector == Vector3::Zero())
-		{
-			pitch = GetPitch();
-			bank = GetRoll();
-			heading = GetHeading();
-		}
-		else
-		{
-			Quaternion current_orientation = Quaternion::CreateFromEuler(
-				DegreesToRadians(PredictedVisualState.Heading),
-				DegreesToRadians(PredictedVisualState.Pitch),
-				DegreesToRadians(PredictedVisualState.Bank)
-			);
-
-			Quaternion rotation = Quaternion::CreateFromEuler(
-				rotationVector.Y,
-				rotationVector.X,
-				rotationVector.Z
-			);
-
-			Quaternion slerp = Quaternion::Slerp(
-				Quaternion::Identity(),
-				rotation,
-				interval > 1.0 ? 1.0 : interval
-			);
-
-			Quaternion result = current_orientation * slerp;
-
-			Vector3 new_orientation = Quaternion::ExtractEulerAngles(result);
-
-			pitch = RadiansToDegrees(new_orientation.X);
-			heading = RadiansToDegrees(new_orientation.Y);
-			bank = RadiansToDegrees(new_orientation.Z);
-		}
-
-		AircraftVisualState predictedVisualState{};
-		predictedVisualState.Lat = new_lat;
-		predictedVisualState.Lon = new_lon;
-		predictedVisualState.AltitudeTrue = new_alt;
-		predictedVisualState.Pitch = pitch;
-		predictedVisualState.Bank = bank;
-		predictedVisualState.Heading = heading;
-
-		return predictedVisualState;
+		m_store.Release(m_handle);
 	}
 
 	void NetworkAircraft::RecordTerrainElevationHistory(double currentTimestamp)
@@ -131,81 +75,51 @@ namespace xpilot
 		}
 
 		HasUsableTerrainElevationData = false;
+		TerrainElevationHistory.Trim(currentTimestamp);
 
-		TerrainElevationHistory.remove_if([&](TerrainElevationData& meta)
-		{
-			return meta.Timestamp < (currentTimestamp - TERRAIN_ELEVATION_DATA_USABLE_AGE + 250);
-		});
-
-		if (VisualState.AltitudeAgl.has_value() && (VisualState.AltitudeAgl.value() <= MAX_USABLE_ALTITUDE_AGL))
+		if (VisualState().AltitudeAgl.has_value() && (VisualState().AltitudeAgl.value() <= MAX_USABLE_ALTITUDE_AGL))
 		{
 			TerrainElevationData data{};
 			data.Timestamp = currentTimestamp;
-			data.Location.Latitude = VisualState.Lat;
-			data.Location.Longitude = VisualState.Lon;
+			data.Location.Latitude = VisualState().Lat;
+			data.Location.Longitude = VisualState().Lon;
 			data.LocalValue = LocalTerrainElevation.value();
-			TerrainElevationHistory.push_back(data);
+			TerrainElevationHistory.Record(data);
 		}
 		else
 		{
 			return;
 		}
 
-		if (TerrainElevationHistory.size() < 2)
-		{
-			return;
-		}
-
-		auto startSample = TerrainElevationHistory.front();
-		auto endSample = TerrainElevationHistory.back();
-		if ((endSample.Timestamp - startSample.Timestamp) < TERRAIN_ELEVATION_DATA_USABLE_AGE)
-		{
-			return;
-		}
-
-		double distance = DegreesToFeet(GreatCircleDistance(
-			startSample.Location.Longitude, startSample.Location.Latitude,
-			endSample.Location.Longitude, endSample.Location.Latitude));
-		double remoteElevationDelta = abs(startSample.RemoteValue - endSample.RemoteValue);
-		double localElevationDelta = abs(startSample.LocalValue - endSample.LocalValue);
-		double remoteSlope = RadiansToDegrees(atan(remoteElevationDelta / distance));
-		if (remoteSlope > TERRAIN_ELEVATION_MAX_SLOPE)
-		{
-			return;
-		}
-		double localSlope = RadiansToDegrees(atan(localElevationDelta / distance));
-		if (localSlope > TERRAIN_ELEVATION_MAX_SLOPE)
-		{
-			return;
-		}
-
-		HasUsableTerrainElevationData = true;
+		HasUsableTerrainElevationData = TerrainElevationHistory.IsUsable();
 	}
 
 	void NetworkAircraft::UpdateVelocityVectors()
 	{
 		auto currentTimestamp = PrecisionTimestamp();
-		if (currentTimestamp - LastVelocityUpdate > 500)
+		if (currentTimestamp - LastVelocityUpdate() > 500)
 		{
 			ClearRotationalVelocities();
 		}
-		LastVelocityUpdate = currentTimestamp;
+		LastVelocityUpdate() = currentTimestamp;
+		m_store.Anchor[m_handle.Slot].Pending = true;
+		Thaw();
 		RecordTerrainElevationHistory(currentTimestamp);
 		UpdateErrorVectors(currentTimestamp);
 	}
 
 	#define ADD_LABEL(b,txt) if (b && !txt.empty()) { aircraftLabel += txt; aircraftLabel += ' '; }
-	void NetworkAircraft::UpdateStaticLabel()
+	void NetworkAircraft::UpdateStaticLabel(AircraftLabelType labelType)
 	{
 		aircraftLabel.clear();
 
-		std::string callsign(acInfoTexts.tailNum);
-		std::string acType(acInfoTexts.icaoAcType);
-		std::string airlineCode(acInfoTexts.icaoAirline);
+		std::string_view callsign(acInfoTexts.tailNum);
+		std::string_view acType(acInfoTexts.icaoAcType);
+		std::string_view airlineCode(acInfoTexts.icaoAirline);
 
-		bool showCallsign = Config::GetInstance().GetAircraftLabelType() == AircraftLabelType::Callsign || Config::GetInstance().GetAircraftLabelType() == AircraftLabelType::CallsignAircraftType;
-		bool showAcType = Config::GetInstance().GetAircraftLabelType() == AircraftLabelType::AircraftType || Config::GetInstance().GetAircraftLabelType() == AircraftLabelType::CallsignAircraftType || Config::GetInstance().GetAircraftLabelType() == AircraftLabelType::AircraftTypeAirlineCode;
-		bool showAirlineCode = Config::GetInstance().GetAircraftLabelType() == AircraftLabelType::AircraftTypeAirlineCode;
+		bool showCallsign = labelType == AircraftLabelType::Callsign || labelType == AircraftLabelType::CallsignAircraftType;
+		bool showAcType = labelType == AircraftLabelType::AircraftType || labelType == AircraftLabelType::CallsignAircraftType || labelType == AircraftLabelType::AircraftTypeAirlineCode;
+		bool showAirlineCode = labelType == AircraftLabelType::AircraftTypeAirlineCode;
 
 		ADD_LABEL(showCallsign, callsign);
 		ADD_LABEL(showAirlineCode, airlineCode);
@@ -217,12 +131,22 @@ namespace xpilot
 	void NetworkAircraft::PerformGroundClamping(float frameRate)
 	{
 		LocalTerrainElevation = {};
-		if (PredictedVisualState.AltitudeTrue < 18000.0)
+		if (PredictedVisualState().AltitudeTrue < 18000.0)
 		{
-			LocalTerrainElevation = LocalTerrainProbe.GetTerrainElevation(
-				PredictedVisualState.Lat,
-				PredictedVisualState.Lon
-			);
+			const int64_t now = PrecisionTimestamp();
+			if (!SampledTerrainElevation.has_value() || now >= NextTerrainSampleTime)
+			{
+				TerrainCache& cache = TerrainCache::GetInstance();
+				SampledTerrainElevation = IsTerrainCacheEligible()
+					? cache.GetTerrainElevation(PredictedVisualState().Lat, PredictedVisualState().Lon)
+					: cache.ProbeTerrainElevation(PredictedVisualState().Lat, PredictedVisualState().Lon);
+				NextTerrainSampleTime = now + GetTerrainSampleInterval();
+			}
+			LocalTerrainElevation = SampledTerrainElevation;
+		}
+		else
+		{
+			SampledTerrainElevation = {};
 		}
 
 		AdjustedAltitude = {};
@@ -232,13 +156,13 @@ namespace xpilot
 		}
 
 		double agl;
-		if (VisualState.AltitudeAgl.has_value())
+		if (VisualState().AltitudeAgl.has_value())
 		{
-			agl = VisualState.AltitudeAgl.value();
+			agl = VisualState().AltitudeAgl.value();
 		}
 		else
 		{
-			agl = PredictedVisualState.AltitudeTrue - LocalTerrainElevation.value();
+			agl = PredictedVisualState().AltitudeTrue - LocalTerrainElevation.value();
 		}
 
 		// Check if we can bail out early.
@@ -247,7 +171,7 @@ namespace xpilot
 			&& (TargetTerrainOffset == 0.0)
 			&& (TerrainOffset == 0.0))
 		{
-			AdjustedAltitude = PredictedVisualState.AltitudeTrue;
+			AdjustedAltitude = PredictedVisualState().AltitudeTrue;
 			EnsureAboveGround();
 			return;
 		}
@@ -255,13 +179,13 @@ namespace xpilot
 		double newTargetOffset;
 		if (HasUsableTerrainElevationData || IsReportedOnGround)
 		{
-			double remoteTerrainElevation = VisualState.AltitudeTrue - agl;
+			double remoteTerrainElevation = VisualState().AltitudeTrue - agl;
 			newTargetOffset = Round(LocalTerrainElevation.value() - remoteTerrainElevation, 2);
 
 			// correct for terrain elevation differences in X-Plane
-			if (IsReportedOnGround && (VisualState.AltitudeTrue + newTargetOffset > LocalTerrainElevation.value()))
+			if (IsReportedOnGround && (VisualState().AltitudeTrue + newTargetOffset > LocalTerrainElevation.value()))
 			{
-				double adj = LocalTerrainElevation.value() - (VisualState.AltitudeTrue + newTargetOffset);
+				double adj = LocalTerrainElevation.value() - (VisualState().AltitudeTrue + newTargetOffset);
 				newTargetOffset += adj;
 			}
 		}
@@ -279,7 +203,7 @@ namespace xpilot
 
 		if (TerrainOffset != TargetTerrainOffset)
 		{
-			if (IsFirstRenderPending)
+			if (IsFirstRenderPending())
 			{
 				TerrainOffset = TargetTerrainOffset;
 			}
@@ -300,11 +224,176 @@ namespace xpilot
 			}
 		}
 
-		AdjustedAltitude = PredictedVisualState.AltitudeTrue + TerrainOffset;
+		AdjustedAltitude = PredictedVisualState().AltitudeTrue + TerrainOffset;
 
 		EnsureAboveGround();
 	}
 
+	void NetworkAircraft::UpdateAnimation(int64_t currentTimestamp)
+	{
+		TargetGearPosition = IsGearDown || IsReportedOnGround ? 1.0f : 0.0f;
+		TargetSpoilerPosition = IsSpoilersDeployed ? 1.0f : 0.0f;
+		TargetReverserPosition = IsEnginesReversing ? 1.0f : 0.0f;
+
+		if (IsFirstRenderPending())
+		{
+			// Set initial aircraft surfaces
+			Surfaces.gearPosition = TargetGearPosition;
+			Surfaces.flapRatio = TargetFlapsPosition;
+			Surfaces.spoilerRatio = TargetSpoilerPosition;
+		}
+		else
+		{
+			const auto diffMs = currentTimestamp - PreviousSurfaceUpdateTime;
+			Interpolate(Surfaces.gearPosition, TargetGearPosition, diffMs, AircraftFlightModel.GEAR_DURATION);
+			Interpolate(Surfaces.flapRatio, TargetFlapsPosition, diffMs, AircraftFlightModel.FLAPS_DURATION);
+			Interpolate(Surfaces.spoilerRatio, TargetSpoilerPosition, diffMs, AircraftFlightModel.FLAPS_DURATION);
+			Interpolate(Surfaces.reversRatio, TargetReverserPosition, diffMs, 1500);
+			PreviousSurfaceUpdateTime = currentTimestamp;
+		}
+
+		SetGearRatio(Surfaces.gearPosition);
+		SetFlapRatio(Surfaces.flapRatio);
+		SetSlatRatio(GetFlapRatio());
+		SetSpoilerRatio(Surfaces.spoilerRatio);
+		SetSpeedbrakeRatio(Surfaces.spoilerRatio);
+		SetTireDeflection(AircraftFlightModel.GEAR_DEFLECTION / 2.0f);
+		SetReversDeployRatio(Surfaces.reversRatio);
+		SetThrustReversRatio(Surfaces.reversRatio);
+		SetNoseWheelAngle(VisualState().NoseWheelAngle);
+
+		// Show tire smoke briefly upon touchdown
+		if (IsReportedOnGround && !IsOnGrnd())
+		{
+			if (LocalTerrainElevation.has_value() &&
+				AdjustedAltitude.value_or(PredictedVisualState().AltitudeTrue) <= LocalTerrainElevation.value())
+			{
+				SetOnGrnd(IsReportedOnGround, IsFirstRenderPending() ? NAN : 2.0f);
+			}
+		}
+
+		if (IsReportedOnGround && 
+			LocalTerrainElevation.has_value() && 
+			AdjustedAltitude.value_or(PredictedVisualState().AltitudeTrue) <= LocalTerrainElevation.value())
+		{
+			double rpm = (60 / (2 * M_PI * 3.2)) * abs(PositionalVelocities().X);
+			double rpmDeg = RpmToDegree(GetTireRotRpm(), AnimationElapsed);
+			SetTireRotRpm(rpm);
+			SetTireRotAngle(GetTireRotAngle() + rpmDeg);
+			while (GetTireRotAngle() >= 360.0f)
+			{
+				SetTireRotAngle(GetTireRotAngle() - 360.0f);
+			}
+		}
+
+		if (IsEnginesRunning)
+		{
+			SetEngineRotRpm(1200);
+			SetPropRotRpm(GetEngineRotRpm());
+			SetEngineRotAngle(GetEngineRotAngle() + RpmToDegree(GetEngineRotRpm(), AnimationElapsed));
+			while (GetEngineRotAngle() >= 360.0f)
+			{
+				SetEngineRotAngle(GetEngineRotAngle() - 360.0f);
+			}
+			SetPropRotAngle(GetEngineRotAngle());
+			SetThrustRatio(1.0f);
+		}
+		else
+		{
+			SetEngineRotRpm(0.0f);
+			SetPropRotRpm(0.0f);
+			SetEngineRotAngle(0.0f);
+			SetPropRotAngle(0.0f);
+			SetThrustRatio(0.0f);
+		}
+
+		AnimationElapsed = 0.0f;
+	}
+
+	AircraftLodTier NetworkAircraft::GetLodTier()
+	{
+		const AircraftFrameSettings& settings = m_store.GetFrameSettings();
+		const float distance = GetCameraDist();
+		if (distance < settings.LodNearDistance)
+			return AircraftLodTier::Near;
+		if (distance < settings.LodFarDistance)
+			return AircraftLodTier::Mid;
+		return AircraftLodTier::Far;
+	}
+
+	bool NetworkAircraft::CanFreeze(int64_t currentTimestamp)
+	{
+		const bool errorVelocitiesDone = currentTimestamp > ApplyErrorVelocitiesUntil()
+			|| (PositionalErrorVelocities() == Vector3::Zero() && RotationalErrorVelocities() == Vector3::Zero());
+
+		return PositionalVelocities() == Vector3::Zero()
+			&& RotationalVelocities() == Vector3::Zero()
+			&& errorVelocitiesDone
+			&& !IsEnginesRunning
+			&& TerrainOffset == TargetTerrainOffset
+			&& Surfaces.gearPosition == TargetGearPosition
+			&& Surfaces.flapRatio == TargetFlapsPosition
+			&& Surfaces.spoilerRatio == TargetSpoilerPosition
+			&& Surfaces.reversRatio == TargetReverserPosition;
+	}
+
+	void NetworkAircraft::UpdateLocalFrameAnchor()
+	{
+		LocalFrameAnchor& anchor = m_store.Anchor[m_handle.Slot];
+		const AircraftVisualState& predicted = PredictedVisualState();
+
+		anchor.Lat = predicted.Lat;
+		anchor.Lon = predicted.Lon;
+		anchor.AltitudeTrue = predicted.AltitudeTrue;
+		anchor.LonScale = LongitudeScalingFactor(predicted.Lat);
+		anchor.FrameGeneration = m_store.GetLocalFrameGeneration();
+		anchor.Pending = false;
+		m_store.AnchorOffset[m_handle.Slot] = Vector3::Zero();
+
+		// the local frame is a tangent plane at X-Plane's reference point, not at the aircraft,
+		// so derive the east/up/north axes at the anchor from three neighbouring points
+		const double alt = predicted.AltitudeTrue * METERS_PER_FOOT;
+		double x, y, z;
+		XPLMWorldToLocal(predicted.Lat, predicted.Lon, alt, &x, &y, &z);
+		anchor.Origin = Vector3(x, y, z);
+		XPLMWorldToLocal(predicted.Lat, predicted.Lon + MetersToDegrees(1.0 / anchor.LonScale), alt, &x, &y, &z);
+		anchor.East = Vector3(x, y, z) - anchor.Origin;
+		XPLMWorldToLocal(predicted.Lat, predicted.Lon, alt + 1.0, &x, &y, &z);
+		anchor.Up = Vector3(x, y, z) - anchor.Origin;
+		XPLMWorldToLocal(predicted.Lat + MetersToDegrees(1.0), predicted.Lon, alt, &x, &y, &z);
+		anchor.North = Vector3(x, y, z) - anchor.Origin;
+	}
+
+	int64_t NetworkAircraft::GetTerrainSampleInterval()
+	{
+		if (IsFirstRenderPending() || GetCameraDist() < TERRAIN_LOD_NEAR_DISTANCE)
+		{
+			return 0;
+		}
+
+		// landing and departing traffic needs the terrain under it every frame, wherever the camera is
+		if (std::abs(PositionalVelocities().Y) > TERRAIN_LOD_VERTICAL_SPEED && IsNearTerrain())
+		{
+			return 0;
+		}
+
+		const int64_t interval = GetCameraDist() < TERRAIN_LOD_MID_DISTANCE ? TERRAIN_LOD_MID_INTERVAL : TERRAIN_LOD_FAR_INTERVAL;
+		return interval * m_store.GetFrameSettings().TerrainIntervalScale;
+	}
+
+	bool NetworkAircraft::IsNearTerrain()
+	{
+		return SampledTerrainElevation.has_value()
+			&& PredictedVisualState().AltitudeTrue - SampledTerrainElevation.value() < TERRAIN_LOD_VERTICAL_MAX_AGL;
+	}
+
+	bool NetworkAircraft::IsTerrainCacheEligible()
+	{
+		// taxiing and parked traffic shares the grid; airborne traffic crosses a new cell every few frames
+		// and would fill the cache with samples nobody else reads, so it probes directly
+		return IsReportedOnGround || (IsNearTerrain() && std::abs(PositionalVelocities().Y) <= TERRAIN_LOD_VERTICAL_SPEED);
+	}
+
 	void NetworkAircraft::EnsureAboveGround()
 	{
 		if (AdjustedAltitude < LocalTerrainElevation.value())
@@ -315,190 +404,157 @@ namespace xpilot
 
 	void NetworkAircraft::ClearRotationalVelocities()
 	{
-		RotationalVelocities = Vector3::Zero();
-		RotationalErrorVelocities = Vector3::Zero();
-		PredictedVisualState.Pitch = VisualState.Pitch;
-		PredictedVisualState.Bank = VisualState.Bank;
-		PredictedVisualState.Heading = VisualState.Heading;
+		RotationalVelocities() = Vector3::Zero();
+		RotationalErrorVelocities() = Vector3::Zero();
+		PredictedVisualState().Pitch = VisualState().Pitch;
+		PredictedVisualState().Bank = VisualState().Bank;
+		PredictedVisualState().Heading = VisualState().Heading;
 	}
 
 	void NetworkAircraft::UpdateErrorVectors(double currentTimestamp)
 	{
 		double latDelta = DegreesToMeters(CalculateNormalizedDelta(
-			PredictedVisualState.Lat,
-			VisualState.Lat,
+			PredictedVisualState().Lat,
+			VisualState().Lat,
 			-90.0,
 			90.0
 		));
 
 		double lonDelta = DegreesToMeters(CalculateNormalizedDelta(
-			PredictedVisualState.Lon,
-			VisualState.Lon,
+			PredictedVisualState().Lon,
+			VisualState().Lon,
 			-180.0,
 			180.0
 		));
-		lonDelta *= LongitudeScalingFactor(VisualState.Lat);
+		lonDelta *= LongitudeScalingFactor(VisualState().Lat);
 
-		double altDelta = (VisualState.AltitudeTrue - PredictedVisualState.AltitudeTrue) * 0.3048;
+		double altDelta = (VisualState().AltitudeTrue - PredictedVisualState().AltitudeTrue) * 0.3048;
 
-		PositionalErrorVelocities = Vector3(
+		PositionalErrorVelocities() = Vector3(
 			lonDelta / 2.0,
 			altDelta / 2.0,
 			latDelta / 2.0
 		);
 
-		if (PredictedVisualState.Pitch == VisualState.Pitch &&
-			PredictedVisualState.Heading == VisualState.Heading &&
-			PredictedVisualState.Bank == VisualState.Bank)
+		if (PredictedVisualState().Pitch == VisualState().Pitch &&
+			PredictedVisualState().Heading == VisualState().Heading &&
+			PredictedVisualState().Bank == VisualState().Bank)
 		{
-			RotationalErrorVelocities = Vector3::Zero();
+			RotationalErrorVelocities() = Vector3::Zero();
 		}
 		else
 		{
 			Quaternion currentOrientation = Quaternion::CreateFromEuler(
-				DegreesToRadians(PredictedVisualState.Heading),
-				DegreesToRadians(PredictedVisualState.Pitch),
-				DegreesToRadians(PredictedVisualState.Bank)
+				DegreesToRadians(PredictedVisualState().Heading),
+				DegreesToRadians(PredictedVisualState().Pitch),
+				DegreesToRadians(PredictedVisualState().Bank)
 			);
 
 			Quaternion targetOrientation = Quaternion::CreateFromEuler(
-				DegreesToRadians(VisualState.Heading),
-				DegreesToRadians(VisualState.Pitch),
-				DegreesToRadians(VisualState.Bank)
+				DegreesToRadians(VisualState().Heading),
+				DegreesToRadians(VisualState().Pitch),
+				DegreesToRadians(VisualState().Bank)
 			);
 
 			Quaternion delta = Quaternion::Inverse(currentOrientation) * targetOrientation;
 
 			Vector3 result = Quaternion::ExtractEulerAngles(delta);
 
-			RotationalErrorVelocities = Vector3(result.X / 2.0, result.Y / 2.0, result.Z / 2.0);
+			RotationalErrorVelocities() = Vector3(result.X / 2.0, result.Y / 2.0, result.Z / 2.0);
 		}
 
-		ApplyErrorVelocitiesUntil = currentTimestamp + 2000;
+		ApplyErrorVelocitiesUntil() = currentTimestamp + 2000;
 	}
 
-	void NetworkAircraft::UpdatePosition(float _frameRatePeriod, int)
+	void NetworkAircraft::UpdatePosition(float _frameRatePeriod, int _flCounter)
 	{
-		auto currentTimestamp = PrecisionTimestamp();
+		// extrapolates every aircraft on the first call of this flight loop
+		m_store.PrepareFrame(_flCounter, _frameRatePeriod);
 
-		if (IsFirstRenderPending)
-		{
-			PredictedVisualState = VisualState;
-			PositionalErrorVelocities = Vector3::Zero();
-			RotationalErrorVelocities = Vector3::Zero();
-		}
-		else
-		{
-			if (currentTimestamp - LastVelocityUpdate > 500)
-			{
-				ClearRotationalVelocities();
-			}
+		if (IsFrozen())
+			return;
 
-			Vector3 positionalVelocities = PositionalVelocities;
-			Vector3 rotationalVelocities = RotationalVelocities;
+		const AircraftFrameSettings& settings = m_store.GetFrameSettings();
+		const bool culled = m_store.IsCulled(m_handle.Slot);
+		SetRender(!culled);
 
-			if (currentTimestamp <= ApplyErrorVelocitiesUntil)
-			{
-				positionalVelocities += PositionalErrorVelocities;
-				rotationalVelocities += RotationalErrorVelocities;
-			}
+		// the first render always gets the full treatment so surfaces start out at their targets;
+		// culled aircraft only have to stay current for TCAS
+		const AircraftLodTier tier = culled ? AircraftLodTier::Far : IsFirstRenderPending() ? AircraftLodTier::Near : GetLodTier();
+		m_store.LodTier[m_handle.Slot] = tier;
+		AnimationElapsed += _frameRatePeriod;
+		PositionElapsed += _frameRatePeriod;
 
-			PredictedVisualState = ExtrapolatePosition(positionalVelocities, rotationalVelocities, _frameRatePeriod);
+		const bool muteSounds = settings.MuteDistantSounds && tier != AircraftLodTier::Near;
+		if (muteSounds != SoundIsMuted())
+		{
+			SoundMuteAll(muteSounds);
 		}
 
-		PerformGroundClamping(1.0 / _frameRatePeriod);
+		// far aircraft are staggered by slot so each frame only moves a share of them
+		if (tier == AircraftLodTier::Far && (_flCounter + m_handle.Slot) % settings.FarFrameInterval != 0)
+			return;
 
-		SetLocation(PredictedVisualState.Lat, PredictedVisualState.Lon, AdjustedAltitude.value_or(PredictedVisualState.AltitudeTrue));
-		SetPitch(PredictedVisualState.Pitch);
-		SetRoll(PredictedVisualState.Bank);
-		SetHeading(PredictedVisualState.Heading);
+		auto currentTimestamp = PrecisionTimestamp();
 
-		TargetGearPosition = IsGearDown || IsReportedOnGround ? 1.0f : 0.0f;
-		TargetSpoilerPosition = IsSpoilersDeployed ? 1.0f : 0.0f;
-		TargetReverserPosition = IsEnginesReversing ? 1.0f : 0.0f;
+		if (PositionAppliedAt > 0)
+		{
+			IpcMetrics::GetInstance().Record(IpcLatency::ApplyToRender, PrecisionTimestampMicros() - PositionAppliedAt);
+			PositionAppliedAt = 0;
+		}
 
-		if (IsFirstRenderPending)
+		if (IsFirstRenderPending())
 		{
-			// Set initial aircraft surfaces
-			Surfaces.gearPosition = TargetGearPosition;
-			Surfaces.flapRatio = TargetFlapsPosition;
-			Surfaces.spoilerRatio = TargetSpoilerPosition;
+			PredictedVisualState() = VisualState();
+			PositionalErrorVelocities() = Vector3::Zero();
+			RotationalErrorVelocities() = Vector3::Zero();
 		}
-		else
+
+		PerformGroundClamping(1.0 / PositionElapsed);
+		PositionElapsed = 0.0f;
+
+		const LocalFrameAnchor& anchor = m_store.Anchor[m_handle.Slot];
+		if (anchor.Pending || anchor.FrameGeneration != m_store.GetLocalFrameGeneration())
 		{
-			const auto diffMs = currentTimestamp - PreviousSurfaceUpdateTime;
-			Interpolate(Surfaces.gearPosition, TargetGearPosition, diffMs, AircraftFlightModel.GEAR_DURATION);
-			Interpolate(Surfaces.flapRatio, TargetFlapsPosition, diffMs, AircraftFlightModel.FLAPS_DURATION);
-			Interpolate(Surfaces.spoilerRatio, TargetSpoilerPosition, diffMs, AircraftFlightModel.FLAPS_DURATION);
-			Interpolate(Surfaces.reversRatio, TargetReverserPosition, diffMs, 1500);
-			PreviousSurfaceUpdateTime = currentTimestamp;
+			UpdateLocalFrameAnchor();
 		}
 
+		const Vector3& offset = m_store.AnchorOffset[m_handle.Slot];
+		const double up = (AdjustedAltitude.value_or(PredictedVisualState().AltitudeTrue) - anchor.AltitudeTrue) * METERS_PER_FOOT;
+		const Vector3 local = anchor.Origin + anchor.East * offset.X + anchor.North * offset.Z + anchor.Up * up;
+		SetLocalLoc(float(local.X), float(local.Y) + GetVertOfs(), float(local.Z));
+		SetPitch(PredictedVisualState().Pitch);
+		SetRoll(PredictedVisualState().Bank);
+		SetHeading(PredictedVisualState().Heading);
+		m_store.RenderedAttitude[m_handle.Slot] = Vector3(GetPitch(), GetHeading(), GetRoll());
+
+		// lights stay current at every range, they are what is visible of a distant aircraft at night
 		SetLightsTaxi(Surfaces.lights.taxiLights);
 		SetLightsLanding(Surfaces.lights.landLights);
 		SetLightsBeacon(Surfaces.lights.bcnLights);
 		SetLightsStrobe(Surfaces.lights.strbLights);
 		SetLightsNav(Surfaces.lights.navLights);
 
-		SetGearRatio(Surfaces.gearPosition);
-		SetFlapRatio(Surfaces.flapRatio);
-		SetSlatRatio(GetFlapRatio());
-		SetSpoilerRatio(Surfaces.spoilerRatio);
-		SetSpeedbrakeRatio(Surfaces.spoilerRatio);
-		SetTireDeflection(AircraftFlightModel.GEAR_DEFLECTION / 2.0f);
-		SetReversDeployRatio(Surfaces.reversRatio);
-		SetThrustReversRatio(Surfaces.reversRatio);
-		SetNoseWheelAngle(VisualState.NoseWheelAngle);
-
-		// Show tire smoke briefly upon touchdown
-		if (IsReportedOnGround && !IsOnGrnd())
+		const bool animate = tier == AircraftLodTier::Near
+			|| (tier == AircraftLodTier::Mid && (_flCounter + m_handle.Slot) % settings.MidFrameInterval == 0);
+		if (animate)
 		{
-			if (LocalTerrainElevation.has_value() &&
-				AdjustedAltitude.value_or(PredictedVisualState.AltitudeTrue) <= LocalTerrainElevation.value())
-			{
-				SetOnGrnd(IsReportedOnGround, IsFirstRenderPending ? NAN : 2.0f);
-			}
+			UpdateAnimation(currentTimestamp);
 		}
 
-		if (IsReportedOnGround && 
-			LocalTerrainElevation.has_value() && 
-			AdjustedAltitude.value_or(PredictedVisualState.AltitudeTrue) <= LocalTerrainElevation.value())
+		if (m_labelRevision != settings.LabelRevision)
 		{
-			double rpm = (60 / (2 * M_PI * 3.2)) * abs(PositionalVelocities.X);
-			double rpmDeg = RpmToDegree(GetTireRotRpm(), _frameRatePeriod);
-			SetTireRotRpm(rpm);
-			SetTireRotAngle(GetTireRotAngle() + rpmDeg);
-			while (GetTireRotAngle() >= 360.0f)
-			{
-				SetTireRotAngle(GetTireRotAngle() - 360.0f);
-			}
+			UpdateStaticLabel(settings.LabelType);
+			HexToRgb(settings.LabelColor, colLabel);
+			m_labelRevision = settings.LabelRevision;
 		}
 
-		if (IsEnginesRunning)
+		m_store.FirstRenderPending[m_handle.Slot] = 0;
+
+		if (CanFreeze(currentTimestamp))
 		{
-			SetEngineRotRpm(1200);
-			SetPropRotRpm(GetEngineRotRpm());
-			SetEngineRotAngle(GetEngineRotAngle() + RpmToDegree(GetEngineRotRpm(), _frameRatePeriod));
-			while (GetEngineRotAngle() >= 360.0f)
-			{
-				SetEngineRotAngle(GetEngineRotAngle() - 360.0f);
-			}
-			SetPropRotAngle(GetEngineRotAngle());
-			SetThrustRatio(1.0f);
+			m_store.Freeze(m_handle.Slot);
 		}
-		else
-		{
-			SetEngineRotRpm(0.0f);
-			SetPropRotRpm(0.0f);
-			SetEngineRotAngle(0.0f);
-			SetPropRotAngle(0.0f);
-			SetThrustRatio(0.0f);
-		}
-
-		UpdateStaticLabel();
-		HexToRgb(Config::GetInstance().GetAircraftLabelColor(), colLabel);
-
-		IsFirstRenderPending = false;
 	}
 
 	void NetworkAircraft::copyBulkData(XPilotAPIAircraft::XPilotAPIBulkData* pOut, size_t size) const
@@ -549,32 +605,78 @@ namespace xpilot
 		STRCPY_ATMOST(pOut->destination, Destination);
 	}
 
+	FlightModelField::FlightModelField(const char* specText)
+	{
+		const std::string_view spec(specText);
+		size_t start = 0;
+		while (start <= spec.size())
+		{
+			const size_t end = std::min(spec.find('|', start), spec.size());
+			const std::string_view alternative = spec.substr(start, end - start);
+			if (alternative == "*")
+			{
+				m_any = true;
+			}
+			else if (alternative.find_first_of("#?*") == std::string_view::npos)
+			{
+				m_exact.emplace(alternative);
+			}
+			else
+			{
+				m_patterns.emplace_back(alternative);
+			}
+			start = end + 1;
+		}
+	}
+
+	bool FlightModelField::Matches(std::string_view value) const
+	{
+		if (m_any || m_exact.count(std::string(value)) > 0)
+			return true;
+
+		for (const auto& pattern : m_patterns)
+		{
+			size_t i = 0;
+			for (; i < pattern.size(); i++)
+			{
+				if (pattern[i] == '*')
+					return true;
+				if (i >= value.size())
+					break;
+				if (pattern[i] == '#' ? !isdigit(static_cast<unsigned char>(value[i])) : pattern[i] != '?' && pattern[i] != value[i])
+					break;
+			}
+			if (i == pattern.size() && i == value.size())
+				return true;
+		}
+		return false;
+	}
+
 	void FlightModel::InitializeModels()
 	{
+		// first match wins; fields are wake category, classification, ICAO type
+
 		// Huge Jets
-		modelMatches.push_back({ "HugeJets","^(H|J);L\\dJ;" });
-		modelMatches.push_back({ "HugeJets","^M;L4J;" });
+		modelMatches.push_back({ "HugeJets", "H|J", "L#J", "*" });
+		modelMatches.push_back({ "HugeJets", "M", "L4J", "*" });
 
 		// Biz Jets
-		modelMatches.push_back({ "BizJet","^M;L\\dJ;*BEECH*" });     // Beech, Beechcraft
-		modelMatches.push_back({ "BizJet","^M;L\\dJ;GLF" });         // Grumman Gulfstream
-		modelMatches.push_back({ "BizJet","^M;L\\dJ;LJ" });          // Learjet
-		modelMatches.push_back({ "BizJet","^M;L\\dJ;*BEECH*" });     // Beech, Beechcraft
-		modelMatches.push_back({ "BizJet","^M;L\\dJ;.*;CESSNA" });   // Cessna
-		modelMatches.push_back({ "BizJet","^M;L\\dJ;.*;DASSAULT" }); // Dassault (Falcon)
+		modelMatches.push_back({ "BizJet", "M", "L#J", "BEEC*" });   // Beech, Beechcraft
+		modelMatches.push_back({ "BizJet", "M", "L#J", "GLF*" });    // Grumman Gulfstream
+		modelMatches.push_back({ "BizJet", "M", "L#J", "LJ*" });     // Learjet
 
 		// Medium Jets
-		modelMatches.push_back({ "MediumJets","^M;L\\dJ;" });
-		modelMatches.push_back({ "MediumProps","^M;L\\dT;" });
-		modelMatches.push_back({ "BizJet","^L;L\\dJ;" });
-		modelMatches.push_back({ "Glider",";(GLID|A20J|A33P|A33E|A34E|ARCE|ARCP|AS14|AS16|AS20|AS21|AS22|AS24|AS25|AS26|AS28|AS29|AS30|AS31|DG1T|DG40|DG50|DG60|DG80|DIMO|DISC|DUOD|G103|G109|HU1|HU2|JANU|L13M|LAE1|LK17|LK19|LK20|LS8|LS9|NIMB|PISI|PITE|PITA|PIT4|PK15|PK20|S10S|S32M|S32E|SF24|SF25|SF27|SF28|SF31|SZ45|SZ9M|TS1J|VENT);" });
-		modelMatches.push_back({ "LightAC", "^-" });
-		modelMatches.push_back({ "TurboProps", "^L;L\\dT;" });
-		modelMatches.push_back({ "GA", "^L;L\\dP;" });
-		modelMatches.push_back({ "Heli", "^.;H" });
+		modelMatches.push_back({ "MediumJets", "M", "L#J", "*" });
+		modelMatches.push_back({ "MediumProps", "M", "L#T", "*" });
+		modelMatches.push_back({ "BizJet", "L", "L#J", "*" });
+		modelMatches.push_back({ "Glider", "*", "*", "GLID|A20J|A33P|A33E|A34E|ARCE|ARCP|AS14|AS16|AS20|AS21|AS22|AS24|AS25|AS26|AS28|AS29|AS30|AS31|DG1T|DG40|DG50|DG60|DG80|DIMO|DISC|DUOD|G103|G109|HU1|HU2|JANU|L13M|LAE1|LK17|LK19|LK20|LS8|LS9|NIMB|PISI|PITE|PITA|PIT4|PK15|PK20|S10S|S32M|S32E|SF24|SF25|SF27|SF28|SF31|SZ45|SZ9M|TS1J|VENT" });
+		modelMatches.push_back({ "LightAC", "-*", "*", "*" });
+		modelMatches.push_back({ "TurboProps", "L", "L#T", "*" });
+		modelMatches.push_back({ "GA", "L", "L#P", "*" });
+		modelMatches.push_back({ "Heli", "?", "H*", "*" });
 
 		// Fallback
-		modelMatches.push_back({ "MediumJets", ".*" });
+		modelMatches.push_back({ "MediumJets", "*", "*", "*" });
 	}
 
 	float NetworkAircraft::GetLift() const
@@ -586,14 +688,19 @@ namespace xpilot
 	FlightModel NetworkAircraft::GetFlightModel(const XPMP2::CSLModelInfo_t model)
 	{
 		std::string classification = string_format("%s;%s;%s;", model.doc8643WTC.c_str(), model.doc8643Classification.c_str(), model.icaoType.c_str());
+		auto cached = FlightModel::modelCache.find(classification);
+		if (cached != FlightModel::modelCache.end())
+		{
+			return cached->second;
+		}
+
 		std::string category = "MediumJets";
 
 		for (const auto& mapIt : FlightModel::modelMatches)
 		{
-			std::smatch m;
-			std::regex re(mapIt.regex.c_str());
-			std::regex_search(classification, m, re);
-			if (m.size() > 0)
+			if (mapIt.wtc.Matches(model.doc8643WTC) &&
+				mapIt.classification.Matches(model.doc8643Classification) &&
+				mapIt.icaoType.Matches(model.icaoType))
 			{
 				category = mapIt.category;
 				break;
@@ -640,8 +747,10 @@ namespace xpilot
 			flightModel.GEAR_DEFLECTION = 0.5;
 		}
 
+		FlightModel::modelCache.emplace(std::move(classification), flightModel);
 		return flightModel;
 	}
 
 	std::vector<FlightModelInfo> FlightModel::modelMatches;
+	std::unordered_map<std::string, FlightModel> FlightModel::modelCache;
 }
\ No newline at end of file
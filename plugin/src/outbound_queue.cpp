@@ -0,0 +1,117 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "outbound_queue.h"
+#include "ipc_metrics.h"
+
+namespace xpilot
+{
+	OutboundChannel::OutboundChannel(std::function<bool(const OutboundMessage&)> send) :
+		m_send(std::move(send)),
+		m_queue(std::make_unique<OutboundQueue>())
+	{
+	}
+
+	void OutboundChannel::Queue(OutboundMessage&& message)
+	{
+		IpcMetrics& metrics = IpcMetrics::GetInstance();
+
+		// once something is held back, newer messages queue up behind it to keep the order
+		if (m_backlog.empty() && m_queue->TryPush(std::move(message)))
+		{
+			metrics.RecordOutboundDepth(m_queue->ApproximateSize());
+			return;
+		}
+
+		switch (message.Policy)
+		{
+			case OutboundPolicy::Drop:
+				metrics.OutboundDropped++;
+				return;
+			case OutboundPolicy::Coalesce:
+			{
+				auto it = std::find_if(m_backlog.begin(), m_backlog.end(), [&](const OutboundMessage& m)
+				{
+					return m.Policy == OutboundPolicy::Coalesce && m.Key == message.Key;
+				});
+				if (it != m_backlog.end())
+				{
+					it->Data = std::move(message.Data);
+					metrics.OutboundCoalesced++;
+					return;
+				}
+				break;
+			}
+			case OutboundPolicy::Retry:
+				break;
+		}
+
+		m_backlog.push_back(std::move(message));
+		if (m_backlog.size() > OUTBOUND_BACKLOG_CAPACITY)
+		{
+			m_backlog.pop_front(); // the client hasn't been reading for a while
+			metrics.OutboundDropped++;
+		}
+		metrics.RecordOutboundDepth(m_queue->ApproximateSize() + m_backlog.size());
+	}
+
+	void OutboundChannel::FlushBacklog()
+	{
+		while (!m_backlog.empty() && m_queue->TryPush(std::move(m_backlog.front())))
+		{
+			m_backlog.pop_front();
+		}
+	}
+
+	void OutboundChannel::Drain()
+	{
+		// A message the client can't take yet stays at the head and is retried on the next pass. The queue
+		// behind it fills up, so Queue's per-type policies decide what gives way, not this loop.
+		if (m_pending)
+		{
+			if (!m_send(*m_pending))
+				return;
+			m_pending.reset();
+		}
+
+		OutboundMessage message;
+		while (m_queue->TryPop(message))
+		{
+			if (!m_send(message))
+			{
+				m_pending = std::move(message);
+				return;
+			}
+		}
+	}
+
+	void OutboundChannel::Close()
+	{
+		Drain();
+		if (!m_pending)
+		{
+			for (const auto& message : m_backlog)
+			{
+				if (!m_send(message))
+					break; // the client isn't reading; nobody is left to retry
+			}
+		}
+		m_pending.reset();
+		m_backlog.clear();
+	}
+}
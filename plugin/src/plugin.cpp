@@ -16,8 +16,10 @@
  * along with this program. If not, see http://www.gnu.org/licenses/.
 */
 
+#include "aircraft_store.h"
 #include "config.h"
 #include "plugin.h"
+#include "terrain_cache.h"
 #include "xpilot.h"
 
 #include "XPMPMultiplayer.h"
@@ -175,6 +177,7 @@ PLUGIN_API void XPluginStop(void)
 		XPLMUnregisterCommandHandler(ContactAtcCommand, ContactAtcCommandHandler, 0, 0);
 		XPLMUnregisterCommandHandler(ToggleDefaultAtisCommand, ToggleDefaultAtisCommandHandler, 0, 0);
 		XPLMUnregisterCommandHandler(ToggleTcasCommand, ToggleTcasCommandHandler, 0, 0);
+		XPLMUnregisterCommandHandler(ToggleDebugWindowCommand, ToggleDebugWindowCommandHandler, 0, 0);
 	}
 	catch (const std::exception& e)
 	{
@@ -187,7 +190,11 @@ PLUGIN_API void XPluginStop(void)
 
 PLUGIN_API void XPluginReceiveMessage(XPLMPluginID from, int msg, void* inParam)
 {
-
+	if (msg == XPLM_MSG_SCENERY_LOADED)
+	{
+		xpilot::TerrainCache::GetInstance().Invalidate();
+		xpilot::AircraftStore::GetInstance().ThawAll();
+	}
 }
 
 int ContactAtcCommandHandler(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void* inRefcon)
@@ -297,6 +304,15 @@ int ToggleAircraftLabelsCommandHandler(XPLMCommandRef inCommand, XPLMCommandPhas
 	return 0;
 }
 
+int ToggleDebugWindowCommandHandler(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void* inRefcon)
+{
+	if (inPhase == xplm_CommandEnd)
+	{
+		environment->ToggleDebugWindow();
+	}
+	return 0;
+}
+
 void MenuHandler(void* mRef, void* iRef)
 {
 	if (!strcmp((const char*)iRef, "Settings"))
@@ -331,6 +347,9 @@ void RegisterMenuItems()
 	ToggleAircraftLabelsCommand = XPLMCreateCommand("xpilot/toggle_aircraft_labels", "xPilot: Toggle Aircraft Labels");
 	XPLMRegisterCommandHandler(ToggleAircraftLabelsCommand, ToggleAircraftLabelsCommandHandler, 1, (void*)0);
 
+	ToggleDebugWindowCommand = XPLMCreateCommand("xpilot/toggle_diagnostics", "xPilot: Toggle Diagnostics Window");
+	XPLMRegisterCommandHandler(ToggleDebugWindowCommand, ToggleDebugWindowCommandHandler, 1, (void*)0);
+
 	XPLMRegisterCommandHandler(ContactAtcCommand, ContactAtcCommandHandler, 1, (void*)0);
 
 	PluginMenuIdx = XPLMAppendMenuItem(XPLMFindPluginsMenu(), "xPilot", nullptr, 0);
@@ -343,6 +362,7 @@ void RegisterMenuItems()
 	MenuDefaultAtis = XPLMAppendMenuItemWithCommand(PluginMenu, "Default ATIS", ToggleDefaultAtisCommand);
 	MenuToggleTcas = XPLMAppendMenuItemWithCommand(PluginMenu, "TCAS", ToggleTcasCommand);
 	MenuToggleAircraftLabels = XPLMAppendMenuItemWithCommand(PluginMenu, "Aircraft Labels", ToggleAircraftLabelsCommand);
+	MenuDebugWindow = XPLMAppendMenuItemWithCommand(PluginMenu, "Diagnostics", ToggleDebugWindowCommand);
 }
 
 void UpdateMenuItems()
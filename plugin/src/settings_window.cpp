@@ -36,6 +36,11 @@ namespace xpilot
 	static int aircraftLabelType = (int)AircraftLabelType::Callsign;
 	static int labelMaxDistance = 3;
 	static bool labelVisibilityCutoff = true;
+	static int lodNearDistance = 2;
+	static int lodFarDistance = 10;
+	static int trafficFrameBudget = 5;
+	static int governorAircraftLimit = 50;
+	static int consoleHistoryLimit = 500;
 	static bool enableTransmitIndicator = false;
 	static bool enableAircraftSounds = true;
 	static int aircraftSoundVolume = 50;
@@ -86,6 +91,11 @@ namespace xpilot
 		overrideContactAtcCommand = xpilot::Config::GetInstance().GetOverrideContactAtcCommand();
 		labelMaxDistance = xpilot::Config::GetInstance().GetMaxLabelDistance();
 		labelVisibilityCutoff = xpilot::Config::GetInstance().GetLabelCutoffVis();
+		lodNearDistance = xpilot::Config::GetInstance().GetLodNearDistance();
+		lodFarDistance = xpilot::Config::GetInstance().GetLodFarDistance();
+		trafficFrameBudget = xpilot::Config::GetInstance().GetTrafficFrameBudget();
+		governorAircraftLimit = xpilot::Config::GetInstance().GetGovernorAircraftLimit();
+		consoleHistoryLimit = xpilot::Config::GetInstance().GetConsoleHistoryLimit();
 		logLevel = xpilot::Config::GetInstance().GetLogLevel();
 		enableTransmitIndicator = xpilot::Config::GetInstance().GetTransmitIndicatorEnabled();
 		enableAircraftSounds = xpilot::Config::GetInstance().GetAircraftSoundsEnabled();
@@ -109,6 +119,7 @@ namespace xpilot
 
 	void Save()
 	{
+		AircraftStore::GetInstance().ThawAll(); // pick up label and colour changes
 		if (!xpilot::Config::GetInstance().SaveConfig())
 		{
 			ImGui::OpenPopup("Error Saving Settings");
@@ -207,6 +218,19 @@ namespace xpilot
 						Save();
 					}
 
+					ImGui::TableNextRow();
+					ImGui::TableSetColumnIndex(0);
+					ImGui::AlignTextToFramePadding();
+					ImGui::Text("Text Console History Length");
+					ImGui::SameLine();
+					ImGui::ButtonIcon(ICON_FA_QUESTION_CIRCLE, "Number of messages kept in each text message console tab. Older messages are discarded once the limit is reached.");
+					ImGui::TableSetColumnIndex(1);
+					if (ImGui::SliderInt("##ConsoleHistoryLimit", &consoleHistoryLimit, 100, 2000))
+					{
+						xpilot::Config::GetInstance().SetConsoleHistoryLimit(consoleHistoryLimit);
+						Save();
+					}
+
 					ImGui::TableNextRow();
 					ImGui::TableSetColumnIndex(0);
 					ImGui::AlignTextToFramePadding();
@@ -322,6 +346,60 @@ namespace xpilot
 						Save();
 					}
 
+					ImGui::TableNextRow();
+					ImGui::TableSetColumnIndex(0);
+					ImGui::AlignTextToFramePadding();
+					ImGui::Text("Full Animation Distance");
+					ImGui::SameLine();
+					ImGui::ButtonIcon(ICON_FA_QUESTION_CIRCLE, "Aircraft closer than this (in nautical miles) animate gear, flaps, engines and tires every frame.\n\nBeyond it they are animated at a reduced rate.");
+					ImGui::TableSetColumnIndex(1);
+					if (ImGui::SliderInt("##LodNearDist", &lodNearDistance, 1, 20, "%d nm"))
+					{
+						lodFarDistance = std::max(lodFarDistance, lodNearDistance + 1);
+						xpilot::Config::GetInstance().SetLodNearDistance(lodNearDistance);
+						xpilot::Config::GetInstance().SetLodFarDistance(lodFarDistance);
+						Save();
+					}
+
+					ImGui::TableNextRow();
+					ImGui::TableSetColumnIndex(0);
+					ImGui::AlignTextToFramePadding();
+					ImGui::Text("Reduced Animation Distance");
+					ImGui::SameLine();
+					ImGui::ButtonIcon(ICON_FA_QUESTION_CIRCLE, "Aircraft farther away than this (in nautical miles) only update their position and attitude, at a reduced rate.");
+					ImGui::TableSetColumnIndex(1);
+					if (ImGui::SliderInt("##LodFarDist", &lodFarDistance, lodNearDistance + 1, 40, "%d nm"))
+					{
+						xpilot::Config::GetInstance().SetLodFarDistance(lodFarDistance);
+						Save();
+					}
+
+					ImGui::TableNextRow();
+					ImGui::TableSetColumnIndex(0);
+					ImGui::AlignTextToFramePadding();
+					ImGui::Text("Traffic Frame Budget");
+					ImGui::SameLine();
+					ImGui::ButtonIcon(ICON_FA_QUESTION_CIRCLE, "Time per frame (in milliseconds) xPilot may spend on network aircraft.\n\nWhen traffic takes longer, or the frame rate gets close to the automatic disconnect, xPilot step by step updates distant aircraft less often, probes terrain less often, shortens labels, mutes distant aircraft and finally only draws the nearest aircraft. Quality is restored when there is headroom again.\n\nSet to 0 to turn this off.");
+					ImGui::TableSetColumnIndex(1);
+					if (ImGui::SliderInt("##TrafficFrameBudget", &trafficFrameBudget, 0, 20, trafficFrameBudget == 0 ? "Off" : "%d ms"))
+					{
+						xpilot::Config::GetInstance().SetTrafficFrameBudget(trafficFrameBudget);
+						Save();
+					}
+
+					ImGui::TableNextRow();
+					ImGui::TableSetColumnIndex(0);
+					ImGui::AlignTextToFramePadding();
+					ImGui::Text("Aircraft Drawn When Overloaded");
+					ImGui::SameLine();
+					ImGui::ButtonIcon(ICON_FA_QUESTION_CIRCLE, "Number of nearest aircraft still drawn once everything else has been reduced to stay within the traffic frame budget.\n\nAircraft that are not drawn still show on TCAS.");
+					ImGui::TableSetColumnIndex(1);
+					if (ImGui::SliderInt("##GovernorAircraftLimit", &governorAircraftLimit, 10, 200))
+					{
+						xpilot::Config::GetInstance().SetGovernorAircraftLimit(governorAircraftLimit);
+						Save();
+					}
+
 					ImGui::TableNextRow();
 					ImGui::TableSetColumnIndex(0);
 					ImGui::AlignTextToFramePadding();
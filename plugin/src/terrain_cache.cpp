@@ -0,0 +1,113 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "terrain_cache.h"
+#include "utilities.h"
+
+namespace xpilot
+{
+	TerrainCache& TerrainCache::GetInstance()
+	{
+		static TerrainCache cache;
+		return cache;
+	}
+
+	double TerrainCache::GetTerrainElevation(double degLat, double degLon)
+	{
+		const int64_t now = PrecisionTimestamp();
+
+		const double latCell = degLat / TERRAIN_CACHE_CELL_SIZE;
+		const double lonCell = degLon / TERRAIN_CACHE_CELL_SIZE;
+		const double latFloor = std::floor(latCell);
+		const double lonFloor = std::floor(lonCell);
+		const double fy = latCell - latFloor;
+		const double fx = lonCell - lonFloor;
+		const auto latIndex = static_cast<int64_t>(latFloor);
+		const auto lonIndex = static_cast<int64_t>(lonFloor);
+
+		const double sw = GetCornerElevation(latIndex, lonIndex, now);
+		const double se = GetCornerElevation(latIndex, lonIndex + 1, now);
+		const double nw = GetCornerElevation(latIndex + 1, lonIndex, now);
+		const double ne = GetCornerElevation(latIndex + 1, lonIndex + 1, now);
+
+		const double south = sw + (se - sw) * fx;
+		const double north = nw + (ne - nw) * fx;
+		return south + (north - south) * fy;
+	}
+
+	double TerrainCache::GetCornerElevation(int64_t latIndex, int64_t lonIndex, int64_t now)
+	{
+		const uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(latIndex)) << 32) | static_cast<uint32_t>(lonIndex);
+
+		auto it = m_samples.find(key);
+		if (it != m_samples.end())
+		{
+			it->second.LastUsed = now;
+			return it->second.Elevation;
+		}
+
+		const double elevation = GetProbe().GetTerrainElevation(latIndex * TERRAIN_CACHE_CELL_SIZE, lonIndex * TERRAIN_CACHE_CELL_SIZE);
+		m_samples.emplace(key, Sample{ elevation, now });
+		return elevation;
+	}
+
+	double TerrainCache::ProbeTerrainElevation(double degLat, double degLon)
+	{
+		return GetProbe().GetTerrainElevation(degLat, degLon);
+	}
+
+	TerrainProbe& TerrainCache::GetProbe()
+	{
+		if (!m_probe)
+		{
+			m_probe = std::make_unique<TerrainProbe>();
+		}
+		return *m_probe;
+	}
+
+	void TerrainCache::Invalidate()
+	{
+		m_samples.clear();
+	}
+
+	void TerrainCache::Sweep()
+	{
+		const int64_t now = PrecisionTimestamp();
+		if (now - m_lastSweep < TERRAIN_CACHE_SWEEP_INTERVAL)
+			return;
+		m_lastSweep = now;
+
+		for (auto it = m_samples.begin(); it != m_samples.end();)
+		{
+			if (now - it->second.LastUsed > TERRAIN_CACHE_SAMPLE_LIFETIME)
+			{
+				it = m_samples.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+
+	void TerrainCache::Shutdown()
+	{
+		m_samples.clear();
+		m_probe.reset();
+	}
+}
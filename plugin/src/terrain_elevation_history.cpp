@@ -0,0 +1,71 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "terrain_elevation_history.h"
+#include "geo_calc.hpp"
+
+namespace xpilot
+{
+	void TerrainElevationHistory::Trim(double currentTimestamp)
+	{
+		// samples arrive in timestamp order, so expired ones are always at the front
+		while (!m_samples.Empty() &&
+			m_samples.Front().Timestamp < (currentTimestamp - TERRAIN_ELEVATION_DATA_USABLE_AGE + 250))
+		{
+			m_samples.PopFront();
+		}
+	}
+
+	void TerrainElevationHistory::Record(const TerrainElevationData& sample)
+	{
+		m_samples.PushBack(sample);
+	}
+
+	bool TerrainElevationHistory::IsUsable() const
+	{
+		if (m_samples.Size() < 2)
+		{
+			return false;
+		}
+
+		const TerrainElevationData& startSample = m_samples.Front();
+		const TerrainElevationData& endSample = m_samples.Back();
+		if ((endSample.Timestamp - startSample.Timestamp) < TERRAIN_ELEVATION_DATA_USABLE_AGE)
+		{
+			return false;
+		}
+
+		double distance = DegreesToFeet(GreatCircleDistance(
+			startSample.Location.Longitude, startSample.Location.Latitude,
+			endSample.Location.Longitude, endSample.Location.Latitude));
+		double remoteElevationDelta = abs(startSample.RemoteValue - endSample.RemoteValue);
+		double localElevationDelta = abs(startSample.LocalValue - endSample.LocalValue);
+		double remoteSlope = RadiansToDegrees(atan(remoteElevationDelta / distance));
+		if (remoteSlope > TERRAIN_ELEVATION_MAX_SLOPE)
+		{
+			return false;
+		}
+		double localSlope = RadiansToDegrees(atan(localElevationDelta / distance));
+		if (localSlope > TERRAIN_ELEVATION_MAX_SLOPE)
+		{
+			return false;
+		}
+
+		return true;
+	}
+}
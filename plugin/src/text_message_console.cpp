@@ -16,13 +16,14 @@
  * along with this program. If not, see http://www.gnu.org/licenses/.
 */
 
+#include "config.h"
 #include "text_message_console.h"
 #include "xpilot.h"
 
 namespace xpilot
 {
 	static std::string m_inputValue;
-	static std::list<ConsoleMessage> m_messageHistory;
+	static ConsoleHistory m_messageHistory;
 	static std::list<Tab> m_tabs;
 
 	enum class CommandOptions
@@ -58,6 +59,127 @@ namespace xpilot
 		return xpilot::CommandOptions::None;
 	}
 
+	void ConsoleHistory::Add(const std::string& message, const rgb& color)
+	{
+		const size_t limit = std::max<size_t>(1, std::min<size_t>(Config::GetInstance().GetConsoleHistoryLimit(), CONSOLE_HISTORY_CAPACITY));
+		while (m_messages.size() >= limit)
+		{
+			const uint64_t evicted = m_messages.front().GetSequence();
+			m_messages.pop_front();
+			while (!m_lines.empty() && m_lines.front().Message == evicted)
+			{
+				m_lines.pop_front();
+			}
+			if (m_laidOut > 0)
+			{
+				m_laidOut--;
+			}
+		}
+
+		ConsoleMessage m;
+		m.SetMessage(message);
+		m.SetColor(color);
+		m.SetSequence(m_nextSequence++);
+		m_messages.push_back(std::move(m));
+	}
+
+	void ConsoleHistory::Clear()
+	{
+		m_messages.clear();
+		m_lines.clear();
+		m_laidOut = 0;
+	}
+
+	void ConsoleHistory::Layout(const ConsoleMessage& message, float wrapWidth)
+	{
+		const std::string& text = message.GetMessage();
+		const char* begin = text.c_str();
+		const char* end = begin + text.size();
+
+		if (wrapWidth <= 0.0f || text.empty())
+		{
+			m_lines.push_back({ message.GetSequence(), 0, (uint32_t)text.size() });
+			return;
+		}
+
+		ImFont* font = ImGui::GetFont();
+		const float scale = ImGui::GetFontSize() / font->FontSize;
+		const char* s = begin;
+		while (s < end)
+		{
+			const char* eol = font->CalcWordWrapPositionA(scale, s, end, wrapWidth);
+			if (eol == s)
+			{
+				eol++; // always make progress, even if a single glyph does not fit
+			}
+			const char* lineEnd = eol;
+			for (const char* c = s; c < eol; c++)
+			{
+				if (*c == '\n')
+				{
+					lineEnd = c;
+					eol = c;
+					break;
+				}
+			}
+			m_lines.push_back({ message.GetSequence(), (uint32_t)(s - begin), (uint32_t)(lineEnd - begin) });
+
+			// same rules as ImGui's own wrapping: drop the blanks the line broke on
+			s = eol;
+			while (s < end && (*s == ' ' || *s == '\t'))
+			{
+				s++;
+			}
+			if (s < end && *s == '\n')
+			{
+				s++;
+			}
+		}
+	}
+
+	void ConsoleHistory::Render(bool scrollToBottom)
+	{
+		const float wrapWidth = ImGui::GetContentRegionAvail().x;
+		if (wrapWidth != m_wrapWidth)
+		{
+			m_lines.clear();
+			m_laidOut = 0;
+			m_wrapWidth = wrapWidth;
+		}
+
+		for (; m_laidOut < m_messages.size(); m_laidOut++)
+		{
+			Layout(m_messages[m_laidOut], wrapWidth);
+		}
+
+		if (!m_messages.empty())
+		{
+			const uint64_t firstSequence = m_messages.front().GetSequence();
+
+			ImGuiListClipper clipper;
+			clipper.Begin((int)m_lines.size());
+			while (clipper.Step())
+			{
+				for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+				{
+					const ConsoleLine& line = m_lines[i];
+					const ConsoleMessage& message = m_messages[(size_t)(line.Message - firstSequence)];
+					const char* text = message.GetMessage().c_str();
+
+					ImGui::PushStyleColor(ImGuiCol_Text, message.GetColor());
+					ImGui::TextUnformatted(text + line.Start, text + line.End);
+					ImGui::PopStyleColor();
+				}
+			}
+			clipper.End();
+		}
+
+		if (scrollToBottom)
+		{
+			ImGui::SetScrollHereY(1.0f);
+		}
+	}
+
 	TextMessageConsole::TextMessageConsole(XPilot* instance) :
 		XPImgWindow(WND_MODE_FLOAT_CENTERED, WND_STYLE_SOLID, WndRect(0, 200, 600, 0)),
 		m_scrollToBottom(false),
@@ -80,28 +202,18 @@ namespace xpilot
 		if (message.empty())
 			return;
 
-		ConsoleMessage m;
-		m.SetMessage(string_format("[%s] %s", UtcTimestamp().c_str(), message.c_str()));
-		m.SetColor(color);
-		m_messageHistory.push_back(m);
+		m_messageHistory.Add(string_format("[%s] %s", UtcTimestamp().c_str(), message.c_str()), color);
 		m_scrollToBottom = true;
 	}
 
 	void TextMessageConsole::ShowErrorMessage(std::string error)
 	{
-		ConsoleMessage m;
-		m.SetMessage(string_format("[%s] %s", UtcTimestamp().c_str(), error.c_str()));
-		m.SetColor(Colors::Red);
-		m_messageHistory.push_back(m);
+		m_messageHistory.Add(string_format("[%s] %s", UtcTimestamp().c_str(), error.c_str()), Colors::Red);
 		m_scrollToBottom = true;
 	}
 
 	void TextMessageConsole::PrivateMessageError(std::string tabName, std::string error)
 	{
-		ConsoleMessage m;
-		m.SetMessage(string_format("[%s] %s", UtcTimestamp().c_str(), error.c_str()));
-		m.SetColor(Colors::Red);
-
 		auto it = std::find_if(m_tabs.begin(), m_tabs.end(), [&tabName](const Tab& t)
 		{
 			return t.tabName == tabName;
@@ -109,6 +221,7 @@ namespace xpilot
 
 		if (it != m_tabs.end())
 		{
+			it->messageHistory.Add(string_format("[%s] %s", UtcTimestamp().c_str(), error.c_str()), Colors::Red);
 			it->scrollToBottom = true;
 		}
 	}
@@ -142,11 +255,10 @@ namespace xpilot
 
 		if (it == m_tabs.end())
 		{
-			Tab tab;
+			Tab& tab = m_tabs.emplace_back();
 			tab.tabName = tabName;
 			tab.isOpen = true;
-			tab.messageHistory = std::list<ConsoleMessage>();
-			m_tabs.push_back(tab);
+			tab.scrollToBottom = false;
 		}
 	}
 
@@ -156,10 +268,6 @@ namespace xpilot
 		{
 			case ConsoleTabType::Sent:
 			{
-				ConsoleMessage m;
-				m.SetMessage(string_format("[%s] %s: %s", UtcTimestamp().c_str(), m_env->NetworkCallsign().c_str(), message.c_str()));
-				m.SetColor(Colors::Gray);
-
 				auto it = std::find_if(m_tabs.begin(), m_tabs.end(), [&recipient](const Tab& t)
 				{
 					return t.tabName == recipient;
@@ -167,7 +275,7 @@ namespace xpilot
 
 				if (it != m_tabs.end())
 				{
-					it->messageHistory.push_back(m);
+					it->messageHistory.Add(string_format("[%s] %s: %s", UtcTimestamp().c_str(), m_env->NetworkCallsign().c_str(), message.c_str()), Colors::Gray);
 					it->scrollToBottom = true;
 				}
 				else
@@ -179,10 +287,6 @@ namespace xpilot
 			break;
 			case ConsoleTabType::Received:
 			{
-				ConsoleMessage m;
-				m.SetMessage(string_format("[%s] %s: %s", UtcTimestamp().c_str(), recipient.c_str(), message.c_str()));
-				m.SetColor(Colors::Cyan);
-
 				auto it = find_if(m_tabs.begin(), m_tabs.end(), [&recipient](const Tab& t)
 				{
 					return t.tabName == recipient;
@@ -190,7 +294,7 @@ namespace xpilot
 
 				if (it != m_tabs.end())
 				{
-					it->messageHistory.push_back(m);
+					it->messageHistory.Add(string_format("[%s] %s: %s", UtcTimestamp().c_str(), recipient.c_str(), message.c_str()), Colors::Cyan);
 					it->scrollToBottom = true;
 				}
 				else
@@ -213,17 +317,8 @@ namespace xpilot
 			{
 				ImGui::BeginChild("##Messages", ImVec2(0, -ImGui::GetFrameHeightWithSpacing()), false);
 				{
-					for (auto& e : m_messageHistory)
-					{
-						ImGui::PushStyleColor(ImGuiCol_Text, e.GetColor());
-						ImGui::TextWrapped("%s", e.GetMessage().c_str());
-						ImGui::PopStyleColor();
-					}
-					if (m_scrollToBottom)
-					{
-						ImGui::SetScrollHereY(1.0f);
-						m_scrollToBottom = false;
-					}
+					m_messageHistory.Render(m_scrollToBottom);
+					m_scrollToBottom = false;
 				}
 				ImGui::EndChild();
 				ImGui::PushItemWidth(-1.0f);
@@ -430,7 +525,7 @@ namespace xpilot
 									}
 									break;
 								case xpilot::CommandOptions::Clear:
-									m_messageHistory.clear();
+									m_messageHistory.Clear();
 									m_inputValue = "";
 									break;
 								case xpilot::CommandOptions::CloseAll:
@@ -474,17 +569,8 @@ namespace xpilot
 					{
 						ImGui::BeginChild(key.c_str(), ImVec2(0, -ImGui::GetFrameHeightWithSpacing()), false);
 						{
-							for (auto& e : it->messageHistory)
-							{
-								ImGui::PushStyleColor(ImGuiCol_Text, e.GetColor());
-								ImGui::TextWrapped("%s", e.GetMessage().c_str());
-								ImGui::PopStyleColor();
-							}
-							if (it->scrollToBottom)
-							{
-								ImGui::SetScrollHereY(1.0f);
-								it->scrollToBottom = false;
-							}
+							it->messageHistory.Render(it->scrollToBottom);
+							it->scrollToBottom = false;
 						}
 						ImGui::EndChild();
 						ImGui::PushID(key.c_str());
@@ -501,7 +587,7 @@ namespace xpilot
 									{
 										case xpilot::CommandOptions::Clear:
 										{
-											it->messageHistory.clear();
+											it->messageHistory.Clear();
 											it->textInput = "";
 										}
 										break;
@@ -0,0 +1,201 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "config.h"
+#include "frame_profiler.h"
+#include "traffic_governor.h"
+#include "utilities.h"
+
+#include "XPMPMultiplayer.h"
+
+namespace xpilot
+{
+	TrafficGovernor::TrafficGovernor() :
+		m_levelDataRef("xpilot/governor/level", ReadOnly),
+		m_trafficMsDataRef("xpilot/governor/traffic_ms", ReadOnly),
+		m_budgetMsDataRef("xpilot/governor/budget_ms", ReadOnly),
+		m_culledDataRef("xpilot/governor/culled_aircraft", ReadOnly),
+		m_reasonDataRef("xpilot/governor/reason", ReadOnly)
+	{
+	}
+
+	TrafficGovernor::~TrafficGovernor()
+	{
+		AircraftStore::GetInstance().SetTrafficQuality(TrafficQuality::Full);
+		AircraftStore::GetInstance().ClearCulled();
+	}
+
+	bool TrafficGovernor::IsEnabled() const
+	{
+		return Config::GetInstance().GetTrafficFrameBudget() > 0;
+	}
+
+	void TrafficGovernor::Update(float frameRatePeriod)
+	{
+		const int64_t trafficUs = FrameProfiler::GetInstance().TakeFrameTotal();
+		const int budget = Config::GetInstance().GetTrafficFrameBudget();
+		m_budgetMsDataRef = static_cast<float>(budget);
+
+		if (budget <= 0)
+		{
+			if (m_quality != TrafficQuality::Full)
+			{
+				SetQuality(TrafficQuality::Full, "traffic frame budget turned off");
+			}
+			m_windowFrames = 0;
+			return;
+		}
+
+		const int64_t now = PrecisionTimestamp();
+		if (m_windowFrames == 0)
+		{
+			m_windowStart = now;
+			m_windowTrafficUs = 0;
+			m_windowFrameTime = 0.0;
+		}
+		m_windowTrafficUs += trafficUs;
+		m_windowFrameTime += frameRatePeriod;
+		m_windowFrames++;
+
+		if (now - m_windowStart < GOVERNOR_WINDOW)
+			return;
+
+		m_trafficMs = static_cast<float>(m_windowTrafficUs / 1000.0 / m_windowFrames);
+		m_fps = m_windowFrameTime > 0.0 ? static_cast<float>(m_windowFrames / m_windowFrameTime) : 0.0f;
+		m_windowFrames = 0;
+
+		Evaluate(static_cast<float>(budget));
+	}
+
+	void TrafficGovernor::Evaluate(float budgetMs)
+	{
+		AircraftStore& store = AircraftStore::GetInstance();
+
+		if (store.ActiveCount() == 0)
+		{
+			m_overloadedWindows = 0;
+			m_headroomWindows = 0;
+			if (m_quality != TrafficQuality::Full)
+			{
+				SetQuality(TrafficQuality::Full, "no network aircraft");
+			}
+		}
+		else
+		{
+			// a low frame rate is only ours to fix if traffic is a noticeable part of the frame
+			const float frameMs = m_fps > 0.0f ? 1000.0f / m_fps : 0.0f;
+			const bool trafficMatters = m_trafficMs >= frameMs * GOVERNOR_MIN_TRAFFIC_SHARE;
+			const bool overBudget = m_trafficMs > budgetMs;
+			const bool slowFrames = m_fps < GOVERNOR_MIN_FPS && trafficMatters;
+
+			if (overBudget || slowFrames)
+			{
+				m_headroomWindows = 0;
+				m_overloadedWindows++;
+
+				const bool critical = m_fps < GOVERNOR_CRITICAL_FPS && trafficMatters;
+				if ((m_overloadedWindows >= GOVERNOR_SHED_WINDOWS || critical) && m_quality != TrafficQuality::NearestOnly)
+				{
+					m_overloadedWindows = 0;
+
+					// shedding right after a restore means the restore was premature; wait longer next time
+					const bool premature = m_lastRestore > 0 && PrecisionTimestamp() - m_lastRestore < GOVERNOR_RESTORE_BACKOFF;
+					m_restoreWindows = premature ? std::min(m_restoreWindows * 2, GOVERNOR_MAX_RESTORE_WINDOWS) : GOVERNOR_RESTORE_WINDOWS;
+
+					SetQuality(static_cast<TrafficQuality>(static_cast<int>(m_quality) + 1), overBudget
+						? string_format("traffic took %.1f ms per frame, budget is %.0f ms", m_trafficMs, budgetMs)
+						: string_format("%.0f fps with traffic taking %.1f ms per frame", m_fps, m_trafficMs));
+				}
+			}
+			else if (m_trafficMs < budgetMs * GOVERNOR_HEADROOM && m_fps >= GOVERNOR_RESTORE_FPS)
+			{
+				m_overloadedWindows = 0;
+				m_headroomWindows++;
+
+				if (m_headroomWindows >= m_restoreWindows && m_quality != TrafficQuality::Full)
+				{
+					m_headroomWindows = 0;
+					m_lastRestore = PrecisionTimestamp();
+					SetQuality(static_cast<TrafficQuality>(static_cast<int>(m_quality) - 1),
+						string_format("headroom, traffic took %.1f ms per frame at %.0f fps", m_trafficMs, m_fps));
+				}
+			}
+			else
+			{
+				m_overloadedWindows = 0;
+				m_headroomWindows = 0;
+			}
+		}
+
+		if (m_quality == TrafficQuality::NearestOnly)
+		{
+			store.CullBeyondNearest(static_cast<size_t>(Config::GetInstance().GetGovernorAircraftLimit()));
+		}
+		if (m_quality >= TrafficQuality::ReducedLabelsAndSounds)
+		{
+			ApplyLabelDistance(); // the settings window may have changed it
+		}
+
+		m_trafficMsDataRef = m_trafficMs;
+		m_culledDataRef = static_cast<int>(store.CulledCount());
+	}
+
+	void TrafficGovernor::SetQuality(TrafficQuality quality, const std::string& reason)
+	{
+		LOG_MSG(logMSG, "Traffic governor: %s -> %s (%s)", GetName(m_quality), GetName(quality), reason.c_str());
+
+		m_quality = quality;
+		m_reason = reason;
+
+		AircraftStore& store = AircraftStore::GetInstance();
+		store.SetTrafficQuality(quality);
+		if (quality != TrafficQuality::NearestOnly)
+		{
+			store.ClearCulled();
+		}
+		ApplyLabelDistance();
+
+		m_levelDataRef = static_cast<int>(quality);
+		m_reasonDataRef = reason;
+		m_culledDataRef = static_cast<int>(store.CulledCount());
+	}
+
+	void TrafficGovernor::ApplyLabelDistance()
+	{
+		const Config& config = Config::GetInstance();
+		float distance = static_cast<float>(config.GetMaxLabelDistance());
+		if (m_quality >= TrafficQuality::ReducedLabelsAndSounds)
+		{
+			distance = std::min(distance, GOVERNOR_LABEL_DISTANCE);
+		}
+		XPMPSetAircraftLabelDist(distance, config.GetLabelCutoffVis());
+	}
+
+	const char* TrafficGovernor::GetName(TrafficQuality quality)
+	{
+		switch (quality)
+		{
+			case TrafficQuality::Full: return "Full quality";
+			case TrafficQuality::ReducedFarUpdates: return "Reduced far updates";
+			case TrafficQuality::ReducedTerrainProbes: return "Reduced terrain probes";
+			case TrafficQuality::ReducedLabelsAndSounds: return "Reduced labels and sounds";
+			case TrafficQuality::NearestOnly: return "Nearest aircraft only";
+			default: return "";
+		}
+	}
+}
@@ -0,0 +1,117 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "worker_pool.h"
+
+namespace xpilot
+{
+	WorkerPool::WorkerPool(size_t threadCount)
+	{
+		for (size_t i = 0; i < threadCount; i++)
+		{
+			m_threads.emplace_back(&WorkerPool::WorkerLoop, this);
+		}
+	}
+
+	WorkerPool::~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stopping = true;
+		}
+		m_workAvailable.notify_all();
+		for (auto& thread : m_threads)
+		{
+			if (thread.joinable())
+			{
+				thread.join();
+			}
+		}
+	}
+
+	size_t WorkerPool::DefaultThreadCount()
+	{
+		const size_t cores = std::thread::hardware_concurrency();
+		return cores > 2 ? (std::min)(cores - 2, size_t(3)) : 0;
+	}
+
+	void WorkerPool::ParallelFor(size_t count, size_t minChunk, const std::function<void(size_t, size_t)>& fn)
+	{
+		if (count == 0)
+			return;
+
+		const size_t lanes = m_threads.size() + 1;
+		const size_t chunk = (std::max)(minChunk, (count + lanes - 1) / lanes);
+		if (m_threads.empty() || chunk >= count)
+		{
+			fn(0, count);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_job = &fn;
+			m_jobCount = count;
+			m_jobChunk = chunk;
+			m_nextIndex.store(0, std::memory_order_relaxed);
+			m_busyWorkers = m_threads.size();
+			m_generation++;
+		}
+		m_workAvailable.notify_all();
+
+		RunChunks();
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_workDone.wait(lock, [this] { return m_busyWorkers == 0; });
+		m_job = nullptr;
+	}
+
+	void WorkerPool::RunChunks()
+	{
+		for (;;)
+		{
+			const size_t begin = m_nextIndex.fetch_add(m_jobChunk, std::memory_order_relaxed);
+			if (begin >= m_jobCount)
+				return;
+			(*m_job)(begin, (std::min)(begin + m_jobChunk, m_jobCount));
+		}
+	}
+
+	void WorkerPool::WorkerLoop()
+	{
+		uint64_t seenGeneration = 0;
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_workAvailable.wait(lock, [&] { return m_stopping || m_generation != seenGeneration; });
+				if (m_stopping)
+					return;
+				seenGeneration = m_generation;
+			}
+
+			RunChunks();
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_busyWorkers--;
+			}
+			m_workDone.notify_one();
+		}
+	}
+}
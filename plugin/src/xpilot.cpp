@@ -16,20 +16,34 @@
  * along with this program. If not, see http://www.gnu.org/licenses/.
 */
 
+#include "aircraft_command.h"
 #include "aircraft_manager.h"
 #include "config.h"
+#include "debug_window.h"
 #include "frame_rate_monitor.h"
+#include "main_thread_queue.h"
 #include "nearby_atc_window.h"
 #include "network_aircraft.h"
 #include "notification_panel.h"
 #include "plugin.h"
 #include "settings_window.h"
+#include "traffic_governor.h"
 #include "xpilot.h"
 
 #include "XPMPMultiplayer.h"
 
 namespace xpilot
 {
+	const std::string IPC_RECORDING_FILE = "Resources/ipc_recording.bin";
+
+	// only what drives network aircraft is recorded; replaying logins, messages or ATC lists would act on them
+	static bool IsTrafficMessage(const std::string& type)
+	{
+		return type == dto::ADD_AIRCRAFT || type == dto::AIRCRAFT_CONFIG || type == dto::FAST_POSITION_UPDATE
+			|| type == dto::FAST_POSITION_DELTA || type == dto::HEARTBEAT || type == dto::DELETE_AIRCRAFT
+			|| type == dto::DELETE_ALL_AIRCRAFT;
+	}
+
 	XPilot::XPilot() :
 		m_pttPressed("xpilot/ptt", ReadWrite),
 		m_networkLoginStatus("xpilot/login/status", ReadOnly),
@@ -39,6 +53,7 @@ namespace xpilot
 		m_volumeSignalLevel("xpilot/audio/vu", ReadWrite),
 		m_aiControlled("xpilot/ai_controlled", ReadOnly),
 		m_aircraftCount("xpilot/num_aircraft", ReadOnly),
+		m_frozenAircraftCount("xpilot/num_aircraft_frozen", ReadOnly),
 		m_pluginVersion("xpilot/version", ReadOnly),
 		m_selcalCode("xpilot/selcal", ReadOnly),
 		m_selcalReceived("xpilot/selcal_received", ReadWrite),
@@ -48,6 +63,15 @@ namespace xpilot
 		m_com1OnHeadset("xpilot/audio/com1_on_headset", ReadWrite),
 		m_com2OnHeadset("xpilot/audio/com2_on_headset", ReadWrite),
 		m_splitAudioChannels("xpilot/audio/split_audio_channels", ReadWrite),
+		m_ipcMessagesReceived("xpilot/ipc/messages_received", ReadOnly),
+		m_ipcSendFailures("xpilot/ipc/send_failures", ReadOnly),
+		m_ipcClientSendFailures("xpilot/ipc/client_send_failures", ReadOnly),
+		m_ipcMessagesPerSecond("xpilot/ipc/messages_per_sec", ReadOnly),
+		m_ipcQueueDepthPeak("xpilot/ipc/queue_depth_peak", ReadOnly),
+		m_ipcOutboundDropped("xpilot/ipc/outbound_dropped", ReadOnly),
+		m_ipcOutboundDepthPeak("xpilot/ipc/outbound_depth_peak", ReadOnly),
+		m_profilerEnabled("xpilot/profiler/enabled", ReadWrite),
+		m_cslLoadProgress("xpilot/csl/load_progress", ReadOnly),
 		m_xplaneAtisEnabled("sim/atc/atis_enabled", ReadWrite),
 		m_overrideAutoTune("sim/operation/override/override_autotune", ReadWrite),
 		m_frameRatePeriod("sim/operation/misc/frame_rate_period", ReadOnly),
@@ -101,10 +125,24 @@ namespace xpilot
 		m_textMessageConsole = std::make_unique<TextMessageConsole>(this);
 		m_nearbyAtcWindow = std::make_unique<NearbyAtcWindow>(this);
 		m_settingsWindow = std::make_unique<SettingsWindow>();
+		m_debugWindow = std::make_unique<DebugWindow>(this);
 		m_frameRateMonitor = std::make_unique<FrameRateMonitor>(this);
+		m_trafficGovernor = std::make_unique<TrafficGovernor>();
 		m_aircraftManager = std::make_unique<AircraftManager>(this);
+		m_mainThreadQueue = std::make_unique<MainThreadQueue>([this](const AircraftCommand& command) { DispatchCommand(command); });
+		m_outbound = std::make_unique<OutboundChannel>([this](const OutboundMessage& message) { return SendOutbound(message); });
 		m_pluginVersion = PLUGIN_VERSION;
 
+		for (size_t i = 0; i < static_cast<size_t>(IpcLatency::Count); i++)
+		{
+			m_ipcLatencyDataRefs.push_back(std::make_unique<LatencyDataRefs>(IpcMetrics::GetDataRefName(static_cast<IpcLatency>(i))));
+		}
+
+		for (size_t i = 0; i < static_cast<size_t>(FrameSection::Count); i++)
+		{
+			m_frameProfileDataRefs.push_back(std::make_unique<LatencyDataRefs>(FrameProfiler::GetDataRefName(static_cast<FrameSection>(i))));
+		}
+
 		XPLMRegisterFlightLoopCallback(DeferredStartup, -1.0f, this);
 	}
 
@@ -114,6 +152,7 @@ namespace xpilot
 		XPLMUnregisterDataAccessor(m_bulkDataExpensive);
 		XPLMUnregisterFlightLoopCallback(DeferredStartup, this);
 		XPLMUnregisterFlightLoopCallback(MainFlightLoop, this);
+		FrameProfiler::GetInstance().SetEnabled(false);
 	}
 
 	void XPilot::Initialize()
@@ -134,6 +173,11 @@ namespace xpilot
 
 		nng_setopt_int(m_socket, NNG_OPT_RECVBUF, 8192);
 		nng_setopt_int(m_socket, NNG_OPT_SENDBUF, 8192);
+		nng_setopt_ms(m_socket, NNG_OPT_RECVTIMEO, IPC_REPLAY_POLL_INTERVAL);
+
+		// delta frames only make sense against keyframes from the same connection
+		nng_pipe_notify(m_socket, NNG_PIPE_EV_ADD_POST, &XPilot::PipeEvent, this);
+		nng_pipe_notify(m_socket, NNG_PIPE_EV_REM_POST, &XPilot::PipeEvent, this);
 
 		std::string url = "ipc:///tmp//xpilot.ipc";
 		if (Config::GetInstance().GetUseTcpSocket() && Config::GetInstance().GetTcpPort() > 0)
@@ -158,15 +202,19 @@ namespace xpilot
 		SendDto(dto);
 
 		m_keepSocketAlive = false;
+		m_ipcRecording.StopRecording();
 
-		nng_close(m_socket);
-		m_socket = NNG_SOCKET_INITIALIZER;
-		nng_fini();
-
+		// the receive timeout lets the worker notice; then whatever is still queued goes out from here
 		if (m_socketThread)
 		{
 			m_socketThread->join();
+			m_socketThread.reset();
 		}
+		m_outbound->Close();
+
+		nng_close(m_socket);
+		m_socket = NNG_SOCKET_INITIALIZER;
+		nng_fini();
 	}
 
 	int CBIntPrefsFunc(const char*, [[maybe_unused]] const char* item, int defaultVal)
@@ -213,24 +261,21 @@ namespace xpilot
 		}
 		else
 		{
+			std::vector<std::string> packagePaths;
 			for (const CslPackage& p : Config::GetInstance().GetCSLPackages())
 			{
 				if (!p.path.empty() && p.enabled && CountFilesInPath(p.path) > 0)
 				{
-					try
-					{
-						err = XPMPLoadCSLPackage(p.path.c_str());
-						if (*err)
-						{
-							LOG_MSG(logERROR, "Error loading CSL package %s: %s", p.path.c_str(), err);
-						}
-					}
-					catch (std::exception& e)
-					{
-						LOG_MSG(logERROR, "Error loading CSL package %s: %s", p.path.c_str(), err);
-					}
+					packagePaths.push_back(p.path);
 				}
 			}
+			m_cslLoader.Start(std::move(packagePaths));
+		}
+
+		if (!m_cslLoader.IsStarted())
+		{
+			m_cslLoadProgress = 1.0f;
+			m_aircraftManager->SetModelsReady();
 		}
 
 		XPMPEnableAircraftLabels(Config::GetInstance().GetShowHideLabels());
@@ -240,6 +285,30 @@ namespace xpilot
 		return true;
 	}
 
+	void XPilot::PollCslLoader()
+	{
+		if (m_aircraftManager->AreModelsReady() || !m_cslLoader.IsStarted())
+			return;
+
+		m_cslLoadProgress = m_cslLoader.GetProgress();
+		if (m_cslLoader.IsFinished())
+		{
+			m_cslLoader.Commit();
+			m_aircraftManager->SetModelsReady();
+			if (m_cslValidationPending)
+			{
+				m_cslValidationPending = false;
+				SendCslValidation();
+			}
+		}
+	}
+
+	void XPilot::SendCslValidation()
+	{
+		ValidateCslDto dto{ XPMPGetNumberOfInstalledModels() > 0 };
+		SendDto(dto);
+	}
+
 	float XPilot::DeferredStartup(float, float, int, void* ref)
 	{
 		auto* instance = static_cast<XPilot*>(ref);
@@ -253,9 +322,21 @@ namespace xpilot
 		auto* instance = static_cast<XPilot*>(ref);
 		if (instance)
 		{
-			instance->InvokeQueuedCallbacks();
+			// profiling runs while the diagnostics window is open, another plugin asks for it or the governor needs it
+			instance->m_trafficGovernor->Update(instance->m_frameRatePeriod);
+			FrameProfiler::GetInstance().SetEnabled(instance->m_debugWindow->GetVisible() || instance->m_profilerEnabled != 0
+				|| instance->m_trafficGovernor->IsEnabled() || instance->m_ipcRecording.IsReplaying());
+			{
+				ScopedFrameTimer timer(FrameSection::CommandQueue);
+				instance->m_mainThreadQueue->Invoke();
+			}
+			instance->m_outbound->FlushBacklog();
+			instance->PollCslLoader();
+			instance->PublishIpcMetrics();
+			instance->PublishFrameProfile();
 			instance->m_aiControlled = XPMPHasControlOfAIAircraft();
 			instance->m_aircraftCount = XPMPCountPlanes();
+			instance->m_frozenAircraftCount = static_cast<int>(AircraftStore::GetInstance().FrozenCount());
 			UpdateMenuItems();
 		}
 		return -1.0;
@@ -271,34 +352,81 @@ namespace xpilot
 			int err;
 			err = nng_recv(m_socket, &buffer, &bufferLen, NNG_FLAG_ALLOC);
 
+			// nng reports a new pipe before anything can arrive on it, so this runs ahead of its first message
+			if (m_pipeChanged.exchange(false))
+			{
+				m_positionBaselines.clear();
+			}
+
 			if (err == 0)
 			{
-				BaseDto dto;
-				auto obj = msgpack::unpack(reinterpret_cast<const char*>(buffer), bufferLen);
+				HandleMessage(buffer, bufferLen, true);
+				nng_free(buffer, bufferLen);
+			}
 
-				try
+			// the receive timeout wakes us up to feed a replay while the client is quiet
+			if (m_ipcRecording.IsReplaying())
+			{
+				const bool finished = m_ipcRecording.Replay([this](const char* data, size_t length)
 				{
-					obj.get().convert(dto);
-					ProcessPacket(dto);
+					HandleMessage(data, length, false);
+				});
+				if (finished)
+				{
+					QueueCallback([this] { FinishIpcReplay(); });
 				}
-				catch (const msgpack::type_error& e) {}
+			}
 
-				nng_free(buffer, bufferLen);
+			m_outbound->Drain();
+		}
+	}
+
+	void XPilot::PipeEvent(nng_pipe, nng_pipe_ev, void* arg)
+	{
+		static_cast<XPilot*>(arg)->m_pipeChanged = true;
+	}
+
+	void XPilot::HandleMessage(const char* buffer, size_t length, bool live)
+	{
+		BaseDto dto;
+		auto obj = msgpack::unpack(buffer, length);
+
+		try
+		{
+			obj.get().convert(dto);
+			IpcMetrics::GetInstance().CountMessage(dto.type);
+			if (live && m_ipcRecording.IsRecording() && IsTrafficMessage(dto.type))
+			{
+				m_ipcRecording.Record(buffer, length);
 			}
+			ProcessPacket(dto);
 		}
+		catch (const msgpack::type_error& e) {}
 	}
 
 	void XPilot::ProcessPacket(const BaseDto& packet)
 	{
 		if (packet.type == dto::PLUGIN_VER)
 		{
-			PluginVersionDto dto{ PLUGIN_VERSION };
-			SendDto(dto);
+			QueueCallback([this]
+			{
+				PluginVersionDto dto{ PLUGIN_VERSION, PLUGIN_CAPABILITY_POSITION_DELTAS };
+				SendDto(dto);
+			});
 		}
 		if (packet.type == dto::VALIDATE_CSL)
 		{
-			ValidateCslDto dto{ XPMPGetNumberOfInstalledModels() > 0 };
-			SendDto(dto);
+			QueueCallback([this]
+			{
+				if (m_aircraftManager->AreModelsReady())
+				{
+					SendCslValidation();
+				}
+				else
+				{
+					m_cslValidationPending = true;
+				}
+			});
 		}
 		if (packet.type == dto::ADD_AIRCRAFT)
 		{
@@ -315,10 +443,22 @@ namespace xpilot
 
 			if (!dto.callsign.empty() && !dto.typeCode.empty())
 			{
-				QueueCallback([=]
+				AircraftCommand command;
+				command.Type = AircraftCommandType::AddAircraft;
+				command.VisualState = visualState;
+				if (AircraftCommand::CopyString(command.Callsign, dto.callsign)
+					&& AircraftCommand::CopyString(command.Airline, dto.airline)
+					&& AircraftCommand::CopyString(command.TypeCode, dto.typeCode))
 				{
-					m_aircraftManager->HandleAddPlane(dto.callsign, visualState, dto.airline, dto.typeCode);
-				});
+					QueueCommand(command);
+				}
+				else
+				{
+					QueueCallback([=]
+					{
+						m_aircraftManager->HandleAddPlane(dto.callsign, visualState, dto.airline, dto.typeCode);
+					});
+				}
 			}
 		}
 		if (packet.type == dto::HEARTBEAT)
@@ -326,44 +466,65 @@ namespace xpilot
 			HeartbeatDto dto;
 			packet.dto.convert(dto);
 
-			QueueCallback([=]
+			AircraftCommand command;
+			command.Type = AircraftCommandType::Heartbeat;
+			if (AircraftCommand::CopyString(command.Callsign, dto.callsign))
 			{
-				m_aircraftManager->HandleHeartbeat(dto.callsign);
-			});
+				QueueCommand(command);
+			}
+			else
+			{
+				QueueCallback([=]
+				{
+					m_aircraftManager->HandleHeartbeat(dto.callsign);
+				});
+			}
 		}
 		if (packet.type == dto::FAST_POSITION_UPDATE)
 		{
 			FastPositionUpdateDto dto;
 			packet.dto.convert(dto);
 
-			AircraftVisualState visualState{};
-			visualState.Lat = dto.latitude;
-			visualState.Lon = dto.longitude;
-			visualState.AltitudeTrue = dto.altitudeTrue;
-			visualState.AltitudeAgl = dto.altitudeAgl;
-			visualState.Pitch = dto.pitch;
-			visualState.Bank = dto.bank;
-			visualState.Heading = dto.heading;
-			visualState.NoseWheelAngle = dto.noseWheelAngle;
+			// the send times of a replayed message are from when it was recorded
+			if (dto.ipcSendTime > 0 && !m_ipcRecording.IsReplaying())
+			{
+				// both timestamps are wall clock, so the transit figure is only meaningful
+				// when the client and X-Plane clocks are in sync (always true for local IPC)
+				IpcMetrics& metrics = IpcMetrics::GetInstance();
+				metrics.Record(IpcLatency::Transit, (UnixTimestampMillis() - dto.ipcSendTime) * 1000);
+				if (dto.fsdReceiveTime > 0)
+				{
+					metrics.Record(IpcLatency::ClientHop, (dto.ipcSendTime - dto.fsdReceiveTime) * 1000);
+				}
+				metrics.ClientSendFailures = dto.clientSendFailures;
+			}
 
-			Vector3 positionalVector{};
-			positionalVector.X = dto.vx; // vel lon
-			positionalVector.Y = dto.vy; // vel alt
-			positionalVector.Z = dto.vz; // vel lat
+			// a full frame is also the keyframe for any delta frames that follow (visual machines)
+			m_positionBaselines[dto.callsign] = quantizePosition(dto);
+			QueueFastPositionUpdate(dto);
+		}
+		if (packet.type == dto::FAST_POSITION_DELTA)
+		{
+			FastPositionDeltaDto dto;
+			packet.dto.convert(dto);
 
-			Vector3 rotationalVelocity{};
-			rotationalVelocity.X = dto.vp * -1; // vel pitch
-			rotationalVelocity.Y = dto.vh; // vel heading
-			rotationalVelocity.Z = dto.vb * -1; // vel bank
+			auto baseline = m_positionBaselines.find(dto.callsign);
+			if (baseline == m_positionBaselines.end() || dto.delta.size() != QUANTIZED_POSITION_FIELDS)
+			{
+				// no keyframe yet; the client sends one periodically and after every reconnect
+				IpcMetrics::GetInstance().DeltaFramesDiscarded++;
+				return;
+			}
 
-			if (!dto.callsign.empty())
+			for (size_t i = 0; i < QUANTIZED_POSITION_FIELDS; i++)
 			{
-				QueueCallback([=]
-				{
-					m_aircraftManager->HandleFastPositionUpdate(dto.callsign,
-						visualState, positionalVector, rotationalVelocity, dto.speed);
-				});
+				baseline->second[i] += dto.delta[i];
 			}
+
+			FastPositionUpdateDto position{};
+			position.callsign = dto.callsign;
+			dequantizePosition(baseline->second, position);
+			QueueFastPositionUpdate(position);
 		}
 		if (packet.type == dto::DELETE_AIRCRAFT)
 		{
@@ -372,27 +533,50 @@ namespace xpilot
 
 			if (!dto.callsign.empty())
 			{
-				QueueCallback([=]
+				m_positionBaselines.erase(dto.callsign);
+
+				AircraftCommand command;
+				command.Type = AircraftCommandType::DeleteAircraft;
+				if (AircraftCommand::CopyString(command.Callsign, dto.callsign))
 				{
-					m_aircraftManager->HandleRemovePlane(dto.callsign);
-				});
+					QueueCommand(command);
+				}
+				else
+				{
+					QueueCallback([=]
+					{
+						m_aircraftManager->HandleRemovePlane(dto.callsign);
+					});
+				}
 			}
 		}
 		if (packet.type == dto::DELETE_ALL_AIRCRAFT)
 		{
-			QueueCallback([=]
-			{
-				m_aircraftManager->RemoveAllPlanes();
-			});
+			m_positionBaselines.clear();
+
+			AircraftCommand command;
+			command.Type = AircraftCommandType::DeleteAllAircraft;
+			QueueCommand(command);
 		}
 		if (packet.type == dto::AIRCRAFT_CONFIG)
 		{
 			AircraftConfigDto dto;
 			packet.dto.convert(dto);
-			QueueCallback([=]
+
+			AircraftCommand command;
+			command.Type = AircraftCommandType::AircraftConfig;
+			command.SetConfig(dto);
+			if (AircraftCommand::CopyString(command.Callsign, dto.callsign))
 			{
-				m_aircraftManager->HandleAircraftConfig(dto.callsign, dto);
-			});
+				QueueCommand(command);
+			}
+			else
+			{
+				QueueCallback([=]
+				{
+					m_aircraftManager->HandleAircraftConfig(dto.callsign, dto);
+				});
+			}
 		}
 		if (packet.type == dto::NOTIFICATION_POSTED)
 		{
@@ -440,20 +624,21 @@ namespace xpilot
 		{
 			NearbyAtcDto dto;
 			packet.dto.convert(dto);
-
-			QueueCallback([=]
-			{
-				m_nearbyAtcWindow->UpdateList(dto);
-			});
+			m_nearbyAtcWindow->UpdateList(dto);
 		}
 		if (packet.type == dto::CONNECTED)
 		{
 			ConnectedDto dto;
 			packet.dto.convert(dto);
 
+			m_positionBaselines.clear();
+
+			AircraftCommand command;
+			command.Type = AircraftCommandType::DeleteAllAircraft;
+			QueueCommand(command);
+
 			QueueCallback([=]
 			{
-				m_aircraftManager->RemoveAllPlanes();
 				m_frameRateMonitor->StartMonitoring();
 				if (!Config::GetInstance().GetTcasDisabled())
 				{
@@ -470,11 +655,16 @@ namespace xpilot
 		}
 		if (packet.type == dto::DISCONNECTED)
 		{
+			m_positionBaselines.clear();
+
+			AircraftCommand command;
+			command.Type = AircraftCommandType::DeleteAllAircraft;
+			QueueCommand(command);
+			m_nearbyAtcWindow->ClearList();
+
 			QueueCallback([=]
 			{
-				m_aircraftManager->RemoveAllPlanes();
 				m_frameRateMonitor->StopMonitoring();
-				m_nearbyAtcWindow->UpdateList({});
 				ReleaseTcasControl();
 				m_xplaneAtisEnabled = 1;
 				m_overrideAutoTune = 0;
@@ -685,25 +875,194 @@ namespace xpilot
 		});
 	}
 
+	void XPilot::QueueFastPositionUpdate(const FastPositionUpdateDto& dto)
+	{
+		if (dto.callsign.empty())
+			return;
+
+		AircraftCommand command;
+		command.Type = AircraftCommandType::FastPosition;
+
+		AircraftVisualState& visualState = command.VisualState;
+		visualState.Lat = dto.latitude;
+		visualState.Lon = dto.longitude;
+		visualState.AltitudeTrue = dto.altitudeTrue;
+		visualState.AltitudeAgl = dto.altitudeAgl;
+		visualState.Pitch = dto.pitch;
+		visualState.Bank = dto.bank;
+		visualState.Heading = dto.heading;
+		visualState.NoseWheelAngle = dto.noseWheelAngle;
+
+		Vector3& positionalVector = command.PositionalVelocities;
+		positionalVector.X = dto.vx; // vel lon
+		positionalVector.Y = dto.vy; // vel alt
+		positionalVector.Z = dto.vz; // vel lat
+
+		Vector3& rotationalVelocity = command.RotationalVelocities;
+		rotationalVelocity.X = dto.vp * -1; // vel pitch
+		rotationalVelocity.Y = dto.vh; // vel heading
+		rotationalVelocity.Z = dto.vb * -1; // vel bank
+
+		command.Speed = dto.speed;
+
+		if (AircraftCommand::CopyString(command.Callsign, dto.callsign))
+		{
+			QueueCommand(command);
+		}
+		else
+		{
+			QueueCallback([=]
+			{
+				m_aircraftManager->HandleFastPositionUpdate(dto.callsign, command.VisualState,
+					command.PositionalVelocities, command.RotationalVelocities, command.Speed);
+			});
+		}
+	}
+
 	void XPilot::QueueCallback(const std::function<void()>& cb)
 	{
-		std::lock_guard<std::mutex> lck(m_mutex);
-		m_queuedCallbacks.push_back(cb);
+		m_mainThreadQueue->QueueCallback(cb);
+	}
+
+	void XPilot::QueueCommand(AircraftCommand& command)
+	{
+		m_mainThreadQueue->QueueCommand(command);
+	}
+
+	bool XPilot::SendOutbound(const OutboundMessage& message)
+	{
+		const int rv = nng_send(m_socket, const_cast<char*>(message.Data.data()), message.Data.size(), NNG_FLAG_NONBLOCK);
+		if (rv == NNG_EAGAIN)
+			return false;
+		if (rv != 0)
+		{
+			IpcMetrics::GetInstance().SendFailures++;
+		}
+		return true;
+	}
+
+	void XPilot::DispatchCommand(const AircraftCommand& command)
+	{
+		switch (command.Type)
+		{
+			case AircraftCommandType::AddAircraft:
+				m_aircraftManager->HandleAddPlane(command.Callsign, command.VisualState, command.Airline, command.TypeCode);
+				break;
+			case AircraftCommandType::FastPosition:
+				m_aircraftManager->HandleFastPositionUpdate(command.Callsign, command.VisualState,
+					command.PositionalVelocities, command.RotationalVelocities, command.Speed);
+				break;
+			case AircraftCommandType::Heartbeat:
+				m_aircraftManager->HandleHeartbeat(command.Callsign);
+				break;
+			case AircraftCommandType::AircraftConfig:
+				m_aircraftManager->HandleAircraftConfig(command.Callsign, command.GetConfig());
+				break;
+			case AircraftCommandType::DeleteAircraft:
+				m_aircraftManager->HandleRemovePlane(command.Callsign);
+				break;
+			case AircraftCommandType::DeleteAllAircraft:
+				m_aircraftManager->RemoveAllPlanes();
+				break;
+		}
 	}
 
-	void XPilot::InvokeQueuedCallbacks()
+	void XPilot::PublishIpcMetrics()
 	{
-		std::deque<std::function<void()>> temp;
+		const int64_t now = PrecisionTimestamp();
+		const int64_t elapsed = now - m_lastIpcMetricsPublish;
+		if (elapsed < IPC_METRICS_WINDOW_SECONDS * 1000)
+			return;
+		m_lastIpcMetricsPublish = now;
+
+		IpcMetrics& metrics = IpcMetrics::GetInstance();
+		for (size_t i = 0; i < static_cast<size_t>(IpcLatency::Count); i++)
+		{
+			m_ipcLatencySummaries[i] = metrics.Summarize(static_cast<IpcLatency>(i), true);
+			m_ipcLatencyDataRefs[i]->Publish(m_ipcLatencySummaries[i]);
+		}
+
+		const uint64_t received = metrics.MessagesReceived.load();
+		m_ipcMessagesPerSecond = static_cast<float>(received - m_ipcLastMessagesReceived) * 1000.0f / elapsed;
+		m_ipcLastMessagesReceived = received;
+
+		for (size_t i = 0; i < static_cast<size_t>(IpcMessageType::Count); i++)
+		{
+			const uint64_t count = metrics.GetMessageCount(static_cast<IpcMessageType>(i));
+			m_ipcMessageRates[i] = static_cast<float>(count - m_ipcLastMessageCounts[i]) * 1000.0f / elapsed;
+			m_ipcLastMessageCounts[i] = count;
+		}
+
+		m_ipcQueueDepthPeak = static_cast<int>(metrics.QueueDepthPeak.exchange(0));
+		m_ipcQueueDepthPeakValue = m_ipcQueueDepthPeak;
+		m_ipcOutboundDepthPeak = static_cast<int>(metrics.OutboundDepthPeak.exchange(0));
+		m_ipcOutboundDepthPeakValue = m_ipcOutboundDepthPeak;
+		m_ipcOutboundDropped = static_cast<int>(metrics.OutboundDropped.load());
+		m_ipcMessagesReceived = static_cast<int>(received);
+		m_ipcSendFailures = static_cast<int>(metrics.SendFailures.load());
+		m_ipcClientSendFailures = static_cast<int>(metrics.ClientSendFailures.load());
+	}
+
+	bool XPilot::StartIpcRecording()
+	{
+		return m_ipcRecording.StartRecording(GetPluginPath() + IPC_RECORDING_FILE);
+	}
+
+	void XPilot::StopIpcRecording()
+	{
+		m_ipcRecording.StopRecording();
+	}
+
+	bool XPilot::StartIpcReplay()
+	{
+		if (IsNetworkConnected())
+		{
+			AddNotificationMessage("Disconnect from the network before replaying recorded traffic.", Colors::Yellow);
+			return false;
+		}
+
+		m_aircraftManager->RemoveAllPlanes();
+		if (!m_ipcRecording.StartReplay(GetPluginPath() + IPC_RECORDING_FILE))
+			return false;
+
+		// start the replay's profile from scratch
+		FrameProfiler& profiler = FrameProfiler::GetInstance();
+		for (size_t i = 0; i < static_cast<size_t>(FrameSection::Count); i++)
 		{
-			std::lock_guard<std::mutex> lck(m_mutex);
-			std::swap(temp, m_queuedCallbacks);
+			profiler.Summarize(static_cast<FrameSection>(i), true);
 		}
-		while (!temp.empty())
+		m_replayReportPending = true;
+		return true;
+	}
+
+	void XPilot::StopIpcReplay()
+	{
+		m_ipcRecording.StopReplay();
+		FinishIpcReplay();
+	}
+
+	void XPilot::FinishIpcReplay()
+	{
+		if (!m_replayReportPending)
+			return;
+		m_replayReportPending = false;
+
+		LOG_MSG(logMSG, "Frame profile of the IPC replay (%zu messages), per frame in microseconds:", m_ipcRecording.GetMessageCount());
+		FrameProfiler& profiler = FrameProfiler::GetInstance();
+		for (size_t i = 0; i < static_cast<size_t>(FrameSection::Count); i++)
 		{
-			auto cb = temp.front();
-			temp.pop_front();
-			cb();
+			const auto section = static_cast<FrameSection>(i);
+			m_frameProfileSummaries[i] = profiler.Summarize(section, true);
+			m_frameProfileDataRefs[i]->Publish(m_frameProfileSummaries[i]);
+
+			const LatencySummary& summary = m_frameProfileSummaries[i];
+			LOG_MSG(logMSG, "  %-20s frames %llu, p50 %.0f, p95 %.0f, p99 %.0f, max %.0f", FrameProfiler::GetName(section),
+				static_cast<unsigned long long>(summary.Count), summary.P50 * 1000.0f, summary.P95 * 1000.0f, summary.P99 * 1000.0f, summary.Max * 1000.0f);
 		}
+		m_lastFrameProfilePublish = PrecisionTimestamp();
+
+		m_aircraftManager->RemoveAllPlanes();
+		AddNotificationMessage("Traffic replay finished, its frame profile was written to the log.");
 	}
 
 	void XPilot::ToggleSettingsWindow()
@@ -721,6 +1080,29 @@ namespace xpilot
 		m_textMessageConsole->SetVisible(!m_textMessageConsole->GetVisible());
 	}
 
+	void XPilot::PublishFrameProfile()
+	{
+		const int64_t now = PrecisionTimestamp();
+		if (now - m_lastFrameProfilePublish < IPC_METRICS_WINDOW_SECONDS * 1000)
+			return;
+		m_lastFrameProfilePublish = now;
+
+		// a replay is profiled as a whole, see FinishIpcReplay
+		const bool reset = !m_ipcRecording.IsReplaying();
+
+		FrameProfiler& profiler = FrameProfiler::GetInstance();
+		for (size_t i = 0; i < static_cast<size_t>(FrameSection::Count); i++)
+		{
+			m_frameProfileSummaries[i] = profiler.Summarize(static_cast<FrameSection>(i), reset);
+			m_frameProfileDataRefs[i]->Publish(m_frameProfileSummaries[i]);
+		}
+	}
+
+	void XPilot::ToggleDebugWindow()
+	{
+		m_debugWindow->SetVisible(!m_debugWindow->GetVisible());
+	}
+
 	void XPilot::SetNotificationPanelAlwaysVisible(bool visible)
 	{
 		m_notificationPanel->SetAlwaysVisible(visible);
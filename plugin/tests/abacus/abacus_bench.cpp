@@ -0,0 +1,138 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+// Times the batch kernels in abacus.hpp against loops over the scalar functions, in the blocks of 64
+// aircraft the kinematics pass uses and over a whole 2,000-aircraft set. Prints nanoseconds per aircraft.
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "abacus.hpp"
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	struct Quaternions
+	{
+		std::vector<double> I, J, K, U;
+
+		explicit Quaternions(size_t count) : I(count), J(count), K(count), U(count) {}
+
+		QuaternionSpan Span() { return { I.data(), J.data(), K.data(), U.data() }; }
+		ConstQuaternionSpan Span() const { return { I.data(), J.data(), K.data(), U.data() }; }
+		Quaternion At(size_t n) const { return Quaternion(I[n], J[n], K[n], U[n]); }
+
+		void Set(size_t n, Quaternion q)
+		{
+			I[n] = q.I;
+			J[n] = q.J;
+			K[n] = q.K;
+			U[n] = q.U;
+		}
+	};
+
+	volatile double g_sink;
+
+	/// Best of several runs of `pass` over `count` aircraft, in ns per aircraft
+	double Time(size_t count, const std::function<void(size_t, size_t)>& pass, size_t block)
+	{
+		constexpr int RUNS = 7;
+		const int repeats = static_cast<int>(std::max<size_t>(1, 2000000 / count));
+		double best = 1e300;
+		for (int run = 0; run < RUNS; run++)
+		{
+			const Clock::time_point start = Clock::now();
+			for (int r = 0; r < repeats; r++)
+			{
+				for (size_t i = 0; i < count; i += block)
+				{
+					pass(i, std::min(block, count - i));
+				}
+			}
+			const double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+			best = std::min(best, elapsed / repeats / count);
+		}
+		return best;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const size_t count = argc > 1 ? std::stoul(argv[1]) : 2000;
+
+	std::mt19937 random(1);
+	std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+	std::uniform_real_distribution<double> unit(0.0, 1.0);
+	std::vector<double> yaw(count), pitch(count), roll(count), t(count);
+	Quaternions a(count), b(count), out(count);
+	for (size_t n = 0; n < count; n++)
+	{
+		yaw[n] = angle(random);
+		pitch[n] = angle(random) / 2;
+		roll[n] = angle(random);
+		t[n] = unit(random);
+		a.Set(n, Quaternion::CreateFromEuler(angle(random), angle(random) / 2, angle(random)));
+		b.Set(n, Quaternion::CreateFromEuler(angle(random), angle(random) / 2, angle(random)));
+	}
+
+	struct Kernel
+	{
+		std::string Name;
+		std::function<void(size_t, size_t)> Scalar;
+		std::function<void(size_t, size_t)> Batch;
+	};
+
+	const Kernel kernels[] = {
+		{ "CreateFromEuler",
+			[&](size_t i, size_t n) { for (size_t k = i; k < i + n; k++) out.Set(k, Quaternion::CreateFromEuler(yaw[k], pitch[k], roll[k])); },
+			[&](size_t i, size_t n) { CreateFromEulerBatch(yaw.data() + i, pitch.data() + i, roll.data() + i,
+				{ out.I.data() + i, out.J.data() + i, out.K.data() + i, out.U.data() + i }, n); } },
+		{ "Multiply",
+			[&](size_t i, size_t n) { for (size_t k = i; k < i + n; k++) out.Set(k, a.At(k) * b.At(k)); },
+			[&](size_t i, size_t n) { MultiplyBatch({ a.I.data() + i, a.J.data() + i, a.K.data() + i, a.U.data() + i },
+				{ b.I.data() + i, b.J.data() + i, b.K.data() + i, b.U.data() + i },
+				{ out.I.data() + i, out.J.data() + i, out.K.data() + i, out.U.data() + i }, n); } },
+		{ "Slerp",
+			[&](size_t i, size_t n) { for (size_t k = i; k < i + n; k++) out.Set(k, Quaternion::Slerp(a.At(k), b.At(k), t[k])); },
+			[&](size_t i, size_t n) { SlerpBatch({ a.I.data() + i, a.J.data() + i, a.K.data() + i, a.U.data() + i },
+				{ b.I.data() + i, b.J.data() + i, b.K.data() + i, b.U.data() + i }, t.data() + i,
+				{ out.I.data() + i, out.J.data() + i, out.K.data() + i, out.U.data() + i }, n); } },
+		{ "ExtractEulerAngles",
+			[&](size_t i, size_t n) { for (size_t k = i; k < i + n; k++) { const Vector3 e = Quaternion::ExtractEulerAngles(a.At(k));
+				pitch[k] = e.X; yaw[k] = e.Y; roll[k] = e.Z; } },
+			[&](size_t i, size_t n) { ExtractEulerAnglesBatch({ a.I.data() + i, a.J.data() + i, a.K.data() + i, a.U.data() + i },
+				pitch.data() + i, yaw.data() + i, roll.data() + i, n); } },
+	};
+
+	printf("aircraft=%zu lane_width=%zu\n", count, AbacusLanes::Wide::Width);
+	printf("%-20s %12s %12s %12s %12s\n", "kernel", "scalar ns", "block64 ns", "whole ns", "speedup");
+	for (const Kernel& kernel : kernels)
+	{
+		const double scalar = Time(count, kernel.Scalar, count);
+		const double block = Time(count, kernel.Batch, 64);
+		const double whole = Time(count, kernel.Batch, count);
+		printf("%-20s %12.2f %12.2f %12.2f %11.2fx\n", kernel.Name.c_str(), scalar, block, whole, scalar / block);
+		g_sink = out.I[count / 2] + yaw[count / 2];
+	}
+	return 0;
+}
@@ -0,0 +1,236 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+// Checks the batch kernels in abacus.hpp and geo_calc.hpp against the scalar functions they replace, for
+// every count from 0 to a few times the lane width (so each remainder length is covered) and for a large
+// random set, including the branches: gimbal lock, near-identical and opposite rotations, and t outside 0..1.
+// The kernels are meant to match bitwise; the check allows TOLERANCE so FMA contraction of the scalar code
+// doesn't fail it. Built once for the default instruction set and, where the compiler allows, with AVX.
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "abacus.hpp"
+#include "geo_calc.hpp"
+
+namespace
+{
+	constexpr double TOLERANCE = 1e-12;
+
+	struct Result
+	{
+		std::string Name;
+		size_t Checked = 0;
+		size_t Exact = 0;
+		size_t Failed = 0;
+		double MaxError = 0.0;
+
+		void Compare(double expected, double actual, size_t count, size_t index)
+		{
+			Checked++;
+			const double error = std::fabs(expected - actual);
+			if (std::memcmp(&expected, &actual, sizeof(double)) == 0 || (std::isnan(expected) && std::isnan(actual)))
+			{
+				Exact++;
+				return;
+			}
+			MaxError = std::max(MaxError, error);
+			if (!(error <= TOLERANCE))
+			{
+				if (Failed++ < 10)
+				{
+					fprintf(stderr, "%s: count %zu lane %zu expected %.17g, got %.17g\n", Name.c_str(), count, index, expected, actual);
+				}
+			}
+		}
+	};
+
+	struct Quaternions
+	{
+		std::vector<double> I, J, K, U;
+
+		explicit Quaternions(size_t count) : I(count), J(count), K(count), U(count) {}
+
+		QuaternionSpan Span() { return { I.data(), J.data(), K.data(), U.data() }; }
+		ConstQuaternionSpan Span() const { return { I.data(), J.data(), K.data(), U.data() }; }
+		Quaternion At(size_t n) const { return Quaternion(I[n], J[n], K[n], U[n]); }
+
+		void Set(size_t n, Quaternion q)
+		{
+			I[n] = q.I;
+			J[n] = q.J;
+			K[n] = q.K;
+			U[n] = q.U;
+		}
+	};
+
+	/// Random inputs; every few lanes hits one of the special cases of the scalar code
+	struct Inputs
+	{
+		std::vector<double> Yaw, Pitch, Roll, T, Lat1, Lon1, Lat2, Lon2;
+		Quaternions A, B;
+
+		Inputs(size_t count, std::mt19937& random) : Yaw(count), Pitch(count), Roll(count), T(count), Lat1(count), Lon1(count),
+			Lat2(count), Lon2(count), A(count), B(count)
+		{
+			std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+			std::uniform_real_distribution<double> unit(0.0, 1.0);
+			std::uniform_real_distribution<double> latitude(-89.0, 89.0);
+			std::uniform_real_distribution<double> longitude(-180.0, 180.0);
+			std::uniform_real_distribution<double> small(-1e-4, 1e-4);
+
+			for (size_t n = 0; n < count; n++)
+			{
+				Yaw[n] = angle(random);
+				Pitch[n] = angle(random) / 2;
+				Roll[n] = angle(random);
+				T[n] = unit(random);
+				Lat1[n] = latitude(random);
+				Lon1[n] = longitude(random);
+				Lat2[n] = Lat1[n] + small(random);
+				Lon2[n] = longitude(random);
+
+				Quaternion a = Quaternion::CreateFromEuler(angle(random), angle(random) / 2, angle(random));
+				Quaternion b = Quaternion::CreateFromEuler(angle(random), angle(random) / 2, angle(random));
+				switch (n % 7)
+				{
+					case 1: // gimbal lock, north and south
+						a = Quaternion::CreateFromEuler(Yaw[n], M_PI / 2, 0.0);
+						b = Quaternion::CreateFromEuler(Yaw[n], -M_PI / 2, 0.0);
+						break;
+					case 2: // nearly the same rotation: linear blend
+						b = Quaternion::CreateFromEuler(Yaw[n] + 1e-7, Pitch[n], Roll[n]);
+						a = Quaternion::CreateFromEuler(Yaw[n], Pitch[n], Roll[n]);
+						break;
+					case 3: // the same rotation with the opposite sign
+						b = -a;
+						break;
+					case 4: // clamped
+						T[n] = n % 2 ? -0.25 : 1.25;
+						break;
+					case 5: // the same point
+						Lat2[n] = Lat1[n];
+						Lon2[n] = Lon1[n];
+						break;
+				}
+				A.Set(n, a);
+				B.Set(n, b);
+			}
+		}
+	};
+
+	void Check(size_t count, std::mt19937& random, std::vector<Result>& results)
+	{
+		const Inputs in(count, random);
+
+		{
+			Quaternions out(count);
+			CreateFromEulerBatch(in.Yaw.data(), in.Pitch.data(), in.Roll.data(), out.Span(), count);
+			for (size_t n = 0; n < count; n++)
+			{
+				const Quaternion q = Quaternion::CreateFromEuler(in.Yaw[n], in.Pitch[n], in.Roll[n]);
+				results[0].Compare(q.I, out.I[n], count, n);
+				results[0].Compare(q.J, out.J[n], count, n);
+				results[0].Compare(q.K, out.K[n], count, n);
+				results[0].Compare(q.U, out.U[n], count, n);
+			}
+		}
+		{
+			Quaternions out(count);
+			MultiplyBatch(in.A.Span(), in.B.Span(), out.Span(), count);
+			for (size_t n = 0; n < count; n++)
+			{
+				const Quaternion q = in.A.At(n) * in.B.At(n);
+				results[1].Compare(q.I, out.I[n], count, n);
+				results[1].Compare(q.J, out.J[n], count, n);
+				results[1].Compare(q.K, out.K[n], count, n);
+				results[1].Compare(q.U, out.U[n], count, n);
+			}
+		}
+		{
+			Quaternions out(count);
+			SlerpBatch(in.A.Span(), in.B.Span(), in.T.data(), out.Span(), count);
+			for (size_t n = 0; n < count; n++)
+			{
+				const Quaternion q = Quaternion::Slerp(in.A.At(n), in.B.At(n), in.T[n]);
+				results[2].Compare(q.I, out.I[n], count, n);
+				results[2].Compare(q.J, out.J[n], count, n);
+				results[2].Compare(q.K, out.K[n], count, n);
+				results[2].Compare(q.U, out.U[n], count, n);
+			}
+		}
+		{
+			std::vector<double> pitch(count), yaw(count), roll(count);
+			ExtractEulerAnglesBatch(in.A.Span(), pitch.data(), yaw.data(), roll.data(), count);
+			for (size_t n = 0; n < count; n++)
+			{
+				const Vector3 euler = Quaternion::ExtractEulerAngles(in.A.At(n));
+				results[3].Compare(euler.X, pitch[n], count, n);
+				results[3].Compare(euler.Y, yaw[n], count, n);
+				results[3].Compare(euler.Z, roll[n], count, n);
+			}
+		}
+		{
+			std::vector<double> scaling(count), distance(count);
+			LongitudeScalingFactorBatch(in.Lat1.data(), scaling.data(), count);
+			GreatCircleDistanceBatch(in.Lon1.data(), in.Lat1.data(), in.Lon2.data(), in.Lat2.data(), distance.data(), count);
+			for (size_t n = 0; n < count; n++)
+			{
+				results[4].Compare(LongitudeScalingFactor(in.Lat1[n]), scaling[n], count, n);
+				results[5].Compare(GreatCircleDistance(in.Lon1[n], in.Lat1[n], in.Lon2[n], in.Lat2[n]), distance[n], count, n);
+			}
+		}
+	}
+}
+
+int main()
+{
+	std::vector<Result> results(6);
+	results[0].Name = "CreateFromEulerBatch";
+	results[1].Name = "MultiplyBatch";
+	results[2].Name = "SlerpBatch";
+	results[3].Name = "ExtractEulerAnglesBatch";
+	results[4].Name = "LongitudeScalingFactorBatch";
+	results[5].Name = "GreatCircleDistanceBatch";
+
+	std::mt19937 random(1);
+	const size_t width = AbacusLanes::Wide::Width;
+	for (size_t count = 0; count <= 4 * width + 3; count++)
+	{
+		Check(count, random, results);
+	}
+	Check(1000, random, results);
+	Check(1000 + width - 1, random, results);
+
+	printf("lane_width=%zu\n", width);
+	int result = 0;
+	for (const Result& r : results)
+	{
+		printf("%s checked=%zu exact=%zu max_error=%.3g\n", r.Name.c_str(), r.Checked, r.Exact, r.MaxError);
+		if (r.Failed > 0)
+		{
+			fprintf(stderr, "%s: %zu values differ by more than %g\n", r.Name.c_str(), r.Failed, TOLERANCE);
+			result = 1;
+		}
+	}
+	return result;
+}
@@ -0,0 +1,221 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "synthetic_traffic.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+namespace xpilot
+{
+	// must match IpcRecording
+	constexpr char IPC_RECORDING_MAGIC[] = "XPIPC1";
+	constexpr size_t IPC_RECORDING_MAGIC_LENGTH = sizeof(IPC_RECORDING_MAGIC) - 1;
+
+	constexpr double METERS_PER_DEGREE = 111319.5;
+	constexpr double FEET_PER_METER = 3.28084;
+	constexpr double KNOTS_PER_METER_PER_SECOND = 1.94384;
+	constexpr double GRAVITY = 9.80665; // [m/s^2]
+	constexpr double PI = 3.14159265358979323846;
+
+	bool WriteIpcRecording(const std::string& path, const std::vector<RecordedMessage>& messages)
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file)
+			return false;
+
+		file.write(IPC_RECORDING_MAGIC, IPC_RECORDING_MAGIC_LENGTH);
+		for (const RecordedMessage& message : messages)
+		{
+			const uint32_t size = static_cast<uint32_t>(message.Data.size());
+			file.write(reinterpret_cast<const char*>(&message.Offset), sizeof(message.Offset));
+			file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+			file.write(message.Data.data(), size);
+		}
+		return static_cast<bool>(file);
+	}
+
+	bool ReadIpcRecording(const std::string& path, std::vector<RecordedMessage>& messages)
+	{
+		std::ifstream file(path, std::ios::binary);
+		char magic[IPC_RECORDING_MAGIC_LENGTH] = {};
+		if (!file || !file.read(magic, IPC_RECORDING_MAGIC_LENGTH) || std::memcmp(magic, IPC_RECORDING_MAGIC, IPC_RECORDING_MAGIC_LENGTH) != 0)
+			return false;
+
+		messages.clear();
+		RecordedMessage message;
+		uint32_t size;
+		while (file.read(reinterpret_cast<char*>(&message.Offset), sizeof(message.Offset))
+			&& file.read(reinterpret_cast<char*>(&size), sizeof(size)))
+		{
+			message.Data.resize(size);
+			if (!file.read(message.Data.data(), size))
+				break;
+			messages.push_back(std::move(message));
+		}
+		return true;
+	}
+
+	std::string SyntheticCallsign(int n)
+	{
+		static const char* airlines[] = { "UAL", "DAL", "AAL", "SWA", "ASA", "JBU" };
+		return airlines[n % 6] + std::to_string(100 + n);
+	}
+
+	namespace
+	{
+		constexpr double START_DELAY = 0.5; // [s]
+
+		template<typename T>
+		void Append(std::vector<RecordedMessage>& messages, double time, const T& dto)
+		{
+			msgpack::sbuffer buffer;
+			if (!encodeDto(buffer, dto))
+				return;
+			messages.push_back({ static_cast<int64_t>(std::llround(time * 1e6)), std::vector<char>(buffer.data(), buffer.data() + buffer.size()) });
+		}
+
+		/// First k with start + k * interval >= from
+		double FirstTick(double start, double interval, double from)
+		{
+			return from <= start ? 0.0 : std::ceil((from - start) / interval);
+		}
+	}
+
+	SyntheticTraffic::SyntheticTraffic(const SyntheticTrafficOptions& options) :
+		m_options(options),
+		m_end(options.Duration - START_DELAY)
+	{
+		static const char* types[] = { "A320", "B738", "B77W", "A321", "E75L", "CRJ9", "A359", "B39M" };
+
+		std::mt19937 random(options.Seed);
+		auto uniform = [&random](double min, double max) { return std::uniform_real_distribution<double>(min, max)(random); };
+
+		for (int n = 0; n < options.Aircraft; n++)
+		{
+			Flight flight;
+			flight.Callsign = SyntheticCallsign(n);
+			flight.TypeCode = types[n % 8];
+			flight.OnGround = uniform(0.0, 1.0) < options.OnGroundShare;
+			flight.Radius = flight.OnGround ? uniform(200.0, 800.0) : uniform(5000.0, 60000.0);
+			flight.Speed = flight.OnGround ? uniform(5.0, 12.0) : uniform(80.0, 240.0);
+			flight.Direction = uniform(0.0, 1.0) < 0.5 ? -1.0 : 1.0;
+			flight.Phase = uniform(0.0, 2.0 * PI);
+			flight.Altitude = flight.OnGround ? options.FieldElevation * FEET_PER_METER : uniform(3000.0, 37000.0);
+			flight.Arrival = START_DELAY + (options.Aircraft > 1 ? options.ArrivalWindow * n / (options.Aircraft - 1) : 0.0);
+			flight.FirstPosition = flight.Arrival + uniform(0.0, 1.0 / options.PositionRate);
+			m_flights.push_back(flight);
+		}
+	}
+
+	FastPositionUpdateDto SyntheticTraffic::PositionAt(const Flight& flight, double time) const
+	{
+		const double rate = flight.Direction * flight.Speed / flight.Radius; // [rad/s]
+		const double angle = flight.Phase + rate * (time - flight.Arrival);
+		const double north = flight.Radius * std::cos(angle);
+		const double east = flight.Radius * std::sin(angle);
+		const double velocityNorth = -flight.Radius * std::sin(angle) * rate;
+		const double velocityEast = flight.Radius * std::cos(angle) * rate;
+
+		FastPositionUpdateDto dto{};
+		dto.callsign = flight.Callsign;
+		dto.latitude = m_options.CenterLatitude + north / METERS_PER_DEGREE;
+		dto.longitude = m_options.CenterLongitude + east / (METERS_PER_DEGREE * std::cos(dto.latitude * PI / 180.0));
+		dto.altitudeTrue = flight.Altitude;
+		dto.altitudeAgl = flight.Altitude - m_options.FieldElevation * FEET_PER_METER;
+		dto.heading = std::fmod(std::atan2(velocityEast, velocityNorth) * 180.0 / PI + 360.0, 360.0);
+		dto.bank = flight.OnGround ? 0.0 : std::atan(flight.Speed * rate / GRAVITY) * 180.0 / PI;
+		dto.pitch = flight.OnGround ? 0.0 : 2.5;
+		dto.vx = velocityEast;
+		dto.vy = 0.0;
+		dto.vz = velocityNorth;
+		dto.vh = rate;
+		dto.speed = flight.Speed * KNOTS_PER_METER_PER_SECOND;
+		return dto;
+	}
+
+	void SyntheticTraffic::Generate(double from, double to, std::vector<RecordedMessage>& messages) const
+	{
+		const size_t first = messages.size();
+		const double positionInterval = 1.0 / m_options.PositionRate;
+		auto due = [from, to](double time) { return time >= from && time < to; };
+
+		for (const Flight& flight : m_flights)
+		{
+			if (due(flight.Arrival))
+			{
+				const FastPositionUpdateDto position = PositionAt(flight, flight.Arrival);
+				AddAircraftDto add{ flight.Callsign, flight.Callsign.substr(0, 3), flight.TypeCode,
+					position.latitude, position.longitude, position.altitudeTrue, position.heading, position.bank, position.pitch };
+				Append(messages, flight.Arrival, add);
+
+				AircraftConfigDto config{};
+				config.callsign = flight.Callsign;
+				config.fullConfig = true;
+				config.enginesOn = true;
+				config.enginesReversing = false;
+				config.onGround = flight.OnGround;
+				config.flaps = flight.OnGround ? 0.25f : 0.0f;
+				config.spoilersDeployed = false;
+				config.gearDown = flight.OnGround;
+				config.beaconLightsOn = true;
+				config.landingLightsOn = !flight.OnGround;
+				config.navLightsOn = true;
+				config.strobeLightsOn = !flight.OnGround;
+				config.taxiLightsOn = flight.OnGround;
+				Append(messages, flight.Arrival, config);
+			}
+
+			for (double k = FirstTick(flight.FirstPosition, positionInterval, from);; k++)
+			{
+				const double time = flight.FirstPosition + k * positionInterval;
+				if (time >= to || time >= m_end)
+					break;
+				Append(messages, time, PositionAt(flight, time));
+			}
+
+			const double firstHeartbeat = flight.Arrival + m_options.HeartbeatInterval;
+			for (double k = FirstTick(firstHeartbeat, m_options.HeartbeatInterval, from);; k++)
+			{
+				const double time = firstHeartbeat + k * m_options.HeartbeatInterval;
+				if (time >= to || time >= m_end)
+					break;
+				Append(messages, time, HeartbeatDto{ flight.Callsign });
+			}
+
+			if (due(m_end))
+			{
+				Append(messages, m_end, DeleteAircraftDto{ flight.Callsign, "" });
+			}
+		}
+
+		std::stable_sort(messages.begin() + first, messages.end(), [](const RecordedMessage& a, const RecordedMessage& b)
+		{
+			return a.Offset < b.Offset;
+		});
+	}
+
+	std::vector<RecordedMessage> SynthesizeTraffic(const SyntheticTrafficOptions& options)
+	{
+		std::vector<RecordedMessage> messages;
+		SyntheticTraffic(options).Generate(0.0, options.Duration, messages);
+		return messages;
+	}
+}
@@ -0,0 +1,95 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <msgpack.hpp>
+
+#include "dto.h"
+
+namespace xpilot
+{
+	/// One client message in the IPC recording format (see IpcRecording)
+	struct RecordedMessage
+	{
+		int64_t Offset; // [us] since the start of the recording
+		std::vector<char> Data; // msgpack encoded BaseDto
+	};
+
+	bool WriteIpcRecording(const std::string& path, const std::vector<RecordedMessage>& messages);
+	bool ReadIpcRecording(const std::string& path, std::vector<RecordedMessage>& messages);
+
+	struct SyntheticTrafficOptions
+	{
+		int Aircraft = 100;
+		double Duration = 30.0; // [s] until every aircraft is deleted again
+		double ArrivalWindow = 0.0; // [s] the aircraft are added evenly spread over this; zero adds them all at once
+		double PositionRate = 5.0; // [Hz] fast position updates per aircraft
+		double HeartbeatInterval = 5.0; // [s]
+		double OnGroundShare = 0.2; // taxiing at the field elevation
+		double CenterLatitude = 37.6188; // KSFO
+		double CenterLongitude = -122.3754;
+		double FieldElevation = 4.0; // [m]
+		uint32_t Seed = 1;
+	};
+
+	/// Traffic the way the client relays it from the network: an ADD and full ACCONF per aircraft, then
+	/// FSTPOS at the position rate and a heartbeat now and then, until a DEL at the end. Airborne aircraft
+	/// fly circles around the center, the rest taxi in small circles. Deterministic for a given seed.
+	class SyntheticTraffic
+	{
+	public:
+		explicit SyntheticTraffic(const SyntheticTrafficOptions& options);
+
+		/// Appends the messages due in [from, to) seconds, in order
+		void Generate(double from, double to, std::vector<RecordedMessage>& messages) const;
+
+	private:
+		struct Flight
+		{
+			std::string Callsign;
+			std::string TypeCode;
+			bool OnGround;
+			double Radius; // [m]
+			double Speed; // [m/s]
+			double Direction; // +1 clockwise, -1 counterclockwise
+			double Phase; // [rad]
+			double Altitude; // [ft]
+			double Arrival; // [s]
+			double FirstPosition; // [s]
+		};
+
+		FastPositionUpdateDto PositionAt(const Flight& flight, double time) const;
+
+		SyntheticTrafficOptions m_options;
+		std::vector<Flight> m_flights;
+		double m_end; // [s] when the aircraft are deleted
+	};
+
+	/// All of the synthetic traffic at once
+	std::vector<RecordedMessage> SynthesizeTraffic(const SyntheticTrafficOptions& options);
+
+	/// Callsign of the n-th synthetic aircraft
+	std::string SyntheticCallsign(int n);
+}
@@ -0,0 +1,232 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+// Tests for the text console's ConsoleHistory in a headless ImGui context: after every add, eviction at the
+// history limit and width change, the laid out lines have to cover exactly the oldest m_laidOut messages,
+// and an incrementally laid out history has to match one laid out from scratch at the same width.
+
+#include "stdafx.h"
+#include "config.h"
+#include "text_message_console.h"
+
+#include <cstdio>
+#include <random>
+
+using namespace xpilot;
+
+namespace
+{
+	int g_failures = 0;
+
+	void Expect(bool condition, const char* test, const char* what)
+	{
+		if (!condition)
+		{
+			fprintf(stderr, "%s: %s\n", test, what);
+			g_failures++;
+		}
+	}
+
+	/// One ImGui frame with the history drawn into a window of the given width
+	void Frame(ConsoleHistory& history, float width)
+	{
+		ImGui::NewFrame();
+		ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+		ImGui::SetNextWindowSize(ImVec2(width, 400.0f));
+		ImGui::Begin("Console", nullptr, ImGuiWindowFlags_NoScrollbar);
+		history.Render(true);
+		ImGui::End();
+		ImGui::Render();
+	}
+
+	/// The lines belong to the oldest GetLaidOutCount() messages, in order, and each of them has at least one
+	/// line whose byte range lies within its text
+	bool Consistent(const ConsoleHistory& history)
+	{
+		const std::deque<ConsoleMessage>& messages = history.GetMessages();
+		const std::deque<ConsoleLine>& lines = history.GetLines();
+		const size_t laidOut = history.GetLaidOutCount();
+		if (laidOut > messages.size())
+			return false;
+		if (laidOut == 0)
+			return lines.empty();
+
+		size_t message = 0;
+		for (size_t i = 0; i < lines.size(); i++)
+		{
+			const ConsoleLine& line = lines[i];
+			if (line.Message != messages[message].GetSequence())
+			{
+				// the next message starts; none may be skipped, and the first line belongs to the oldest
+				if (i == 0 || message + 1 >= laidOut || line.Message != messages[message + 1].GetSequence())
+					return false;
+				message++;
+			}
+			if (line.Start > line.End || line.End > messages[message].GetMessage().size())
+				return false;
+		}
+		return message == laidOut - 1;
+	}
+
+	/// Lines relative to the oldest message, so two histories holding the same text compare equal
+	std::vector<std::array<uint64_t, 3>> RelativeLines(const ConsoleHistory& history)
+	{
+		std::vector<std::array<uint64_t, 3>> lines;
+		if (history.GetMessages().empty())
+			return lines;
+		const uint64_t first = history.GetMessages().front().GetSequence();
+		for (const ConsoleLine& line : history.GetLines())
+		{
+			lines.push_back({ line.Message - first, line.Start, line.End });
+		}
+		return lines;
+	}
+
+	bool SameLayout(const ConsoleHistory& history, float width)
+	{
+		ConsoleHistory fresh;
+		for (const ConsoleMessage& message : history.GetMessages())
+		{
+			fresh.Add(message.GetMessage(), Colors::White);
+		}
+		Frame(fresh, width);
+		return RelativeLines(fresh) == RelativeLines(history);
+	}
+
+	std::string Message(std::mt19937& random, int n)
+	{
+		static const char* words[] = { "ATIS", "information", "Bravo", "runway", "two", "eight", "left", "contact",
+			"Seattle", "approach", "one", "two", "six", "decimal", "five", "squawk", "VFR", "readback", "correct" };
+		std::string text = "UAL" + std::to_string(n) + ":";
+		const int count = std::uniform_int_distribution<int>(0, 60)(random);
+		for (int i = 0; i < count; i++)
+		{
+			text += (i % 17 == 16) ? "\n" : " ";
+			text += words[std::uniform_int_distribution<size_t>(0, std::size(words) - 1)(random)];
+		}
+		return text;
+	}
+
+	void Eviction()
+	{
+		Config::GetInstance().SetConsoleHistoryLimit(100);
+		std::mt19937 random(1);
+		ConsoleHistory history;
+		int n = 0;
+
+		for (; n < 60; n++)
+		{
+			history.Add(Message(random, n), Colors::White);
+		}
+		Frame(history, 300.0f);
+		Expect(history.GetLaidOutCount() == 60 && Consistent(history), "eviction", "every message is laid out");
+
+		// evicts 40 laid out messages before the next frame
+		for (; n < 140; n++)
+		{
+			history.Add(Message(random, n), Colors::White);
+			if (!Consistent(history))
+				break;
+		}
+		Expect(n == 140, "eviction", "the lines stay consistent while laid out messages are evicted");
+		Expect(history.GetMessages().size() == 100 && history.GetLaidOutCount() == 20, "eviction", "the newest 100 are kept");
+		Frame(history, 300.0f);
+		Expect(history.GetLaidOutCount() == 100 && Consistent(history), "eviction", "the new messages are laid out");
+		Expect(SameLayout(history, 300.0f), "eviction", "the lines match a layout from scratch");
+
+		// a message per frame at the limit
+		bool consistent = true;
+		for (; n < 400; n++)
+		{
+			history.Add(Message(random, n), Colors::White);
+			Frame(history, 300.0f);
+			consistent = consistent && Consistent(history) && history.GetLaidOutCount() == history.GetMessages().size();
+		}
+		Expect(consistent, "eviction", "the lines stay consistent frame by frame");
+		Expect(SameLayout(history, 300.0f), "eviction", "the lines still match a layout from scratch");
+
+		// a lower limit evicts down to it on the next add
+		Config::GetInstance().SetConsoleHistoryLimit(50);
+		history.Add(Message(random, n++), Colors::White);
+		Expect(history.GetMessages().size() == 50 && Consistent(history), "eviction", "a lower limit applies on the next add");
+		Frame(history, 300.0f);
+		Expect(SameLayout(history, 300.0f), "eviction", "the lines match after the limit was lowered");
+	}
+
+	void WidthChange()
+	{
+		Config::GetInstance().SetConsoleHistoryLimit(100);
+		std::mt19937 random(2);
+		ConsoleHistory history;
+		int n = 0;
+		for (; n < 150; n++)
+		{
+			history.Add(Message(random, n), Colors::White);
+		}
+		Frame(history, 250.0f);
+		const size_t narrowLines = history.GetLines().size();
+
+		Frame(history, 600.0f);
+		Expect(Consistent(history) && history.GetLaidOutCount() == 100, "width change", "a wider window lays everything out again");
+		Expect(history.GetLines().size() < narrowLines, "width change", "wider lines need fewer of them");
+		Expect(SameLayout(history, 600.0f), "width change", "the lines match a layout from scratch");
+
+		// messages evicted and added between width changes
+		for (int frame = 0; frame < 60; frame++)
+		{
+			history.Add(Message(random, n++), Colors::White);
+			history.Add(Message(random, n++), Colors::White);
+			Frame(history, frame % 2 == 0 ? 250.0f : 600.0f);
+			if (!Consistent(history))
+				break;
+		}
+		Expect(Consistent(history), "width change", "the lines stay consistent when the width changes every frame");
+		Expect(SameLayout(history, 600.0f), "width change", "the lines match a layout from scratch");
+
+		history.Clear();
+		Expect(history.GetMessages().empty() && history.GetLines().empty() && history.GetLaidOutCount() == 0, "width change",
+			"clear forgets the lines");
+		Frame(history, 600.0f);
+		Expect(Consistent(history), "width change", "an empty history draws");
+	}
+}
+
+int main()
+{
+	ImGui::CreateContext();
+	ImGuiIO& io = ImGui::GetIO();
+	io.DisplaySize = ImVec2(1024.0f, 768.0f);
+	io.DeltaTime = 1.0f / 60.0f;
+	io.IniFilename = nullptr;
+	unsigned char* pixels;
+	int width, height;
+	io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+	Eviction();
+	WidthChange();
+
+	ImGui::DestroyContext();
+
+	if (g_failures > 0)
+	{
+		fprintf(stderr, "%d expectations failed\n", g_failures);
+		return 1;
+	}
+	printf("all passed\n");
+	return 0;
+}
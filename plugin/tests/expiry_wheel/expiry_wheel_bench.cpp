@@ -0,0 +1,154 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+// Stale-aircraft bookkeeping for a 2,000-aircraft session: every aircraft re-arms its deadline on each
+// position update (5 Hz) and the expiry runs once per frame (60 Hz), with the plugin's 30 s timeout,
+// 1 s tick and 64 slots. A tenth of the aircraft go quiet part way through and have to expire. Compares
+// the wheel with the scan over every aircraft's last update it replaced, in simulated time.
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "expiry_wheel.h"
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	constexpr int64_t TIMEOUT = 30 * 1000; // [ms]
+	constexpr int64_t TICK = 1000;         // [ms]
+	constexpr size_t SLOTS = 64;
+	constexpr int64_t FRAME = 16;          // [ms]
+	constexpr int64_t UPDATE = 200;        // [ms]
+	constexpr int64_t DURATION = 120 * 1000; // [ms]
+
+	struct Aircraft
+	{
+		std::string Callsign;
+		int64_t NextUpdate;
+		int64_t Silent; // no updates from here on
+	};
+
+	struct Result
+	{
+		double UpdateNs = 0.0; // per position update
+		double FrameUs = 0.0;  // per expiry pass
+		size_t Expired = 0;
+	};
+
+	std::vector<Aircraft> Traffic(size_t count)
+	{
+		std::mt19937 random(1);
+		std::uniform_int_distribution<int64_t> phase(0, UPDATE - 1);
+		std::uniform_int_distribution<int64_t> silent(10 * 1000, DURATION - TIMEOUT - TICK);
+		std::vector<Aircraft> traffic;
+		for (size_t n = 0; n < count; n++)
+		{
+			traffic.push_back({ "SYN" + std::to_string(n), phase(random), n % 10 == 0 ? silent(random) : DURATION * 2 });
+		}
+		return traffic;
+	}
+
+	template<typename Store>
+	Result Run(size_t count, Store& store)
+	{
+		std::vector<Aircraft> traffic = Traffic(count);
+		Result result;
+		double updateNs = 0.0, frameNs = 0.0;
+		size_t updates = 0, frames = 0;
+		std::vector<std::string> expired;
+
+		for (int64_t now = 0; now < DURATION; now += FRAME)
+		{
+			const Clock::time_point updateStart = Clock::now();
+			for (Aircraft& aircraft : traffic)
+			{
+				if (aircraft.NextUpdate <= now && now < aircraft.Silent)
+				{
+					store.Update(aircraft.Callsign, now);
+					aircraft.NextUpdate += UPDATE;
+					updates++;
+				}
+			}
+			updateNs += std::chrono::duration<double, std::nano>(Clock::now() - updateStart).count();
+
+			const Clock::time_point frameStart = Clock::now();
+			expired.clear();
+			store.Expire(now, expired);
+			frameNs += std::chrono::duration<double, std::nano>(Clock::now() - frameStart).count();
+			frames++;
+			result.Expired += expired.size();
+		}
+
+		result.UpdateNs = updateNs / updates;
+		result.FrameUs = frameNs / frames / 1000.0;
+		return result;
+	}
+
+	struct Wheel
+	{
+		xpilot::ExpiryWheel<std::string> Deadlines{ TICK, SLOTS };
+
+		void Update(const std::string& callsign, int64_t now) { Deadlines.Arm(callsign, now + TIMEOUT); }
+		void Expire(int64_t now, std::vector<std::string>& expired) { Deadlines.Advance(now, expired); }
+	};
+
+	/// What the plugin did before: remember the last update and look at every aircraft each frame
+	struct Scan
+	{
+		std::unordered_map<std::string, int64_t> LastUpdated;
+
+		void Update(const std::string& callsign, int64_t now) { LastUpdated[callsign] = now; }
+
+		void Expire(int64_t now, std::vector<std::string>& expired)
+		{
+			for (auto it = LastUpdated.begin(); it != LastUpdated.end();)
+			{
+				if (now - it->second > TIMEOUT)
+				{
+					expired.push_back(it->first);
+					it = LastUpdated.erase(it);
+				}
+				else
+				{
+					++it;
+				}
+			}
+		}
+	};
+}
+
+int main(int argc, char** argv)
+{
+	const size_t count = argc > 1 ? std::stoul(argv[1]) : 2000;
+
+	Wheel wheel;
+	Scan scan;
+	const Result w = Run(count, wheel);
+	const Result s = Run(count, scan);
+
+	printf("aircraft=%zu simulated_s=%lld\n", count, static_cast<long long>(DURATION / 1000));
+	printf("%-8s %14s %14s %8s\n", "", "update ns", "expiry us", "expired");
+	printf("%-8s %14.1f %14.2f %8zu\n", "wheel", w.UpdateNs, w.FrameUs, w.Expired);
+	printf("%-8s %14.1f %14.2f %8zu\n", "scan", s.UpdateNs, s.FrameUs, s.Expired);
+	return w.Expired == s.Expired ? 0 : 1;
+}
@@ -0,0 +1,223 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+// Tests for the shared ExpiryWheel: arming, re-arming to a later and an earlier deadline, cancelling,
+// deadlines in the past, deadlines several revolutions out, and a randomised run checked against the
+// wheel's promise that keys expire no earlier than their deadline and at most one tick after it.
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "expiry_wheel.h"
+
+using xpilot::ExpiryWheel;
+
+namespace
+{
+	constexpr int64_t TICK = 100;
+	constexpr size_t SLOTS = 8; // one revolution is 800
+
+	int g_failures = 0;
+
+	void Expect(bool condition, const char* test, const char* what)
+	{
+		if (!condition)
+		{
+			fprintf(stderr, "%s: %s\n", test, what);
+			g_failures++;
+		}
+	}
+
+	std::vector<std::string> Advance(ExpiryWheel<std::string>& wheel, int64_t now)
+	{
+		std::vector<std::string> expired;
+		wheel.Advance(now, expired);
+		std::sort(expired.begin(), expired.end());
+		return expired;
+	}
+
+	using Keys = std::vector<std::string>;
+
+	void Arm()
+	{
+		ExpiryWheel<std::string> wheel(TICK, SLOTS);
+		wheel.Arm("A", 1000);
+		wheel.Arm("B", 1050);
+		Expect(wheel.Size() == 2, "arm", "both keys are armed");
+		Expect(Advance(wheel, 0).empty(), "arm", "nothing expires before its deadline");
+		Expect(Advance(wheel, 1000).empty(), "arm", "a deadline is rounded up to the next tick");
+		Expect(Advance(wheel, 1100) == Keys{ "A", "B" }, "arm", "both expire on the tick after their deadline");
+		Expect(Advance(wheel, 1200).empty(), "arm", "an expired key doesn't expire again");
+		Expect(wheel.Size() == 0, "arm", "expired keys are forgotten");
+	}
+
+	void Rearm()
+	{
+		ExpiryWheel<std::string> wheel(TICK, SLOTS);
+		Advance(wheel, 0);
+		wheel.Arm("A", 1000);
+		wheel.Arm("A", 2000);
+		Expect(wheel.Size() == 1, "rearm", "a re-armed key is armed once");
+		Expect(Advance(wheel, 1100).empty(), "rearm", "the earlier deadline no longer applies");
+		Expect(Advance(wheel, 2100) == Keys{ "A" }, "rearm", "the later deadline applies");
+
+		wheel.Arm("B", 4000);
+		wheel.Arm("B", 3000);
+		Expect(Advance(wheel, 3100) == Keys{ "B" }, "rearm", "re-arming to an earlier deadline moves the expiry forward");
+		Expect(Advance(wheel, 4100).empty(), "rearm", "the later entry left behind doesn't fire");
+
+		// re-armed every tick, like position updates, it never expires
+		for (int64_t now = 4200; now < 8000; now += TICK)
+		{
+			wheel.Arm("C", now + 500);
+			Expect(Advance(wheel, now).empty(), "rearm", "a key re-armed ahead of its deadline doesn't expire");
+		}
+		Expect(Advance(wheel, 8500) == Keys{ "C" }, "rearm", "it expires once the updates stop");
+	}
+
+	void Cancel()
+	{
+		ExpiryWheel<std::string> wheel(TICK, SLOTS);
+		wheel.Arm("A", 1000);
+		wheel.Arm("B", 1000);
+		wheel.Cancel("A");
+		wheel.Cancel("C");
+		Expect(wheel.Size() == 1, "cancel", "a cancelled key is no longer armed");
+		Expect(Advance(wheel, 1100) == Keys{ "B" }, "cancel", "a cancelled key doesn't expire");
+
+		wheel.Arm("A", 1500);
+		Expect(Advance(wheel, 1600) == Keys{ "A" }, "cancel", "a cancelled key can be armed again");
+
+		wheel.Arm("D", 2000);
+		wheel.Clear();
+		Expect(wheel.Size() == 0 && Advance(wheel, 5000).empty(), "cancel", "Clear cancels everything");
+	}
+
+	void Past()
+	{
+		ExpiryWheel<std::string> wheel(TICK, SLOTS);
+		Advance(wheel, 1000);
+		wheel.Arm("A", 500);
+		Expect(Advance(wheel, 1050).empty(), "past", "a past deadline waits for the next tick");
+		Expect(Advance(wheel, 1100) == Keys{ "A" }, "past", "and expires on it");
+	}
+
+	void WrapAround()
+	{
+		ExpiryWheel<std::string> wheel(TICK, SLOTS);
+		Advance(wheel, 0);
+		wheel.Arm("A", 2500); // three revolutions out, in the same slot as ticks 2, 10 and 18
+		wheel.Arm("B", 250);
+		wheel.Arm("C", 1050);
+		for (int64_t now = 100; now < 2600; now += TICK)
+		{
+			const Keys expired = Advance(wheel, now);
+			if (now == 300)
+				Expect(expired == Keys{ "B" }, "wrap", "B expires in the first revolution");
+			else if (now == 1100)
+				Expect(expired == Keys{ "C" }, "wrap", "C expires in the second revolution");
+			else
+				Expect(expired.empty(), "wrap", "A survives the revolutions before its own");
+		}
+		Expect(Advance(wheel, 2600) == Keys{ "A" }, "wrap", "A expires on its tick");
+
+		// a jump of several revolutions at once still visits every slot
+		wheel.Arm("D", 2700);
+		wheel.Arm("E", 3950);
+		wheel.Arm("F", 9000);
+		Expect(Advance(wheel, 6000) == Keys{ "D", "E" }, "wrap", "a long gap expires everything that was due");
+		Expect(Advance(wheel, 9100) == Keys{ "F" }, "wrap", "and keeps what wasn't");
+	}
+
+	void Randomised()
+	{
+		ExpiryWheel<std::string> wheel(TICK, SLOTS);
+		std::map<std::string, int64_t> deadlines;
+		std::mt19937 random(1);
+		std::uniform_int_distribution<int> key(0, 199);
+		std::uniform_int_distribution<int> action(0, 9);
+		std::uniform_int_distribution<int64_t> delay(-200, 3000); // up to almost four revolutions
+		std::uniform_int_distribution<int64_t> step(0, 250);
+		std::uniform_int_distribution<int> gap(0, 99);
+
+		int64_t now = 0;
+		Advance(wheel, now);
+		for (int round = 0; round < 20000; round++)
+		{
+			const std::string k = "K" + std::to_string(key(random));
+			const int a = action(random);
+			if (a < 7)
+			{
+				if (a == 0)
+				{
+					wheel.Arm(k, now + delay(random)); // leaves an entry behind that must not fire
+				}
+				const int64_t deadline = now + delay(random);
+				wheel.Arm(k, deadline);
+				deadlines[k] = std::max(deadline, now); // a deadline in the past counts from now
+			}
+			else if (a < 8)
+			{
+				wheel.Cancel(k);
+				deadlines.erase(k);
+			}
+
+			if (round % 5 == 0)
+			{
+				now += gap(random) == 0 ? 2000 + step(random) * 8 : step(random);
+				const Keys expired = Advance(wheel, now);
+				for (const std::string& e : expired)
+				{
+					const auto it = deadlines.find(e);
+					Expect(it != deadlines.end(), "random", "only armed keys expire");
+					if (it == deadlines.end())
+						continue;
+					Expect(it->second < now, "random", "keys never expire before their deadline");
+					deadlines.erase(it);
+				}
+				for (const auto& [armed, deadline] : deadlines)
+				{
+					Expect(deadline + TICK > now, "random", "keys expire at most one tick after their deadline");
+				}
+				Expect(wheel.Size() == deadlines.size(), "random", "the wheel and the model agree on the armed keys");
+			}
+		}
+	}
+}
+
+int main()
+{
+	Arm();
+	Rearm();
+	Cancel();
+	Past();
+	WrapAround();
+	Randomised();
+
+	if (g_failures > 0)
+	{
+		fprintf(stderr, "%d expectations failed\n", g_failures);
+		return 1;
+	}
+	printf("all passed\n");
+	return 0;
+}
@@ -0,0 +1,384 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+// Runs the plugin without X-Plane: the stub XPLM plays the simulator, frames are driven in real time and
+// traffic comes from an IPC recording (or a synthesized one) replayed through the socket worker, or from
+// a live client such as xpilot_soak in --serve mode. Prints the per-frame cost of the plugin and exits
+// non-zero when an --expect-* check fails, so CI can run it as a test.
+
+#include "stdafx.h"
+#include "xpilot.h"
+#include "terrain_cache.h"
+
+#include "synthetic_traffic.h"
+#include "xplm_stub.h"
+
+#include "XPMPMultiplayer.h"
+
+#include <filesystem>
+#include <unistd.h>
+
+PLUGIN_API int XPluginStart(char* outName, char* outSignature, char* outDescription);
+PLUGIN_API int XPluginEnable(void);
+PLUGIN_API void XPluginDisable(void);
+PLUGIN_API void XPluginStop(void);
+
+extern std::unique_ptr<xpilot::XPilot> environment;
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	struct Options
+	{
+		std::string Recording; // replay this instead of synthesized traffic
+		std::string WriteRecording; // keep the synthesized traffic
+		xpilot::SyntheticTrafficOptions Traffic;
+		bool Serve = false;
+		double ServeDuration = 30.0; // [s]
+		int Port = 53199;
+		double RenderTime = 1000.0 / 60.0; // [ms] the simulator's own share of every frame
+		std::string WorkDir;
+		bool Keep = false;
+		int ExpectAircraft = -1;
+		double ExpectBurstWorstFrame = -1.0; // [ms]
+	};
+
+	void Usage()
+	{
+		printf("usage: xpilot_headless [options]\n"
+			"  --recording FILE         replay an IPC recording (default: synthesize traffic)\n"
+			"  --aircraft N             synthesized aircraft (100)\n"
+			"  --duration S             synthesized traffic length [s] (30)\n"
+			"  --arrival S              spread the synthesized ADDs over S seconds (0 = one burst)\n"
+			"  --rate HZ                synthesized position updates per aircraft and second (5)\n"
+			"  --seed N                 synthesized traffic seed (1)\n"
+			"  --write-recording FILE   also save the synthesized traffic\n"
+			"  --serve S                no replay; listen for a client on --port for S seconds\n"
+			"  --port N                 TCP port of the plugin socket (53199)\n"
+			"  --render-ms MS           simulator time added to every frame (16.7)\n"
+			"  --work-dir DIR           plugin directory to create (a temporary one)\n"
+			"  --keep                   don't delete the plugin directory\n"
+			"  --expect-aircraft N      fail unless at least N aircraft were rendered at once\n"
+			"  --expect-burst-worst-frame-ms MS  fail if xpilot/aircraft_creation/burst_worst_frame_ms exceeds MS\n");
+	}
+
+	bool ParseOptions(int argc, char** argv, Options& options)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			const std::string arg = argv[i];
+			auto value = [&]() -> const char*
+			{
+				if (i + 1 >= argc)
+					throw std::invalid_argument(arg + " needs a value");
+				return argv[++i];
+			};
+
+			if (arg == "--recording") options.Recording = value();
+			else if (arg == "--aircraft") options.Traffic.Aircraft = std::stoi(value());
+			else if (arg == "--duration") options.Traffic.Duration = std::stod(value());
+			else if (arg == "--arrival") options.Traffic.ArrivalWindow = std::stod(value());
+			else if (arg == "--rate") options.Traffic.PositionRate = std::stod(value());
+			else if (arg == "--seed") options.Traffic.Seed = static_cast<uint32_t>(std::stoul(value()));
+			else if (arg == "--write-recording") options.WriteRecording = value();
+			else if (arg == "--serve") { options.Serve = true; options.ServeDuration = std::stod(value()); }
+			else if (arg == "--port") options.Port = std::stoi(value());
+			else if (arg == "--render-ms") options.RenderTime = std::stod(value());
+			else if (arg == "--work-dir") options.WorkDir = value();
+			else if (arg == "--keep") options.Keep = true;
+			else if (arg == "--expect-aircraft") options.ExpectAircraft = std::stoi(value());
+			else if (arg == "--expect-burst-worst-frame-ms") options.ExpectBurstWorstFrame = std::stod(value());
+			else
+			{
+				Usage();
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/// A minimal CSL package: one A320 whose object is empty, which is all XPMP2 needs to match and create aircraft
+	void WriteCslPackage(const fs::path& path)
+	{
+		fs::create_directories(path);
+		std::ofstream(path / "xsb_aircraft.txt") <<
+			"EXPORT_NAME Headless\n"
+			"OBJ8_AIRCRAFT A320\n"
+			"OBJ8 SOLID YES Headless/a320.obj\n"
+			"ICAO A320\n";
+		std::ofstream(path / "a320.obj") << "I\n800\nOBJ\n\nPOINT_COUNTS 0 0 0 0\n";
+	}
+
+	void WriteConfig(const fs::path& path, const fs::path& cslPackage, int port)
+	{
+		nlohmann::json config;
+		config["UseTcpSocket"] = true;
+		config["PluginPort"] = port;
+		config["DisableTcas"] = false;
+		config["EnableAircraftSounds"] = false;
+		config["CSL"] = nlohmann::json::array({ { { "Path", cslPackage.string() }, { "Enabled", true } } });
+		std::ofstream(path) << config.dump(1);
+	}
+
+	long ReadProcStatus(const char* key)
+	{
+		std::ifstream status("/proc/self/status");
+		std::string line;
+		while (std::getline(status, line))
+		{
+			if (line.rfind(key, 0) == 0)
+				return std::stol(line.substr(strlen(key) + 1));
+		}
+		return -1;
+	}
+
+	double Percentile(std::vector<double> values, double p)
+	{
+		if (values.empty())
+			return 0.0;
+		std::sort(values.begin(), values.end());
+		const size_t index = std::min(values.size() - 1, static_cast<size_t>(p * values.size()));
+		return values[index];
+	}
+
+	float ReadFloat(const char* dataRef)
+	{
+		return XPLMGetDataf(XPLMFindDataRef(dataRef));
+	}
+
+	int ReadInt(const char* dataRef)
+	{
+		return XPLMGetDatai(XPLMFindDataRef(dataRef));
+	}
+
+	class Simulator
+	{
+	public:
+		explicit Simulator(double renderTime) :
+			m_renderTime(std::chrono::duration<double, std::milli>(renderTime)),
+			m_last(std::chrono::steady_clock::now())
+		{
+		}
+
+		/// One frame: the plugin's flight loops, then the simulator's own work
+		void Frame()
+		{
+			const auto start = std::chrono::steady_clock::now();
+			const float elapsed = std::chrono::duration<float>(start - m_last).count();
+			m_last = start;
+
+			xplm_stub::RunFrame(elapsed);
+			const auto end = std::chrono::steady_clock::now();
+			m_workTimes.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+			const int aircraft = ReadInt("xpilot/num_aircraft");
+			if (aircraft > m_lastAircraft)
+			{
+				m_creationFrames++;
+				m_maxCreatedPerFrame = std::max(m_maxCreatedPerFrame, aircraft - m_lastAircraft);
+			}
+			m_lastAircraft = aircraft;
+			m_peakAircraft = std::max(m_peakAircraft, aircraft);
+
+			std::this_thread::sleep_until(end + m_renderTime);
+		}
+
+		void RunFor(double seconds)
+		{
+			const auto until = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+			while (std::chrono::steady_clock::now() < until)
+			{
+				Frame();
+			}
+		}
+
+		template<typename Predicate>
+		bool RunUntil(Predicate done, double timeout)
+		{
+			const auto until = std::chrono::steady_clock::now() + std::chrono::duration<double>(timeout);
+			while (!done())
+			{
+				if (std::chrono::steady_clock::now() >= until)
+					return false;
+				Frame();
+			}
+			return true;
+		}
+
+		void ResetStatistics()
+		{
+			m_workTimes.clear();
+			m_peakAircraft = 0;
+			m_creationFrames = 0;
+			m_maxCreatedPerFrame = 0;
+		}
+
+		const std::vector<double>& WorkTimes() const { return m_workTimes; }
+		int PeakAircraft() const { return m_peakAircraft; }
+		int CreationFrames() const { return m_creationFrames; }
+		int MaxCreatedPerFrame() const { return m_maxCreatedPerFrame; }
+
+	private:
+		std::chrono::duration<double, std::milli> m_renderTime;
+		std::chrono::steady_clock::time_point m_last;
+		std::vector<double> m_workTimes; // [ms] per frame
+		int m_peakAircraft = 0;
+		int m_lastAircraft = 0;
+		int m_creationFrames = 0; // frames in which aircraft were added
+		int m_maxCreatedPerFrame = 0;
+	};
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	try
+	{
+		if (!ParseOptions(argc, argv, options))
+			return 2;
+	}
+	catch (const std::exception& e)
+	{
+		fprintf(stderr, "%s\n", e.what());
+		Usage();
+		return 2;
+	}
+
+	const fs::path workDir = options.WorkDir.empty()
+		? fs::temp_directory_path() / ("xpilot_headless_" + std::to_string(getpid()))
+		: fs::path(options.WorkDir);
+	fs::remove_all(workDir);
+	fs::create_directories(workDir / "lin_x64");
+	fs::copy(XPILOT_RESOURCES_DIR, workDir / "Resources", fs::copy_options::recursive);
+	WriteCslPackage(workDir / "CSL" / "Headless");
+	WriteConfig(workDir / "Resources" / "Config.json", workDir / "CSL" / "Headless", options.Port);
+
+	size_t messageCount = 0;
+	if (!options.Serve)
+	{
+		std::vector<xpilot::RecordedMessage> messages;
+		if (!options.Recording.empty())
+		{
+			if (!xpilot::ReadIpcRecording(options.Recording, messages))
+			{
+				fprintf(stderr, "%s is not an IPC recording\n", options.Recording.c_str());
+				return 2;
+			}
+		}
+		else
+		{
+			messages = xpilot::SynthesizeTraffic(options.Traffic);
+			if (!options.WriteRecording.empty())
+			{
+				xpilot::WriteIpcRecording(options.WriteRecording, messages);
+			}
+		}
+		messageCount = messages.size();
+		xpilot::WriteIpcRecording((workDir / "Resources" / "ipc_recording.bin").string(), messages);
+	}
+
+	xplm_stub::SetPluginPath((workDir / "lin_x64" / "xPilot.xpl").string());
+	xplm_stub::SetSystemPath(workDir.string() + "/");
+	xplm_stub::SetReferencePoint(options.Traffic.CenterLatitude, options.Traffic.CenterLongitude);
+	xplm_stub::SetTerrainElevation(options.Traffic.FieldElevation);
+
+	char name[256], signature[256], description[256];
+	if (!XPluginStart(name, signature, description) || !XPluginEnable())
+	{
+		fprintf(stderr, "the plugin failed to start\n");
+		return 1;
+	}
+
+	Simulator sim(options.RenderTime);
+	int result = 0;
+	if (!sim.RunUntil([] { return XPMPGetNumberOfInstalledModels() > 0 && ReadInt("xpilot/num_aircraft") == 0; }, 30.0))
+	{
+		fprintf(stderr, "the CSL package wasn't loaded\n");
+		result = 1;
+	}
+	sim.ResetStatistics();
+
+	if (result == 0 && options.Serve)
+	{
+		printf("serving on tcp port %d for %.0f s\n", options.Port, options.ServeDuration);
+		fflush(stdout);
+		sim.RunFor(options.ServeDuration);
+	}
+	else if (result == 0)
+	{
+		if (!environment->StartIpcReplay())
+		{
+			fprintf(stderr, "the replay didn't start\n");
+			result = 1;
+		}
+		else
+		{
+			const double length = messageCount > 0 ? options.Traffic.Duration : 0.0;
+			if (!sim.RunUntil([] { return !environment->GetIpcRecording().IsReplaying(); }, length + 60.0))
+			{
+				fprintf(stderr, "the replay didn't finish\n");
+				result = 1;
+			}
+			sim.RunFor(0.5); // FinishIpcReplay is queued to the flight loop
+		}
+	}
+
+	const std::vector<double>& work = sim.WorkTimes();
+	const float burstWorstFrame = ReadFloat("xpilot/aircraft_creation/burst_worst_frame_ms");
+	printf("frames=%zu\n", work.size());
+	printf("messages=%zu\n", options.Serve ? static_cast<size_t>(ReadInt("xpilot/ipc/messages_received")) : messageCount);
+	printf("frame_ms_p50=%.3f\nframe_ms_p95=%.3f\nframe_ms_p99=%.3f\nframe_ms_max=%.3f\n",
+		Percentile(work, 0.50), Percentile(work, 0.95), Percentile(work, 0.99), Percentile(work, 1.0));
+	printf("peak_aircraft=%d\n", sim.PeakAircraft());
+	printf("final_aircraft=%d\n", ReadInt("xpilot/num_aircraft"));
+	printf("burst_size=%d\n", ReadInt("xpilot/aircraft_creation/burst_size"));
+	printf("burst_worst_frame_ms=%.3f\n", burstWorstFrame);
+	printf("creation_frames=%d\nmax_created_per_frame=%d\n", sim.CreationFrames(), sim.MaxCreatedPerFrame());
+	printf("render_ms=%.3f\n", options.RenderTime);
+	printf("terrain_probes=%llu\n", static_cast<unsigned long long>(xplm_stub::GetProbeCount()));
+	printf("terrain_cache_samples=%zu\n", xpilot::TerrainCache::GetInstance().GetSampleCount());
+	printf("xplm_calls_off_main_thread=%llu\n", static_cast<unsigned long long>(xplm_stub::GetForeignThreadCalls()));
+	printf("rss_kb=%ld\nrss_peak_kb=%ld\n", ReadProcStatus("VmRSS:"), ReadProcStatus("VmHWM:"));
+	fflush(stdout);
+
+	if (options.ExpectAircraft >= 0 && sim.PeakAircraft() < options.ExpectAircraft)
+	{
+		fprintf(stderr, "expected %d aircraft at once, saw %d\n", options.ExpectAircraft, sim.PeakAircraft());
+		result = 1;
+	}
+	if (options.ExpectBurstWorstFrame >= 0.0 && burstWorstFrame > options.ExpectBurstWorstFrame)
+	{
+		fprintf(stderr, "burst_worst_frame_ms %.3f exceeds %.3f\n", burstWorstFrame, options.ExpectBurstWorstFrame);
+		result = 1;
+	}
+	if (xplm_stub::GetForeignThreadCalls() > 0)
+	{
+		fprintf(stderr, "XPLM was called off the main thread\n");
+		result = 1;
+	}
+
+	XPluginDisable();
+	XPluginStop();
+
+	if (!options.Keep)
+	{
+		std::error_code ec;
+		fs::remove_all(workDir, ec);
+	}
+	return result;
+}
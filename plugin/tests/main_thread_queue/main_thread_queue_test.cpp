@@ -0,0 +1,321 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+// Tests for the flight loop's work queue: callbacks and aircraft commands run in the order they were queued,
+// only the newest position and heartbeat of an aircraft survive coalescing and adds and deletes are barriers
+// to it, commands that don't fit the full command queue are spilled (or dropped) without overtaking each
+// other, and the BoundedMpscQueue underneath hands every item of several producers over exactly once.
+
+#include "stdafx.h"
+#include "main_thread_queue.h"
+#include "ipc_metrics.h"
+
+#include <cstdio>
+#include <map>
+#include <thread>
+
+using namespace xpilot;
+
+namespace
+{
+	int g_failures = 0;
+
+	void Expect(bool condition, const char* test, const char* what)
+	{
+		if (!condition)
+		{
+			fprintf(stderr, "%s: %s\n", test, what);
+			g_failures++;
+		}
+	}
+
+	using Log = std::vector<std::string>;
+
+	const char* Name(AircraftCommandType type)
+	{
+		switch (type)
+		{
+			case AircraftCommandType::AddAircraft: return "add";
+			case AircraftCommandType::FastPosition: return "position";
+			case AircraftCommandType::Heartbeat: return "heartbeat";
+			case AircraftCommandType::AircraftConfig: return "config";
+			case AircraftCommandType::DeleteAircraft: return "delete";
+			case AircraftCommandType::DeleteAllAircraft: return "delete all";
+		}
+		return "";
+	}
+
+	/// A queue whose dispatched commands end up in the log as "<type> <callsign> <speed>"
+	struct LoggingQueue
+	{
+		Log Entries;
+		MainThreadQueue Queue{ [this](const AircraftCommand& command)
+		{
+			Entries.push_back(std::string(Name(command.Type)) + " " + command.Callsign + " " + std::to_string(static_cast<int>(command.Speed)));
+		} };
+
+		void Command(AircraftCommandType type, const char* callsign, int tag = 0)
+		{
+			AircraftCommand command;
+			command.Type = type;
+			AircraftCommand::CopyString(command.Callsign, callsign);
+			command.Speed = tag; // tells otherwise equal commands apart
+			Queue.QueueCommand(command);
+		}
+
+		void Callback(const std::string& name)
+		{
+			Queue.QueueCallback([this, name] { Entries.push_back(name); });
+		}
+
+		Log Invoke()
+		{
+			Entries.clear();
+			Queue.Invoke();
+			return Entries;
+		}
+	};
+
+	void Interleaving()
+	{
+		LoggingQueue q;
+		q.Callback("callback 1");
+		q.Command(AircraftCommandType::AddAircraft, "DAL1");
+		q.Callback("callback 2");
+		q.Command(AircraftCommandType::AircraftConfig, "DAL1");
+		q.Command(AircraftCommandType::FastPosition, "UAL2");
+		q.Callback("callback 3");
+		q.Callback("callback 4");
+		q.Command(AircraftCommandType::DeleteAircraft, "DAL1");
+		Expect(q.Invoke() == Log{ "callback 1", "add DAL1 0", "callback 2", "config DAL1 0", "position UAL2 0", "callback 3",
+			"callback 4", "delete DAL1 0" }, "interleaving", "callbacks and commands run in the order they were queued");
+		Expect(q.Invoke().empty(), "interleaving", "nothing runs twice");
+	}
+
+	void Coalescing()
+	{
+		LoggingQueue q;
+		q.Command(AircraftCommandType::FastPosition, "DAL1", 1);
+		q.Command(AircraftCommandType::Heartbeat, "DAL1", 1);
+		q.Command(AircraftCommandType::FastPosition, "UAL2", 1);
+		q.Command(AircraftCommandType::FastPosition, "DAL1", 2);
+		q.Command(AircraftCommandType::AircraftConfig, "DAL1", 1);
+		q.Command(AircraftCommandType::AircraftConfig, "DAL1", 2);
+		q.Command(AircraftCommandType::Heartbeat, "DAL1", 2);
+		q.Command(AircraftCommandType::FastPosition, "DAL1", 3);
+		Expect(q.Invoke() == Log{ "position UAL2 1", "config DAL1 1", "config DAL1 2", "heartbeat DAL1 2", "position DAL1 3" },
+			"coalescing", "only the newest position and heartbeat per aircraft are applied, every config is");
+	}
+
+	void Barriers()
+	{
+		LoggingQueue q;
+		q.Command(AircraftCommandType::FastPosition, "DAL1", 1);
+		q.Command(AircraftCommandType::Heartbeat, "DAL1", 1);
+		q.Command(AircraftCommandType::DeleteAircraft, "DAL1");
+		q.Command(AircraftCommandType::AddAircraft, "DAL1");
+		q.Command(AircraftCommandType::FastPosition, "DAL1", 2);
+		q.Command(AircraftCommandType::FastPosition, "DAL1", 3);
+		Expect(q.Invoke() == Log{ "position DAL1 1", "heartbeat DAL1 1", "delete DAL1 0", "add DAL1 0", "position DAL1 3" },
+			"barriers", "a delete and an add keep the position and heartbeat before them");
+
+		q.Command(AircraftCommandType::FastPosition, "DAL1", 4);
+		q.Command(AircraftCommandType::AddAircraft, "UAL2");
+		q.Command(AircraftCommandType::FastPosition, "DAL1", 5);
+		Expect(q.Invoke() == Log{ "add UAL2 0", "position DAL1 5" }, "barriers", "an add only holds its own aircraft");
+
+		q.Command(AircraftCommandType::FastPosition, "DAL1", 6);
+		q.Command(AircraftCommandType::FastPosition, "UAL2", 6);
+		q.Command(AircraftCommandType::DeleteAllAircraft, "");
+		q.Command(AircraftCommandType::FastPosition, "DAL1", 7);
+		q.Command(AircraftCommandType::FastPosition, "UAL2", 7);
+		Expect(q.Invoke() == Log{ "position DAL1 6", "position UAL2 6", "delete all  0", "position DAL1 7", "position UAL2 7" },
+			"barriers", "delete all holds every aircraft");
+	}
+
+	void Spill()
+	{
+		LoggingQueue q;
+		for (size_t i = 0; i < AIRCRAFT_COMMAND_QUEUE_CAPACITY; i++)
+		{
+			q.Command(AircraftCommandType::AircraftConfig, "UAL2", static_cast<int>(i));
+		}
+		q.Command(AircraftCommandType::AddAircraft, "DAL1");
+		q.Command(AircraftCommandType::FastPosition, "DAL1", 1);
+		q.Command(AircraftCommandType::AircraftConfig, "DAL1", 1);
+		q.Callback("callback");
+		q.Command(AircraftCommandType::DeleteAircraft, "DAL1");
+		const Log log = q.Invoke();
+		Expect(log.size() == AIRCRAFT_COMMAND_QUEUE_CAPACITY + 4, "spill", "only the position is dropped");
+		if (log.size() == AIRCRAFT_COMMAND_QUEUE_CAPACITY + 4)
+		{
+			Expect(log[0] == "config UAL2 0" && log[AIRCRAFT_COMMAND_QUEUE_CAPACITY - 1] == "config UAL2 4095",
+				"spill", "the queued commands run first");
+			Expect(Log(log.end() - 4, log.end()) == Log{ "add DAL1 0", "config DAL1 1", "callback", "delete DAL1 0" },
+				"spill", "spilled commands keep their place among the callbacks");
+		}
+
+		// a spill holds back everything behind it until the flight loop has taken it, even once there is room
+		for (size_t i = 0; i < AIRCRAFT_COMMAND_QUEUE_CAPACITY; i++)
+		{
+			q.Command(AircraftCommandType::AircraftConfig, "UAL2", static_cast<int>(i));
+		}
+		q.Command(AircraftCommandType::DeleteAircraft, "DAL1");
+		q.Invoke();
+		q.Command(AircraftCommandType::AddAircraft, "DAL1");
+		q.Command(AircraftCommandType::FastPosition, "DAL1", 2);
+		Expect(q.Invoke() == Log{ "add DAL1 0", "position DAL1 2" }, "spill", "the queue takes commands again after the spill ran");
+	}
+
+	/// Several producers push numbered items through a small queue while one consumer drains it
+	void MpscStress()
+	{
+		constexpr size_t PRODUCERS = 4;
+		constexpr uint64_t ITEMS = 200000; // per producer
+		BoundedMpscQueue<uint64_t, 64> queue;
+
+		std::vector<std::thread> producers;
+		for (size_t p = 0; p < PRODUCERS; p++)
+		{
+			producers.emplace_back([&queue, p]
+			{
+				for (uint64_t i = 0; i < ITEMS; i++)
+				{
+					while (!queue.TryPush((static_cast<uint64_t>(p) << 32) | i))
+					{
+						std::this_thread::yield();
+					}
+				}
+			});
+		}
+
+		std::vector<uint64_t> next(PRODUCERS, 0);
+		bool ordered = true;
+		uint64_t received = 0;
+		while (received < PRODUCERS * ITEMS)
+		{
+			uint64_t item;
+			if (!queue.TryPop(item))
+			{
+				std::this_thread::yield();
+				continue;
+			}
+			// keep draining after a mismatch, the producers only finish once everything was taken
+			const size_t producer = static_cast<size_t>(item >> 32) % PRODUCERS;
+			if ((item & 0xffffffff) != next[producer])
+			{
+				ordered = false;
+			}
+			next[producer] = (item & 0xffffffff) + 1;
+			received++;
+		}
+		for (auto& producer : producers)
+		{
+			producer.join();
+		}
+
+		uint64_t item;
+		Expect(ordered, "mpsc stress", "every producer's items arrive once and in order");
+		Expect(!queue.TryPop(item), "mpsc stress", "nothing is left over");
+		Expect(queue.ApproximateSize() == 0, "mpsc stress", "the queue reports empty");
+	}
+
+	/// The socket worker queues adds, positions and deletes faster than the flight loop takes them, so the
+	/// command queue keeps filling up; per aircraft, the applied commands have to stay in queued order.
+	/// Overtaking needs the producer to run twice within one Invoke, which takes more than one core to hit.
+	void SpillStress()
+	{
+		constexpr int AIRCRAFT = 64;
+		constexpr int ROUNDS = 400;
+
+		std::map<std::string, std::vector<AircraftCommand>> applied; // flight loop only
+		MainThreadQueue queue([&applied](const AircraftCommand& command)
+		{
+			applied[command.Callsign].push_back(command);
+		});
+
+		std::atomic<bool> producing{ true };
+		std::thread producer([&]
+		{
+			for (int round = 0; round < ROUNDS; round++)
+			{
+				for (int n = 0; n < AIRCRAFT; n++)
+				{
+					AircraftCommand command;
+					AircraftCommand::CopyString(command.Callsign, "DAL" + std::to_string(n));
+					command.Speed = round;
+					for (AircraftCommandType type : { AircraftCommandType::AddAircraft, AircraftCommandType::FastPosition,
+						AircraftCommandType::AircraftConfig, AircraftCommandType::DeleteAircraft })
+					{
+						command.Type = type;
+						queue.QueueCommand(command);
+					}
+				}
+			}
+			producing = false;
+		});
+
+		while (producing)
+		{
+			queue.Invoke();
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+		}
+		producer.join();
+		queue.Invoke();
+
+		bool ordered = true, complete = true;
+		for (const auto& [callsign, commands] : applied)
+		{
+			int adds = 0, deletes = 0;
+			for (size_t i = 0; i < commands.size(); i++)
+			{
+				if (i > 0 && commands[i].Sequence <= commands[i - 1].Sequence)
+					ordered = false;
+				if (commands[i].Type == AircraftCommandType::AddAircraft)
+					adds++;
+				if (commands[i].Type == AircraftCommandType::DeleteAircraft)
+					deletes++;
+			}
+			if (adds != ROUNDS || deletes != ROUNDS)
+				complete = false;
+		}
+		Expect(applied.size() == AIRCRAFT, "spill stress", "every aircraft was seen");
+		Expect(ordered, "spill stress", "no command overtakes an earlier one of the same aircraft");
+		Expect(complete, "spill stress", "no add or delete is lost");
+	}
+}
+
+int main()
+{
+	Interleaving();
+	Coalescing();
+	Barriers();
+	Spill();
+	MpscStress();
+	SpillStress();
+	printf("spilled=%llu\ndropped=%llu\n", static_cast<unsigned long long>(IpcMetrics::GetInstance().QueueFullSpilled.load()),
+		static_cast<unsigned long long>(IpcMetrics::GetInstance().QueueFullDropped.load()));
+
+	if (g_failures > 0)
+	{
+		fprintf(stderr, "%d expectations failed\n", g_failures);
+		return 1;
+	}
+	printf("all passed\n");
+	return 0;
+}
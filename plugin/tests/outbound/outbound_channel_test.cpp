@@ -0,0 +1,226 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+// Tests for the outbound path to the client against a peer that stops reading: once the queue is full,
+// coalesced messages keep only the latest per key, droppable ones are counted in OutboundDropped, the
+// backlog sheds its oldest messages at its limit, and once the peer reads again everything that was kept
+// arrives in the order it was queued.
+
+#include "stdafx.h"
+#include "outbound_queue.h"
+#include "ipc_metrics.h"
+
+#include <cstdio>
+
+using namespace xpilot;
+
+namespace
+{
+	int g_failures = 0;
+
+	void Expect(bool condition, const char* test, const char* what)
+	{
+		if (!condition)
+		{
+			fprintf(stderr, "%s: %s\n", test, what);
+			g_failures++;
+		}
+	}
+
+	using Messages = std::vector<std::string>;
+
+	/// The client end of the pipe; while it doesn't read, every send is refused like nng's EAGAIN
+	struct Peer
+	{
+		bool Reading = false;
+		Messages Received;
+		size_t Refused = 0;
+
+		bool Send(const OutboundMessage& message)
+		{
+			if (!Reading)
+			{
+				Refused++;
+				return false;
+			}
+			Received.push_back(message.Data);
+			return true;
+		}
+	};
+
+	struct Channel
+	{
+		Peer Client;
+		OutboundChannel Outbound{ [this](const OutboundMessage& message) { return Client.Send(message); } };
+
+		void Queue(OutboundPolicy policy, const std::string& data, const std::string& key = "")
+		{
+			OutboundMessage message;
+			message.Policy = policy;
+			message.Key = key;
+			message.Data = data;
+			Outbound.Queue(std::move(message));
+		}
+
+		/// One flight loop frame followed by a pass of the socket worker
+		void Frame()
+		{
+			Outbound.FlushBacklog();
+			Outbound.Drain();
+		}
+	};
+
+	std::string Retry(size_t n)
+	{
+		return "retry " + std::to_string(n);
+	}
+
+	uint64_t Dropped()
+	{
+		return IpcMetrics::GetInstance().OutboundDropped.load();
+	}
+
+	uint64_t Coalesced()
+	{
+		return IpcMetrics::GetInstance().OutboundCoalesced.load();
+	}
+
+	void ReadingPeer()
+	{
+		Channel c;
+		c.Client.Reading = true;
+		c.Queue(OutboundPolicy::Retry, "a");
+		c.Queue(OutboundPolicy::Coalesce, "b", "DAL1");
+		c.Queue(OutboundPolicy::Drop, "c");
+		c.Frame();
+		Expect(c.Client.Received == Messages{ "a", "b", "c" }, "reading peer", "everything is sent in order");
+	}
+
+	void StalledPeer()
+	{
+		Channel c;
+		const uint64_t dropped = Dropped();
+		const uint64_t coalesced = Coalesced();
+
+		// the socket worker takes the first message and keeps it pending, the queue fills up behind it
+		Messages expected;
+		for (size_t i = 0; i <= OUTBOUND_QUEUE_CAPACITY; i++)
+		{
+			c.Queue(OutboundPolicy::Retry, Retry(i));
+			expected.push_back(Retry(i));
+			if (i == 0)
+				c.Frame();
+		}
+		Expect(c.Client.Refused == 1, "stalled peer", "the head message was offered once");
+
+		c.Queue(OutboundPolicy::Coalesce, "added DAL1 1", "DAL1");
+		c.Queue(OutboundPolicy::Drop, "metar KSEA");
+		c.Queue(OutboundPolicy::Coalesce, "added UAL2 1", "UAL2");
+		c.Queue(OutboundPolicy::Retry, "text");
+		c.Queue(OutboundPolicy::Coalesce, "deleted DAL1 2", "DAL1");
+		c.Queue(OutboundPolicy::Drop, "station info");
+		c.Queue(OutboundPolicy::Coalesce, "added DAL1 3", "DAL1");
+		for (int frame = 0; frame < 10; frame++)
+		{
+			c.Frame();
+		}
+		Expect(Dropped() - dropped == 2, "stalled peer", "both droppable messages were counted as dropped");
+		Expect(Coalesced() - coalesced == 2, "stalled peer", "the later DAL1 notices replaced the held back one");
+		Expect(c.Client.Received.empty(), "stalled peer", "nothing gets through while the peer isn't reading");
+
+		// the coalesced message keeps the place of the first one with its key
+		expected.insert(expected.end(), { "added DAL1 3", "added UAL2 1", "text" });
+		c.Client.Reading = true;
+		for (int frame = 0; frame < 10; frame++)
+		{
+			c.Frame();
+		}
+		Expect(c.Client.Received == expected, "stalled peer", "what was kept arrives in queued order once the peer reads");
+		Expect(Dropped() - dropped == 2, "stalled peer", "nothing else was dropped");
+	}
+
+	void BacklogLimit()
+	{
+		Channel c;
+		const uint64_t dropped = Dropped();
+
+		constexpr size_t OVERFLOW = 10;
+		const size_t count = OUTBOUND_QUEUE_CAPACITY + OUTBOUND_BACKLOG_CAPACITY + OVERFLOW;
+		for (size_t i = 0; i < count; i++)
+		{
+			c.Queue(OutboundPolicy::Retry, Retry(i));
+		}
+		Expect(Dropped() - dropped == OVERFLOW, "backlog limit", "the backlog sheds one message per message over its limit");
+
+		c.Client.Reading = true;
+		while (c.Client.Received.size() < count - OVERFLOW)
+		{
+			const size_t before = c.Client.Received.size();
+			c.Frame();
+			if (c.Client.Received.size() == before)
+				break;
+		}
+
+		// the queue kept the oldest messages, the backlog lost the oldest of its own
+		Messages expected;
+		for (size_t i = 0; i < count; i++)
+		{
+			if (i < OUTBOUND_QUEUE_CAPACITY || i >= OUTBOUND_QUEUE_CAPACITY + OVERFLOW)
+				expected.push_back(Retry(i));
+		}
+		Expect(c.Client.Received == expected, "backlog limit", "the rest arrives in order");
+	}
+
+	void Close()
+	{
+		Channel c;
+		for (size_t i = 0; i < OUTBOUND_QUEUE_CAPACITY + 5; i++)
+		{
+			c.Queue(OutboundPolicy::Retry, Retry(i));
+		}
+		c.Outbound.Close();
+		Expect(c.Client.Received.empty() && c.Client.Refused == 1, "close", "a peer that doesn't read is offered one message");
+
+		Channel d;
+		Messages expected;
+		for (size_t i = 0; i < OUTBOUND_QUEUE_CAPACITY + 5; i++)
+		{
+			d.Queue(OutboundPolicy::Retry, Retry(i));
+			expected.push_back(Retry(i));
+		}
+		d.Client.Reading = true;
+		d.Outbound.Close();
+		Expect(d.Client.Received == expected, "close", "a reading peer gets the queue and the backlog in order");
+	}
+}
+
+int main()
+{
+	ReadingPeer();
+	StalledPeer();
+	BacklogLimit();
+	Close();
+
+	if (g_failures > 0)
+	{
+		fprintf(stderr, "%d expectations failed\n", g_failures);
+		return 1;
+	}
+	printf("all passed\n");
+	return 0;
+}
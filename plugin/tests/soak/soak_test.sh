@@ -0,0 +1,44 @@
+#!/bin/sh
+# Runs xpilot_soak against a headless plugin serving on the given port, then checks that the plugin
+# received every message the client sent, rendered every aircraft of a cycle and none were left over
+# after the closing DELETE_ALL. Timings (ping round trips, frame times) are only reported.
+# usage: soak_test.sh XPILOT_HEADLESS XPILOT_SOAK PORT [xpilot_soak options...]
+headless="$1"
+soak="$2"
+port="$3"
+shift 3
+
+out=$(mktemp -d) || exit 1
+trap 'rm -rf "$out"' EXIT
+
+"$headless" --serve 40 --port "$port" > "$out/headless.txt" &
+pid=$!
+"$soak" --port "$port" --pid "$pid" "$@" > "$out/soak.txt"
+result=$?
+wait "$pid" || result=1
+cat "$out/soak.txt" "$out/headless.txt"
+
+value() {
+	sed -n "s/^$2=//p" "$out/$1.txt"
+}
+
+sent=$(value soak sent_total)
+received=$(value headless messages)
+if [ -z "$sent" ] || [ "$sent" != "$received" ]; then
+	echo "the client sent ${sent:-?} messages, the plugin received ${received:-?}" >&2
+	result=1
+fi
+
+aircraft=$(value soak aircraft_per_cycle)
+peak=$(value headless peak_aircraft)
+if [ -z "$aircraft" ] || [ "$aircraft" != "$peak" ]; then
+	echo "expected ${aircraft:-?} aircraft at once, saw ${peak:-?}" >&2
+	result=1
+fi
+
+remaining=$(value headless final_aircraft)
+if [ "$remaining" != "0" ]; then
+	echo "${remaining:-?} aircraft were left after DELETE_ALL" >&2
+	result=1
+fi
+exit $result
@@ -0,0 +1,415 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+// Stands in for the client: dials the plugin over nng pair1 like the client does and streams synthetic
+// traffic at a configurable rate. Every cycle deletes all aircraft and adds a fresh set, so a long run
+// exercises creation and teardown as well as the position path. Reports the send rate, sends that nng
+// refused (the client drops those too), the round trip of a PLUGIN_VER ping under load and the
+// resident memory of the plugin's process. Exits non-zero when an --expect-* check fails.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nng/nng.h>
+#include <nng/protocol/pair1/pair.h>
+
+#include "synthetic_traffic.h"
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	struct Options
+	{
+		std::string Url;
+		int Port = 53100;
+		int Pid = 0; // plugin process to watch
+		xpilot::SyntheticTrafficOptions Traffic;
+		double Cycle = 60.0; // [s] aircraft lifetime before they are replaced
+		double Duration = 60.0; // [s]
+		double Report = 5.0; // [s]
+		double ConnectTimeout = 30.0; // [s]
+		long ExpectMaxDrops = -1;
+		double ExpectMaxRtt = -1.0; // [ms] p99
+		long ExpectMaxRssGrowth = -1; // [kB] plugin, from the end of the first cycle to the end of the run
+	};
+
+	void Usage()
+	{
+		printf("usage: xpilot_soak [options]\n"
+			"  --url URL                 plugin endpoint (tcp://127.0.0.1:PORT)\n"
+			"  --port N                  plugin TCP port (53100)\n"
+			"  --pid N                   watch the memory of this process, e.g. xpilot_headless\n"
+			"  --aircraft N              aircraft per cycle (500)\n"
+			"  --rate HZ                 position updates per aircraft and second (5)\n"
+			"  --arrival S               spread the ADDs of a cycle over S seconds (10)\n"
+			"  --cycle S                 replace all aircraft every S seconds (60)\n"
+			"  --duration S              run time (60)\n"
+			"  --report S                progress line interval (5)\n"
+			"  --connect-timeout S       give up when the plugin doesn't answer (30)\n"
+			"  --expect-max-drops N      fail when more sends are refused\n"
+			"  --expect-max-rtt-ms MS    fail when the p99 ping round trip is longer\n"
+			"  --expect-max-rss-growth-kb KB  fail when the plugin process grows more after the first cycle\n");
+	}
+
+	bool ParseOptions(int argc, char** argv, Options& options)
+	{
+		options.Traffic.Aircraft = 500;
+		options.Traffic.ArrivalWindow = 10.0;
+		for (int i = 1; i < argc; i++)
+		{
+			const std::string arg = argv[i];
+			auto value = [&]() -> const char*
+			{
+				if (i + 1 >= argc)
+					throw std::invalid_argument(arg + " needs a value");
+				return argv[++i];
+			};
+
+			if (arg == "--url") options.Url = value();
+			else if (arg == "--port") options.Port = std::stoi(value());
+			else if (arg == "--pid") options.Pid = std::stoi(value());
+			else if (arg == "--aircraft") options.Traffic.Aircraft = std::stoi(value());
+			else if (arg == "--rate") options.Traffic.PositionRate = std::stod(value());
+			else if (arg == "--arrival") options.Traffic.ArrivalWindow = std::stod(value());
+			else if (arg == "--cycle") options.Cycle = std::stod(value());
+			else if (arg == "--duration") options.Duration = std::stod(value());
+			else if (arg == "--report") options.Report = std::stod(value());
+			else if (arg == "--connect-timeout") options.ConnectTimeout = std::stod(value());
+			else if (arg == "--expect-max-drops") options.ExpectMaxDrops = std::stol(value());
+			else if (arg == "--expect-max-rtt-ms") options.ExpectMaxRtt = std::stod(value());
+			else if (arg == "--expect-max-rss-growth-kb") options.ExpectMaxRssGrowth = std::stol(value());
+			else
+			{
+				Usage();
+				return false;
+			}
+		}
+		if (options.Url.empty())
+		{
+			options.Url = "tcp://127.0.0.1:" + std::to_string(options.Port);
+		}
+		options.Traffic.Duration = options.Cycle;
+		return true;
+	}
+
+	long ReadRss(int pid)
+	{
+		std::ifstream status(pid > 0 ? "/proc/" + std::to_string(pid) + "/status" : std::string("/proc/self/status"));
+		std::string line;
+		while (std::getline(status, line))
+		{
+			if (line.rfind("VmRSS:", 0) == 0)
+				return std::stol(line.substr(6));
+		}
+		return -1;
+	}
+
+	int64_t UnixMillis()
+	{
+		using namespace std::chrono;
+		return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+	}
+
+	double Percentile(std::vector<double> values, double p)
+	{
+		if (values.empty())
+			return 0.0;
+		std::sort(values.begin(), values.end());
+		return values[std::min(values.size() - 1, static_cast<size_t>(p * values.size()))];
+	}
+
+	/// Ping round trips: one PLUGIN_VER request in flight at a time, answered from the plugin's socket worker
+	class Pinger
+	{
+	public:
+		bool Due(Clock::time_point now)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_inFlight && now - m_sent < std::chrono::seconds(5))
+				return false;
+			return now - m_sent >= std::chrono::milliseconds(100);
+		}
+
+		void Sent(Clock::time_point now)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_sent = now;
+			m_inFlight = true;
+		}
+
+		void Answered(Clock::time_point now)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!m_inFlight)
+				return;
+			m_inFlight = false;
+			m_window.push_back(std::chrono::duration<double, std::milli>(now - m_sent).count());
+			m_answers++;
+		}
+
+		/// Round trips since the last call
+		std::vector<double> Take()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			std::vector<double> window;
+			window.swap(m_window);
+			return window;
+		}
+
+		uint64_t Answers()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_answers;
+		}
+
+	private:
+		std::mutex m_mutex;
+		Clock::time_point m_sent{};
+		bool m_inFlight = false;
+		std::vector<double> m_window; // [ms]
+		uint64_t m_answers = 0;
+	};
+
+	template<typename T>
+	std::vector<char> Encode(const T& dto)
+	{
+		msgpack::sbuffer buffer;
+		encodeDto(buffer, dto);
+		return std::vector<char>(buffer.data(), buffer.data() + buffer.size());
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	try
+	{
+		if (!ParseOptions(argc, argv, options))
+			return 2;
+	}
+	catch (const std::exception& e)
+	{
+		fprintf(stderr, "%s\n", e.what());
+		Usage();
+		return 2;
+	}
+
+	nng_socket socket;
+	int rv;
+	if ((rv = nng_pair1_open(&socket)) != 0)
+	{
+		fprintf(stderr, "nng_pair1_open: %s\n", nng_strerror(rv));
+		return 1;
+	}
+	// the same buffers as the client's
+	nng_setopt_int(socket, NNG_OPT_RECVBUF, 8192);
+	nng_setopt_int(socket, NNG_OPT_SENDBUF, 8192);
+	nng_setopt_ms(socket, NNG_OPT_RECVTIMEO, 100);
+	if ((rv = nng_dial(socket, options.Url.c_str(), NULL, NNG_FLAG_NONBLOCK)) != 0)
+	{
+		fprintf(stderr, "nng_dial %s: %s\n", options.Url.c_str(), nng_strerror(rv));
+		return 1;
+	}
+
+	Pinger pinger;
+	std::atomic<bool> running{ true };
+	std::atomic<uint64_t> received{ 0 };
+	std::thread receiver([&]
+	{
+		while (running)
+		{
+			char* buffer;
+			size_t length;
+			if (nng_recv(socket, &buffer, &length, NNG_FLAG_ALLOC) != 0)
+				continue;
+			received++;
+			try
+			{
+				BaseDto dto;
+				msgpack::unpack(buffer, length).get().convert(dto);
+				if (dto.type == dto::PLUGIN_VER)
+				{
+					pinger.Answered(Clock::now());
+				}
+			}
+			catch (const msgpack::type_error&) {}
+			nng_free(buffer, length);
+		}
+	});
+
+	const std::vector<char> ping = Encode(PluginVersionDto{});
+	uint64_t sent = 0, drops = 0, pingDrops = 0;
+	auto send = [&](const std::vector<char>& data) -> bool
+	{
+		if (nng_send(socket, const_cast<char*>(data.data()), data.size(), NNG_FLAG_NONBLOCK) != 0)
+			return false;
+		sent++;
+		return true;
+	};
+
+	// the plugin answers once it is listening; nothing counts until then
+	const Clock::time_point connectStart = Clock::now();
+	while (pinger.Answers() == 0)
+	{
+		if (Clock::now() - connectStart > std::chrono::duration<double>(options.ConnectTimeout))
+		{
+			fprintf(stderr, "no answer from %s\n", options.Url.c_str());
+			running = false;
+			receiver.join();
+			nng_close(socket);
+			return 1;
+		}
+		if (pinger.Due(Clock::now()) && send(ping))
+		{
+			pinger.Sent(Clock::now());
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	pinger.Take();
+	// every send nng accepted reaches the plugin, so the plugin's message count has to match this
+	const uint64_t connectSent = sent;
+	sent = 0;
+
+	printf("soak: %d aircraft per %.0f s cycle at %.1f Hz against %s for %.0f s\n", options.Traffic.Aircraft, options.Cycle,
+		options.Traffic.PositionRate, options.Url.c_str(), options.Duration);
+	fflush(stdout);
+
+	constexpr double TICK = 0.01; // [s]
+	const Clock::time_point start = Clock::now();
+	const long rssStart = ReadRss(options.Pid);
+	long rssAfterFirstCycle = -1;
+	long rssPeak = rssStart;
+	std::vector<double> roundTrips;
+	std::vector<xpilot::RecordedMessage> batch;
+	uint64_t lastSent = 0;
+	double lastReport = 0.0;
+	int cycle = -1;
+	std::unique_ptr<xpilot::SyntheticTraffic> traffic;
+
+	for (double now = 0.0; now < options.Duration; now += TICK)
+	{
+		const int currentCycle = static_cast<int>(now / options.Cycle);
+		if (currentCycle != cycle)
+		{
+			if (cycle == 0)
+			{
+				rssAfterFirstCycle = ReadRss(options.Pid);
+			}
+			cycle = currentCycle;
+			xpilot::SyntheticTrafficOptions cycleOptions = options.Traffic;
+			cycleOptions.Seed = options.Traffic.Seed + cycle;
+			traffic = std::make_unique<xpilot::SyntheticTraffic>(cycleOptions);
+		}
+
+		const double cycleStart = cycle * options.Cycle;
+		batch.clear();
+		traffic->Generate(now - cycleStart, now - cycleStart + TICK, batch);
+		for (const xpilot::RecordedMessage& message : batch)
+		{
+			if (!send(message.Data))
+			{
+				drops++;
+			}
+		}
+		if (pinger.Due(Clock::now()))
+		{
+			if (send(ping))
+			{
+				pinger.Sent(Clock::now());
+			}
+			else
+			{
+				pingDrops++;
+			}
+		}
+
+		std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(now + TICK)));
+
+		if (now + TICK - lastReport >= options.Report)
+		{
+			const std::vector<double> window = pinger.Take();
+			roundTrips.insert(roundTrips.end(), window.begin(), window.end());
+			const long rss = ReadRss(options.Pid);
+			rssPeak = std::max(rssPeak, rss);
+			printf("t=%.0fs sent/s=%.0f drops=%llu rtt_ms p50=%.2f p99=%.2f rss_kb=%ld\n", now + TICK,
+				(sent - lastSent) / (now + TICK - lastReport), static_cast<unsigned long long>(drops),
+				Percentile(window, 0.50), Percentile(window, 0.99), rss);
+			fflush(stdout);
+			lastSent = sent;
+			lastReport = now + TICK;
+		}
+	}
+
+	// take the remaining aircraft down like a disconnect would
+	send(Encode(DeleteAllAircraftDto{}));
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	running = false;
+	receiver.join();
+	nng_close(socket);
+
+	const std::vector<double> window = pinger.Take();
+	roundTrips.insert(roundTrips.end(), window.begin(), window.end());
+	const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+	const long rssEnd = ReadRss(options.Pid);
+	rssPeak = std::max(rssPeak, rssEnd);
+	const long rssGrowth = rssAfterFirstCycle >= 0 ? rssEnd - rssAfterFirstCycle : 0;
+
+	printf("aircraft_per_cycle=%d\n", options.Traffic.Aircraft);
+	printf("sent=%llu\n", static_cast<unsigned long long>(sent));
+	printf("sent_total=%llu\n", static_cast<unsigned long long>(connectSent + sent));
+	printf("sent_per_sec=%.0f\n", sent / elapsed);
+	printf("received=%llu\n", static_cast<unsigned long long>(received.load()));
+	printf("drops=%llu\n", static_cast<unsigned long long>(drops));
+	printf("ping_drops=%llu\n", static_cast<unsigned long long>(pingDrops));
+	printf("rtt_ms_p50=%.3f\nrtt_ms_p95=%.3f\nrtt_ms_p99=%.3f\nrtt_ms_max=%.3f\n", Percentile(roundTrips, 0.50),
+		Percentile(roundTrips, 0.95), Percentile(roundTrips, 0.99), Percentile(roundTrips, 1.0));
+	printf("rss_kb_start=%ld\nrss_kb_after_first_cycle=%ld\nrss_kb_end=%ld\nrss_kb_peak=%ld\n", rssStart, rssAfterFirstCycle, rssEnd, rssPeak);
+	fflush(stdout);
+
+	int result = 0;
+	if (roundTrips.empty())
+	{
+		fprintf(stderr, "the plugin stopped answering\n");
+		result = 1;
+	}
+	if (options.ExpectMaxDrops >= 0 && drops > static_cast<uint64_t>(options.ExpectMaxDrops))
+	{
+		fprintf(stderr, "%llu sends were refused, expected at most %ld\n", static_cast<unsigned long long>(drops), options.ExpectMaxDrops);
+		result = 1;
+	}
+	if (options.ExpectMaxRtt >= 0.0 && Percentile(roundTrips, 0.99) > options.ExpectMaxRtt)
+	{
+		fprintf(stderr, "p99 round trip %.3f ms exceeds %.3f ms\n", Percentile(roundTrips, 0.99), options.ExpectMaxRtt);
+		result = 1;
+	}
+	if (options.ExpectMaxRssGrowth >= 0 && rssGrowth > options.ExpectMaxRssGrowth)
+	{
+		fprintf(stderr, "the plugin grew by %ld kB after the first cycle, expected at most %ld kB\n", rssGrowth, options.ExpectMaxRssGrowth);
+		result = 1;
+	}
+	return result;
+}
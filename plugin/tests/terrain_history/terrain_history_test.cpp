@@ -0,0 +1,294 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+// Replays recorded client traffic (the XPIPC1 format of IpcRecording) through the terrain elevation history
+// twice, once with TerrainElevationHistory and once with the std::list implementation it replaced, and checks
+// that both hold the same samples and reach the same usable decision after every position update.
+// Terrain is a synthetic swell, steep enough in places to fail the slope checks. Without arguments it records
+// synthetic traffic at 5 and 25 updates per second (the history holds 64 samples); recordings made by the
+// plugin can be passed as arguments.
+
+#include "stdafx.h"
+#include "terrain_elevation_history.h"
+#include "geo_calc.hpp"
+#include "synthetic_traffic.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <list>
+#include <map>
+
+using namespace xpilot;
+
+namespace
+{
+	constexpr double MAX_USABLE_ALTITUDE_AGL = 100.0; // [ft] as in network_aircraft.h
+
+	/// The history as it was before the ring buffer, verbatim apart from being split into the same three calls
+	class ListTerrainElevationHistory
+	{
+	public:
+		void Trim(double currentTimestamp)
+		{
+			m_samples.remove_if([&](TerrainElevationData& meta)
+			{
+				return meta.Timestamp < (currentTimestamp - TERRAIN_ELEVATION_DATA_USABLE_AGE + 250);
+			});
+		}
+
+		void Record(const TerrainElevationData& sample)
+		{
+			m_samples.push_back(sample);
+		}
+
+		bool IsUsable() const
+		{
+			if (m_samples.size() < 2)
+			{
+				return false;
+			}
+
+			auto startSample = m_samples.front();
+			auto endSample = m_samples.back();
+			if ((endSample.Timestamp - startSample.Timestamp) < TERRAIN_ELEVATION_DATA_USABLE_AGE)
+			{
+				return false;
+			}
+
+			double distance = DegreesToFeet(GreatCircleDistance(
+				startSample.Location.Longitude, startSample.Location.Latitude,
+				endSample.Location.Longitude, endSample.Location.Latitude));
+			double remoteElevationDelta = abs(startSample.RemoteValue - endSample.RemoteValue);
+			double localElevationDelta = abs(startSample.LocalValue - endSample.LocalValue);
+			double remoteSlope = RadiansToDegrees(atan(remoteElevationDelta / distance));
+			if (remoteSlope > TERRAIN_ELEVATION_MAX_SLOPE)
+			{
+				return false;
+			}
+			double localSlope = RadiansToDegrees(atan(localElevationDelta / distance));
+			if (localSlope > TERRAIN_ELEVATION_MAX_SLOPE)
+			{
+				return false;
+			}
+			return true;
+		}
+
+		const std::list<TerrainElevationData>& Samples() const { return m_samples; }
+
+	private:
+		std::list<TerrainElevationData> m_samples;
+	};
+
+	/// [ft] a swell with a wavelength of about 500 m. The slope checks take the distance between the samples
+	/// 60 times too long (GreatCircleDistance returns nautical miles, which DegreesToFeet reads as degrees),
+	/// so the swell is 60 times higher than one that would be steep enough on its own.
+	double TerrainElevation(double lat, double lon)
+	{
+		return 13.0 + 60.0 * 20.0 * std::sin(DegreesToMeters(lat) / 80.0) * std::cos(DegreesToMeters(lon) * 0.8 / 80.0);
+	}
+
+	bool SameSample(const TerrainElevationData& a, const TerrainElevationData& b)
+	{
+		return std::memcmp(&a, &b, sizeof(TerrainElevationData)) == 0; // copied from the same value
+	}
+
+	struct Stats
+	{
+		size_t Updates = 0;
+		size_t Recorded = 0;
+		size_t Usable = 0;
+		size_t Steep = 0; // spanned the usable age but failed a slope check
+		size_t MaxSamples = 0;
+		size_t Mismatches = 0;
+	};
+
+	/// Replays the recording with the history trimmed trimLead ms behind the update; a lead of 500 ms widens
+	/// the kept window past TERRAIN_ELEVATION_DATA_USABLE_AGE so the span and slope checks are reached
+	Stats Replay(const std::vector<RecordedMessage>& messages, double trimLead)
+	{
+		struct Aircraft
+		{
+			QuantizedPosition Position{};
+			TerrainElevationHistory Ring;
+			ListTerrainElevationHistory List;
+		};
+		std::map<std::string, Aircraft> aircraft;
+		Stats stats;
+
+		for (const RecordedMessage& message : messages)
+		{
+			BaseDto dto;
+			try
+			{
+				msgpack::unpack(message.Data.data(), message.Data.size()).get().convert(dto);
+			}
+			catch (const msgpack::type_error&)
+			{
+				continue;
+			}
+
+			std::string callsign;
+			if (dto.type == dto::FAST_POSITION_UPDATE)
+			{
+				FastPositionUpdateDto position;
+				dto.dto.convert(position);
+				callsign = position.callsign;
+				aircraft[callsign].Position = quantizePosition(position);
+			}
+			else if (dto.type == dto::FAST_POSITION_DELTA)
+			{
+				FastPositionDeltaDto delta;
+				dto.dto.convert(delta);
+				auto it = aircraft.find(delta.callsign);
+				if (it == aircraft.end() || delta.delta.size() != QUANTIZED_POSITION_FIELDS)
+					continue;
+				callsign = delta.callsign;
+				for (size_t i = 0; i < QUANTIZED_POSITION_FIELDS; i++)
+				{
+					it->second.Position[i] += delta.delta[i];
+				}
+			}
+			else if (dto.type == dto::DELETE_AIRCRAFT)
+			{
+				DeleteAircraftDto del;
+				dto.dto.convert(del);
+				aircraft.erase(del.callsign);
+				continue;
+			}
+			else if (dto.type == dto::DELETE_ALL_AIRCRAFT)
+			{
+				aircraft.clear();
+				continue;
+			}
+			else
+			{
+				continue;
+			}
+
+			Aircraft& a = aircraft[callsign];
+			FastPositionUpdateDto position;
+			dequantizePosition(a.Position, position);
+
+			// what RecordTerrainElevationHistory does with each position update
+			const int64_t now = message.Offset / 1000; // [ms]
+			const double terrain = TerrainElevation(position.latitude, position.longitude);
+			a.Ring.Trim(static_cast<double>(now - trimLead));
+			a.List.Trim(static_cast<double>(now - trimLead));
+			stats.Updates++;
+
+			bool ringUsable = false, listUsable = false;
+			if (position.altitudeTrue - terrain <= MAX_USABLE_ALTITUDE_AGL)
+			{
+				TerrainElevationData data{};
+				data.Timestamp = now;
+				data.Location.Latitude = position.latitude;
+				data.Location.Longitude = position.longitude;
+				data.LocalValue = terrain;
+				a.Ring.Record(data);
+				a.List.Record(data);
+				ringUsable = a.Ring.IsUsable();
+				listUsable = a.List.IsUsable();
+				stats.Recorded++;
+			}
+
+			const auto& ring = a.Ring.Samples();
+			const auto& list = a.List.Samples();
+			bool same = ringUsable == listUsable && ring.Size() == list.size();
+			size_t i = 0;
+			for (auto it = list.begin(); same && it != list.end(); ++it, ++i)
+			{
+				same = SameSample(ring[i], *it);
+			}
+			if (!same)
+			{
+				if (stats.Mismatches++ < 10)
+				{
+					fprintf(stderr, "%s at %lld ms: ring %zu samples usable %d, list %zu samples usable %d\n", callsign.c_str(),
+						static_cast<long long>(now), ring.Size(), ringUsable, list.size(), listUsable);
+				}
+			}
+
+			stats.MaxSamples = std::max(stats.MaxSamples, list.size());
+			if (listUsable)
+			{
+				stats.Usable++;
+			}
+			else if (list.size() >= 2 && list.back().Timestamp - list.front().Timestamp >= TERRAIN_ELEVATION_DATA_USABLE_AGE)
+			{
+				stats.Steep++;
+			}
+		}
+		return stats;
+	}
+
+	bool Check(const std::string& name, const std::vector<RecordedMessage>& messages)
+	{
+		bool ok = true;
+		for (double trimLead : { 0.0, 500.0 })
+		{
+			const Stats stats = Replay(messages, trimLead);
+			printf("%s trim_lead_ms=%.0f updates=%zu recorded=%zu usable=%zu steep=%zu max_samples=%zu mismatches=%zu\n",
+				name.c_str(), trimLead, stats.Updates, stats.Recorded, stats.Usable, stats.Steep, stats.MaxSamples, stats.Mismatches);
+			ok = ok && stats.Mismatches == 0 && stats.Recorded > 0;
+		}
+		return ok;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bool ok = true;
+
+	if (argc > 1)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			std::vector<RecordedMessage> messages;
+			if (!ReadIpcRecording(argv[i], messages))
+			{
+				fprintf(stderr, "can't read %s\n", argv[i]);
+				return 1;
+			}
+			ok = Check(argv[i], messages) && ok;
+		}
+		return ok ? 0 : 1;
+	}
+
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "xpilot_terrain_history_test.bin";
+	for (double rate : { 5.0, 25.0 })
+	{
+		SyntheticTrafficOptions options;
+		options.Aircraft = 120;
+		options.Duration = 60.0;
+		options.ArrivalWindow = 10.0;
+		options.PositionRate = rate;
+		options.OnGroundShare = 0.6;
+
+		// through the recording format, as the plugin writes it
+		std::vector<RecordedMessage> messages;
+		if (!WriteIpcRecording(path.string(), SynthesizeTraffic(options)) || !ReadIpcRecording(path.string(), messages))
+		{
+			fprintf(stderr, "can't write %s\n", path.string().c_str());
+			return 1;
+		}
+		ok = Check("synthetic_" + std::to_string(static_cast<int>(rate)) + "hz", messages) && ok;
+	}
+	std::filesystem::remove(path);
+	return ok ? 0 : 1;
+}
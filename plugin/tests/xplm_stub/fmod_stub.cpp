@@ -0,0 +1,57 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+// FMOD stand-in: creating the sound system fails, so XPMP2 runs with aircraft sounds disabled
+
+#include "fmod.h"
+
+FMOD_RESULT F_API FMOD_System_Create(FMOD_SYSTEM** system, unsigned int) { *system = nullptr; return FMOD_ERR_OUTPUT_INIT; }
+FMOD_RESULT F_API FMOD_System_Release(FMOD_SYSTEM*) { return FMOD_OK; }
+FMOD_RESULT F_API FMOD_System_Init(FMOD_SYSTEM*, int, FMOD_INITFLAGS, void*) { return FMOD_ERR_OUTPUT_INIT; }
+FMOD_RESULT F_API FMOD_System_Update(FMOD_SYSTEM*) { return FMOD_ERR_UNSUPPORTED; }
+FMOD_RESULT F_API FMOD_System_GetVersion(FMOD_SYSTEM*, unsigned int* version) { *version = FMOD_VERSION; return FMOD_OK; }
+FMOD_RESULT F_API FMOD_System_GetNumDrivers(FMOD_SYSTEM*, int* numdrivers) { *numdrivers = 0; return FMOD_OK; }
+FMOD_RESULT F_API FMOD_System_GetDriver(FMOD_SYSTEM*, int* driver) { *driver = -1; return FMOD_ERR_UNSUPPORTED; }
+FMOD_RESULT F_API FMOD_System_SetDriver(FMOD_SYSTEM*, int) { return FMOD_ERR_UNSUPPORTED; }
+FMOD_RESULT F_API FMOD_System_GetDriverInfo(FMOD_SYSTEM*, int, char*, int, FMOD_GUID*, int*, FMOD_SPEAKERMODE*, int*) { return FMOD_ERR_UNSUPPORTED; }
+FMOD_RESULT F_API FMOD_System_SetAdvancedSettings(FMOD_SYSTEM*, FMOD_ADVANCEDSETTINGS*) { return FMOD_ERR_UNSUPPORTED; }
+FMOD_RESULT F_API FMOD_System_GetMasterChannelGroup(FMOD_SYSTEM*, FMOD_CHANNELGROUP**) { return FMOD_ERR_UNSUPPORTED; }
+FMOD_RESULT F_API FMOD_System_Set3DListenerAttributes(FMOD_SYSTEM*, int, const FMOD_VECTOR*, const FMOD_VECTOR*, const FMOD_VECTOR*, const FMOD_VECTOR*) { return FMOD_ERR_UNSUPPORTED; }
+FMOD_RESULT F_API FMOD_System_CreateSound(FMOD_SYSTEM*, const char*, FMOD_MODE, FMOD_CREATESOUNDEXINFO*, FMOD_SOUND**) { return FMOD_ERR_UNSUPPORTED; }
+FMOD_RESULT F_API FMOD_System_PlaySound(FMOD_SYSTEM*, FMOD_SOUND*, FMOD_CHANNELGROUP*, FMOD_BOOL, FMOD_CHANNEL**) { return FMOD_ERR_UNSUPPORTED; }
+FMOD_RESULT F_API FMOD_Debug_Initialize(FMOD_DEBUG_FLAGS, FMOD_DEBUG_MODE, FMOD_DEBUG_CALLBACK, const char*) { return FMOD_OK; }
+
+FMOD_RESULT F_API FMOD_Sound_GetOpenState(FMOD_SOUND*, FMOD_OPENSTATE*, unsigned int*, FMOD_BOOL*, FMOD_BOOL*) { return FMOD_ERR_UNSUPPORTED; }
+FMOD_RESULT F_API FMOD_Sound_Release(FMOD_SOUND*) { return FMOD_OK; }
+
+FMOD_RESULT F_API FMOD_ChannelGroup_SetMute(FMOD_CHANNELGROUP*, FMOD_BOOL) { return FMOD_ERR_UNSUPPORTED; }
+FMOD_RESULT F_API FMOD_ChannelGroup_SetVolume(FMOD_CHANNELGROUP*, float) { return FMOD_ERR_UNSUPPORTED; }
+
+FMOD_RESULT F_API FMOD_Channel_GetUserData(FMOD_CHANNEL*, void** userdata) { *userdata = nullptr; return FMOD_ERR_UNSUPPORTED; }
+FMOD_RESULT F_API FMOD_Channel_SetUserData(FMOD_CHANNEL*, void*) { return FMOD_ERR_UNSUPPORTED; }
+FMOD_RESULT F_API FMOD_Channel_IsPlaying(FMOD_CHANNEL*, FMOD_BOOL* isplaying) { *isplaying = 0; return FMOD_ERR_UNSUPPORTED; }
+FMOD_RESULT F_API FMOD_Channel_Set3DAttributes(FMOD_CHANNEL*, const FMOD_VECTOR*, const FMOD_VECTOR*) { return FMOD_ERR_UNSUPPORTED; }
+FMOD_RESULT F_API FMOD_Channel_Set3DConeOrientation(FMOD_CHANNEL*, FMOD_VECTOR*) { return FMOD_ERR_UNSUPPORTED; }
+FMOD_RESULT F_API FMOD_Channel_Set3DConeSettings(FMOD_CHANNEL*, float, float, float) { return FMOD_ERR_UNSUPPORTED; }
+FMOD_RESULT F_API FMOD_Channel_Set3DMinMaxDistance(FMOD_CHANNEL*, float, float) { return FMOD_ERR_UNSUPPORTED; }
+FMOD_RESULT F_API FMOD_Channel_SetCallback(FMOD_CHANNEL*, FMOD_CHANNELCONTROL_CALLBACK) { return FMOD_ERR_UNSUPPORTED; }
+FMOD_RESULT F_API FMOD_Channel_SetLowPassGain(FMOD_CHANNEL*, float) { return FMOD_ERR_UNSUPPORTED; }
+FMOD_RESULT F_API FMOD_Channel_SetMute(FMOD_CHANNEL*, FMOD_BOOL) { return FMOD_ERR_UNSUPPORTED; }
+FMOD_RESULT F_API FMOD_Channel_SetPaused(FMOD_CHANNEL*, FMOD_BOOL) { return FMOD_ERR_UNSUPPORTED; }
+FMOD_RESULT F_API FMOD_Channel_SetVolume(FMOD_CHANNEL*, float) { return FMOD_ERR_UNSUPPORTED; }
+FMOD_RESULT F_API FMOD_Channel_Stop(FMOD_CHANNEL*) { return FMOD_ERR_UNSUPPORTED; }
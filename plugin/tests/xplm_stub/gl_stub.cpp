@@ -0,0 +1,52 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+// OpenGL stand-in: there is no context in a headless run, and nothing draws anyway
+
+#include <GL/gl.h>
+
+extern "C"
+{
+	void glBegin(GLenum) {}
+	void glEnd(void) {}
+	void glColor3f(GLfloat, GLfloat, GLfloat) {}
+	void glVertex2f(GLfloat, GLfloat) {}
+	void glLineWidth(GLfloat) {}
+	void glEnable(GLenum) {}
+	void glDisable(GLenum) {}
+	void glEnableClientState(GLenum) {}
+	void glDisableClientState(GLenum) {}
+	void glColorPointer(GLint, GLenum, GLsizei, const GLvoid*) {}
+	void glVertexPointer(GLint, GLenum, GLsizei, const GLvoid*) {}
+	void glTexCoordPointer(GLint, GLenum, GLsizei, const GLvoid*) {}
+	void glDrawElements(GLenum, GLsizei, GLenum, const GLvoid*) {}
+	void glMatrixMode(GLenum) {}
+	void glPushMatrix(void) {}
+	void glPopMatrix(void) {}
+	void glPushAttrib(GLbitfield) {}
+	void glPopAttrib(void) {}
+	void glPushClientAttrib(GLbitfield) {}
+	void glPopClientAttrib(void) {}
+	void glScalef(GLfloat, GLfloat, GLfloat) {}
+	void glTranslatef(GLfloat, GLfloat, GLfloat) {}
+	void glScissor(GLint, GLint, GLsizei, GLsizei) {}
+	void glPixelStorei(GLenum, GLint) {}
+	void glTexParameteri(GLenum, GLenum, GLint) {}
+	void glTexImage2D(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const GLvoid*) {}
+	void glDeleteTextures(GLsizei, const GLuint*) {}
+}
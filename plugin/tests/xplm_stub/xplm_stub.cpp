@@ -0,0 +1,1205 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "xplm_stub.h"
+
+#include "XPLMCamera.h"
+#include "XPLMDataAccess.h"
+#include "XPLMDisplay.h"
+#include "XPLMGraphics.h"
+#include "XPLMInstance.h"
+#include "XPLMMap.h"
+#include "XPLMMenus.h"
+#include "XPLMPlanes.h"
+#include "XPLMPlugin.h"
+#include "XPLMProcessing.h"
+#include "XPLMScenery.h"
+#include "XPLMUtilities.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace xplm_stub
+{
+	constexpr double METERS_PER_DEGREE = 111319.5;
+	constexpr int SCREEN_WIDTH = 1920;
+	constexpr int SCREEN_HEIGHT = 1080;
+	constexpr int MULTIPLAYER_PLANES = 19;
+
+	struct DataRef
+	{
+		std::string Name;
+		XPLMDataTypeID Types = 0;
+		bool Writable = true;
+		bool Owned = false; // registered through XPLMRegisterDataAccessor, else a plain simulator value
+
+		XPLMGetDatai_f ReadInt = nullptr;
+		XPLMSetDatai_f WriteInt = nullptr;
+		XPLMGetDataf_f ReadFloat = nullptr;
+		XPLMSetDataf_f WriteFloat = nullptr;
+		XPLMGetDatad_f ReadDouble = nullptr;
+		XPLMSetDatad_f WriteDouble = nullptr;
+		XPLMGetDatavi_f ReadIntArray = nullptr;
+		XPLMSetDatavi_f WriteIntArray = nullptr;
+		XPLMGetDatavf_f ReadFloatArray = nullptr;
+		XPLMSetDatavf_f WriteFloatArray = nullptr;
+		XPLMGetDatab_f ReadData = nullptr;
+		XPLMSetDatab_f WriteData = nullptr;
+		void* ReadRefcon = nullptr;
+		void* WriteRefcon = nullptr;
+
+		double Value = 0.0;
+		std::vector<int> Ints;
+		std::vector<float> Floats;
+		std::vector<char> Bytes;
+	};
+
+	struct FlightLoop
+	{
+		XPLMFlightLoop_f Callback = nullptr;
+		void* Refcon = nullptr;
+		bool Legacy = false; // XPLMRegisterFlightLoopCallback rather than XPLMCreateFlightLoop
+		bool Destroyed = false;
+		bool Scheduled = false;
+		double DueTime = 0.0;
+		uint64_t DueFrame = 0;
+		double LastCall = 0.0;
+	};
+
+	struct Window
+	{
+		int Left = 0, Top = 0, Right = 0, Bottom = 0;
+		int Visible = 0;
+	};
+
+	struct Command
+	{
+		std::string Name;
+	};
+
+	struct PendingObject
+	{
+		std::string Path;
+		XPLMObjectLoaded_f Callback;
+		void* Refcon;
+	};
+
+	/// All of the stub's state; constructed on first use because the plugin already calls in during static initialization
+	struct Sim
+	{
+		std::recursive_mutex Mutex;
+		std::thread::id MainThread;
+		std::atomic<uint64_t> ForeignThreadCalls{ 0 };
+
+		std::string PluginPath = "/tmp/xpilot/lin_x64/xPilot.xpl";
+		std::string SystemPath = "/tmp/xpilot/";
+		double ReferenceLatitude = 0.0;
+		double ReferenceLongitude = 0.0;
+		double TerrainElevation = 0.0;
+
+		double SimTime = 0.0;
+		uint64_t Frame = 0;
+		std::atomic<uint64_t> Probes{ 0 };
+		int LiveInstances = 0;
+		int NextTexture = 1;
+
+		std::deque<DataRef> DataRefs; // a deque keeps the handles we gave out stable
+		std::map<std::string, DataRef*> DataRefsByName;
+		std::vector<std::unique_ptr<FlightLoop>> FlightLoops;
+		std::deque<Window> Windows;
+		std::deque<Command> Commands;
+		std::map<std::string, Command*> CommandsByName;
+		std::vector<PendingObject> PendingObjects;
+		std::map<std::string, int> Features;
+		int NextMenuItem = 0;
+		char MenuHandles[64] = {};
+		int NextMenu = 0;
+
+		DataRef* Find(const std::string& name)
+		{
+			auto it = DataRefsByName.find(name);
+			return it != DataRefsByName.end() ? it->second : nullptr;
+		}
+
+		DataRef* FindOrCreate(const std::string& name)
+		{
+			if (DataRef* ref = Find(name))
+				return ref;
+			DataRef& ref = DataRefs.emplace_back();
+			ref.Name = name;
+			ref.Types = xplmType_Int | xplmType_Float | xplmType_Double | xplmType_IntArray | xplmType_FloatArray | xplmType_Data;
+			DataRefsByName[name] = &ref;
+			return &ref;
+		}
+
+		void SetValue(const std::string& name, double value)
+		{
+			FindOrCreate(name)->Value = value;
+		}
+
+		Sim()
+		{
+			SetValue("sim/graphics/view/visibility_effective_m", 50000.0);
+			SetValue("sim/weather/visibility_effective_m", 50000.0);
+			SetValue("sim/graphics/view/window_width", SCREEN_WIDTH);
+			SetValue("sim/graphics/view/window_height", SCREEN_HEIGHT);
+			SetValue("sim/graphics/view/field_of_view_deg", 60.0);
+			SetValue("sim/graphics/view/using_modern_driver", 1.0);
+			SetValue("sim/operation/misc/frame_rate_period", 1.0 / 60.0);
+			SetValue("sim/time/framerate_period", 1.0 / 60.0);
+		}
+	};
+
+	static Sim& GetSim()
+	{
+		static Sim sim;
+		return sim;
+	}
+
+	/// Locks the stub and counts calls from threads other than the simulator's
+	static std::unique_lock<std::recursive_mutex> Enter()
+	{
+		Sim& sim = GetSim();
+		if (sim.MainThread != std::thread::id() && std::this_thread::get_id() != sim.MainThread)
+		{
+			sim.ForeignThreadCalls++;
+		}
+		return std::unique_lock<std::recursive_mutex>(sim.Mutex);
+	}
+
+	/// Any of X-Plane's own datarefs exists, with the 19 multiplayer planes X-Plane 12 has; XPMP2 probes for those
+	static bool IsSimulatorDataRef(const std::string& name)
+	{
+		static const std::string multiplayer = "sim/multiplayer/position/plane";
+		if (name.rfind("sim/", 0) != 0)
+			return false;
+		if (name.rfind(multiplayer, 0) != 0)
+			return true;
+		return std::atoi(name.c_str() + multiplayer.size()) <= MULTIPLAYER_PLANES;
+	}
+
+	static DataRef* AsDataRef(XPLMDataRef ref)
+	{
+		return static_cast<DataRef*>(ref);
+	}
+
+	static void Schedule(FlightLoop& loop, float interval, bool relativeToNow)
+	{
+		const Sim& sim = GetSim();
+		loop.Scheduled = interval < 0.0f || interval > 0.0f;
+		if (interval < 0.0f)
+		{
+			loop.DueFrame = sim.Frame + static_cast<uint64_t>(-interval);
+			loop.DueTime = 0.0;
+		}
+		else
+		{
+			loop.DueFrame = 0;
+			loop.DueTime = (relativeToNow ? sim.SimTime : loop.LastCall) + interval;
+		}
+	}
+
+	void SetPluginPath(const std::string& path)
+	{
+		auto lock = Enter();
+		GetSim().PluginPath = path;
+	}
+
+	void SetSystemPath(const std::string& path)
+	{
+		auto lock = Enter();
+		GetSim().SystemPath = path;
+	}
+
+	void SetReferencePoint(double latitude, double longitude)
+	{
+		auto lock = Enter();
+		Sim& sim = GetSim();
+		sim.ReferenceLatitude = latitude;
+		sim.ReferenceLongitude = longitude;
+		sim.SetValue("sim/flightmodel/position/lat_ref", latitude);
+		sim.SetValue("sim/flightmodel/position/lon_ref", longitude);
+	}
+
+	void SetTerrainElevation(double meters)
+	{
+		auto lock = Enter();
+		GetSim().TerrainElevation = meters;
+	}
+
+	void RunFrame(float elapsed)
+	{
+		Sim& sim = GetSim();
+		std::vector<PendingObject> objects;
+		std::vector<FlightLoop*> due;
+		{
+			auto lock = Enter();
+			if (sim.MainThread == std::thread::id())
+			{
+				sim.MainThread = std::this_thread::get_id();
+			}
+
+			sim.Frame++;
+			sim.SimTime += elapsed;
+			sim.SetValue("sim/time/total_running_time_sec", sim.SimTime);
+			sim.SetValue("sim/time/total_flight_time_sec", sim.SimTime);
+			sim.SetValue("sim/network/misc/network_time_sec", sim.SimTime);
+			sim.SetValue("sim/operation/misc/frame_rate_period", elapsed);
+			sim.SetValue("sim/time/framerate_period", elapsed);
+
+			objects.swap(sim.PendingObjects);
+
+			// flight loops registered from within a callback run from the next frame on
+			for (auto& loop : sim.FlightLoops)
+			{
+				if (loop->Destroyed || !loop->Scheduled)
+					continue;
+				if (loop->DueFrame > 0 ? sim.Frame >= loop->DueFrame : sim.SimTime >= loop->DueTime)
+				{
+					due.push_back(loop.get());
+				}
+			}
+		}
+
+		for (const PendingObject& object : objects)
+		{
+			object.Callback(reinterpret_cast<XPLMObjectRef>(new int(0)), object.Refcon);
+		}
+
+		for (FlightLoop* loop : due)
+		{
+			float sinceLastCall;
+			{
+				auto lock = Enter();
+				if (loop->Destroyed)
+					continue;
+				sinceLastCall = static_cast<float>(sim.SimTime - loop->LastCall);
+				loop->LastCall = sim.SimTime;
+			}
+
+			const float next = loop->Callback(sinceLastCall, elapsed, static_cast<int>(sim.Frame), loop->Refcon);
+
+			auto lock = Enter();
+			if (!loop->Destroyed)
+			{
+				Schedule(*loop, next, true);
+			}
+		}
+
+		auto lock = Enter();
+		sim.FlightLoops.erase(std::remove_if(sim.FlightLoops.begin(), sim.FlightLoops.end(),
+			[](const std::unique_ptr<FlightLoop>& loop) { return loop->Destroyed; }), sim.FlightLoops.end());
+	}
+
+	double GetSimTime()
+	{
+		auto lock = Enter();
+		return GetSim().SimTime;
+	}
+
+	uint64_t GetFrameCount()
+	{
+		auto lock = Enter();
+		return GetSim().Frame;
+	}
+
+	uint64_t GetForeignThreadCalls()
+	{
+		return GetSim().ForeignThreadCalls;
+	}
+
+	uint64_t GetProbeCount()
+	{
+		return GetSim().Probes;
+	}
+
+	int GetLiveInstances()
+	{
+		auto lock = Enter();
+		return GetSim().LiveInstances;
+	}
+}
+
+using namespace xplm_stub;
+
+/* Data access */
+
+XPLMDataRef XPLMFindDataRef(const char* inDataRefName)
+{
+	auto lock = Enter();
+	Sim& sim = GetSim();
+	if (DataRef* ref = sim.Find(inDataRefName))
+		return ref;
+	if (!IsSimulatorDataRef(inDataRefName))
+		return nullptr;
+	return sim.FindOrCreate(inDataRefName);
+}
+
+int XPLMCanWriteDataRef(XPLMDataRef inDataRef)
+{
+	auto lock = Enter();
+	return inDataRef && AsDataRef(inDataRef)->Writable;
+}
+
+XPLMDataTypeID XPLMGetDataRefTypes(XPLMDataRef inDataRef)
+{
+	auto lock = Enter();
+	return inDataRef ? AsDataRef(inDataRef)->Types : xplmType_Unknown;
+}
+
+XPLMDataRef XPLMRegisterDataAccessor(const char* inDataName, XPLMDataTypeID inDataType, int inIsWritable,
+	XPLMGetDatai_f inReadInt, XPLMSetDatai_f inWriteInt, XPLMGetDataf_f inReadFloat, XPLMSetDataf_f inWriteFloat,
+	XPLMGetDatad_f inReadDouble, XPLMSetDatad_f inWriteDouble, XPLMGetDatavi_f inReadIntArray, XPLMSetDatavi_f inWriteIntArray,
+	XPLMGetDatavf_f inReadFloatArray, XPLMSetDatavf_f inWriteFloatArray, XPLMGetDatab_f inReadData, XPLMSetDatab_f inWriteData,
+	void* inReadRefcon, void* inWriteRefcon)
+{
+	auto lock = Enter();
+	DataRef* ref = GetSim().FindOrCreate(inDataName);
+	ref->Types = inDataType;
+	ref->Writable = inIsWritable != 0;
+	ref->Owned = true;
+	ref->ReadInt = inReadInt;
+	ref->WriteInt = inWriteInt;
+	ref->ReadFloat = inReadFloat;
+	ref->WriteFloat = inWriteFloat;
+	ref->ReadDouble = inReadDouble;
+	ref->WriteDouble = inWriteDouble;
+	ref->ReadIntArray = inReadIntArray;
+	ref->WriteIntArray = inWriteIntArray;
+	ref->ReadFloatArray = inReadFloatArray;
+	ref->WriteFloatArray = inWriteFloatArray;
+	ref->ReadData = inReadData;
+	ref->WriteData = inWriteData;
+	ref->ReadRefcon = inReadRefcon;
+	ref->WriteRefcon = inWriteRefcon;
+	return ref;
+}
+
+void XPLMUnregisterDataAccessor(XPLMDataRef inDataRef)
+{
+	auto lock = Enter();
+	if (!inDataRef)
+		return;
+
+	// handles stay valid, like X-Plane's, but read as zero from now on
+	DataRef* ref = AsDataRef(inDataRef);
+	const std::string name = ref->Name;
+	*ref = DataRef{};
+	ref->Name = name;
+}
+
+int XPLMShareData(const char* inDataName, XPLMDataTypeID, XPLMDataChanged_f, void*)
+{
+	auto lock = Enter();
+	GetSim().FindOrCreate(inDataName);
+	return 1;
+}
+
+int XPLMUnshareData(const char*, XPLMDataTypeID, XPLMDataChanged_f, void*)
+{
+	auto lock = Enter();
+	return 1;
+}
+
+int XPLMGetDatai(XPLMDataRef inDataRef)
+{
+	auto lock = Enter();
+	DataRef* ref = AsDataRef(inDataRef);
+	if (!ref)
+		return 0;
+	if (ref->Owned)
+		return ref->ReadInt ? ref->ReadInt(ref->ReadRefcon) : 0;
+	return static_cast<int>(ref->Value);
+}
+
+void XPLMSetDatai(XPLMDataRef inDataRef, int inValue)
+{
+	auto lock = Enter();
+	DataRef* ref = AsDataRef(inDataRef);
+	if (!ref)
+		return;
+	if (ref->Owned)
+	{
+		if (ref->WriteInt)
+			ref->WriteInt(ref->WriteRefcon, inValue);
+		return;
+	}
+	ref->Value = inValue;
+}
+
+float XPLMGetDataf(XPLMDataRef inDataRef)
+{
+	auto lock = Enter();
+	DataRef* ref = AsDataRef(inDataRef);
+	if (!ref)
+		return 0.0f;
+	if (ref->Owned)
+		return ref->ReadFloat ? ref->ReadFloat(ref->ReadRefcon) : 0.0f;
+	return static_cast<float>(ref->Value);
+}
+
+void XPLMSetDataf(XPLMDataRef inDataRef, float inValue)
+{
+	auto lock = Enter();
+	DataRef* ref = AsDataRef(inDataRef);
+	if (!ref)
+		return;
+	if (ref->Owned)
+	{
+		if (ref->WriteFloat)
+			ref->WriteFloat(ref->WriteRefcon, inValue);
+		return;
+	}
+	ref->Value = inValue;
+}
+
+double XPLMGetDatad(XPLMDataRef inDataRef)
+{
+	auto lock = Enter();
+	DataRef* ref = AsDataRef(inDataRef);
+	if (!ref)
+		return 0.0;
+	if (ref->Owned)
+		return ref->ReadDouble ? ref->ReadDouble(ref->ReadRefcon) : 0.0;
+	return ref->Value;
+}
+
+void XPLMSetDatad(XPLMDataRef inDataRef, double inValue)
+{
+	auto lock = Enter();
+	DataRef* ref = AsDataRef(inDataRef);
+	if (!ref)
+		return;
+	if (ref->Owned)
+	{
+		if (ref->WriteDouble)
+			ref->WriteDouble(ref->WriteRefcon, inValue);
+		return;
+	}
+	ref->Value = inValue;
+}
+
+template<typename T>
+static int ReadArray(const std::vector<T>& values, T* out, int offset, int max)
+{
+	const int size = static_cast<int>(values.size());
+	if (!out)
+		return size;
+	const int count = std::clamp(std::min(max, size - offset), 0, size);
+	std::copy_n(values.begin() + std::min(offset, size), count, out);
+	return count;
+}
+
+template<typename T>
+static void WriteArray(std::vector<T>& values, const T* in, int offset, int count)
+{
+	if (!in || offset < 0 || count <= 0)
+		return;
+	if (values.size() < static_cast<size_t>(offset + count))
+	{
+		values.resize(offset + count);
+	}
+	std::copy_n(in, count, values.begin() + offset);
+}
+
+int XPLMGetDatavi(XPLMDataRef inDataRef, int* outValues, int inOffset, int inMax)
+{
+	auto lock = Enter();
+	DataRef* ref = AsDataRef(inDataRef);
+	if (!ref)
+		return 0;
+	if (ref->Owned)
+		return ref->ReadIntArray ? ref->ReadIntArray(ref->ReadRefcon, outValues, inOffset, inMax) : 0;
+	return ReadArray(ref->Ints, outValues, inOffset, inMax);
+}
+
+void XPLMSetDatavi(XPLMDataRef inDataRef, int* inValues, int inoffset, int inCount)
+{
+	auto lock = Enter();
+	DataRef* ref = AsDataRef(inDataRef);
+	if (!ref)
+		return;
+	if (ref->Owned)
+	{
+		if (ref->WriteIntArray)
+			ref->WriteIntArray(ref->WriteRefcon, inValues, inoffset, inCount);
+		return;
+	}
+	WriteArray(ref->Ints, inValues, inoffset, inCount);
+}
+
+int XPLMGetDatavf(XPLMDataRef inDataRef, float* outValues, int inOffset, int inMax)
+{
+	auto lock = Enter();
+	DataRef* ref = AsDataRef(inDataRef);
+	if (!ref)
+		return 0;
+	if (ref->Owned)
+		return ref->ReadFloatArray ? ref->ReadFloatArray(ref->ReadRefcon, outValues, inOffset, inMax) : 0;
+	return ReadArray(ref->Floats, outValues, inOffset, inMax);
+}
+
+void XPLMSetDatavf(XPLMDataRef inDataRef, float* inValues, int inoffset, int inCount)
+{
+	auto lock = Enter();
+	DataRef* ref = AsDataRef(inDataRef);
+	if (!ref)
+		return;
+	if (ref->Owned)
+	{
+		if (ref->WriteFloatArray)
+			ref->WriteFloatArray(ref->WriteRefcon, inValues, inoffset, inCount);
+		return;
+	}
+	WriteArray(ref->Floats, inValues, inoffset, inCount);
+}
+
+int XPLMGetDatab(XPLMDataRef inDataRef, void* outValue, int inOffset, int inMaxBytes)
+{
+	auto lock = Enter();
+	DataRef* ref = AsDataRef(inDataRef);
+	if (!ref)
+		return 0;
+	if (ref->Owned)
+		return ref->ReadData ? ref->ReadData(ref->ReadRefcon, outValue, inOffset, inMaxBytes) : 0;
+	return ReadArray(ref->Bytes, static_cast<char*>(outValue), inOffset, inMaxBytes);
+}
+
+void XPLMSetDatab(XPLMDataRef inDataRef, void* inValue, int inOffset, int inLength)
+{
+	auto lock = Enter();
+	DataRef* ref = AsDataRef(inDataRef);
+	if (!ref)
+		return;
+	if (ref->Owned)
+	{
+		if (ref->WriteData)
+			ref->WriteData(ref->WriteRefcon, inValue, inOffset, inLength);
+		return;
+	}
+	WriteArray(ref->Bytes, static_cast<const char*>(inValue), inOffset, inLength);
+}
+
+/* Processing */
+
+void XPLMRegisterFlightLoopCallback(XPLMFlightLoop_f inFlightLoop, float inInterval, void* inRefcon)
+{
+	auto lock = Enter();
+	Sim& sim = GetSim();
+	auto loop = std::make_unique<FlightLoop>();
+	loop->Callback = inFlightLoop;
+	loop->Refcon = inRefcon;
+	loop->Legacy = true;
+	loop->LastCall = sim.SimTime;
+	Schedule(*loop, inInterval, true);
+	sim.FlightLoops.push_back(std::move(loop));
+}
+
+void XPLMUnregisterFlightLoopCallback(XPLMFlightLoop_f inFlightLoop, void* inRefcon)
+{
+	auto lock = Enter();
+	FlightLoop* match = nullptr;
+	for (auto& loop : GetSim().FlightLoops)
+	{
+		if (!loop->Legacy || loop->Destroyed || loop->Callback != inFlightLoop)
+			continue;
+		// prefer the registration with this refcon; some callers unregister with a null one
+		if (!match || loop->Refcon == inRefcon)
+		{
+			match = loop.get();
+		}
+	}
+	if (match)
+	{
+		match->Destroyed = true;
+	}
+}
+
+XPLMFlightLoopID XPLMCreateFlightLoop(XPLMCreateFlightLoop_t* inParams)
+{
+	auto lock = Enter();
+	Sim& sim = GetSim();
+	auto loop = std::make_unique<FlightLoop>();
+	loop->Callback = inParams->callbackFunc;
+	loop->Refcon = inParams->refcon;
+	loop->LastCall = sim.SimTime;
+	FlightLoop* id = loop.get();
+	sim.FlightLoops.push_back(std::move(loop));
+	return id;
+}
+
+void XPLMDestroyFlightLoop(XPLMFlightLoopID inFlightLoopID)
+{
+	auto lock = Enter();
+	static_cast<FlightLoop*>(inFlightLoopID)->Destroyed = true;
+}
+
+void XPLMScheduleFlightLoop(XPLMFlightLoopID inFlightLoopID, float inInterval, int inRelativeToNow)
+{
+	auto lock = Enter();
+	Schedule(*static_cast<FlightLoop*>(inFlightLoopID), inInterval, inRelativeToNow != 0);
+}
+
+int XPLMGetCycleNumber(void)
+{
+	auto lock = Enter();
+	return static_cast<int>(GetSim().Frame);
+}
+
+/* Scenery and instances */
+
+XPLMProbeRef XPLMCreateProbe(XPLMProbeType)
+{
+	auto lock = Enter();
+	return reinterpret_cast<XPLMProbeRef>(new int(0));
+}
+
+void XPLMDestroyProbe(XPLMProbeRef inProbe)
+{
+	auto lock = Enter();
+	delete reinterpret_cast<int*>(inProbe);
+}
+
+XPLMProbeResult XPLMProbeTerrainXYZ(XPLMProbeRef, float inX, float, float inZ, XPLMProbeInfo_t* outInfo)
+{
+	auto lock = Enter();
+	Sim& sim = GetSim();
+	sim.Probes++;
+	outInfo->locationX = inX;
+	outInfo->locationY = static_cast<float>(sim.TerrainElevation);
+	outInfo->locationZ = inZ;
+	outInfo->normalX = 0.0f;
+	outInfo->normalY = 1.0f;
+	outInfo->normalZ = 0.0f;
+	outInfo->velocityX = outInfo->velocityY = outInfo->velocityZ = 0.0f;
+	outInfo->is_wet = 0;
+	return xplm_ProbeHitTerrain;
+}
+
+void XPLMWorldToLocal(double inLatitude, double inLongitude, double inAltitude, double* outX, double* outY, double* outZ)
+{
+	auto lock = Enter();
+	const Sim& sim = GetSim();
+	*outX = (inLongitude - sim.ReferenceLongitude) * METERS_PER_DEGREE * std::cos(inLatitude * M_PI / 180.0);
+	*outY = inAltitude;
+	*outZ = -(inLatitude - sim.ReferenceLatitude) * METERS_PER_DEGREE;
+}
+
+void XPLMLocalToWorld(double inX, double inY, double inZ, double* outLatitude, double* outLongitude, double* outAltitude)
+{
+	auto lock = Enter();
+	const Sim& sim = GetSim();
+	*outLatitude = sim.ReferenceLatitude - inZ / METERS_PER_DEGREE;
+	*outLongitude = sim.ReferenceLongitude + inX / (METERS_PER_DEGREE * std::cos(*outLatitude * M_PI / 180.0));
+	*outAltitude = inY;
+}
+
+XPLMObjectRef XPLMLoadObject(const char*)
+{
+	auto lock = Enter();
+	return reinterpret_cast<XPLMObjectRef>(new int(0));
+}
+
+void XPLMLoadObjectAsync(const char* inPath, XPLMObjectLoaded_f inCallback, void* inRefcon)
+{
+	auto lock = Enter();
+	GetSim().PendingObjects.push_back({ inPath, inCallback, inRefcon });
+}
+
+void XPLMUnloadObject(XPLMObjectRef inObject)
+{
+	auto lock = Enter();
+	delete reinterpret_cast<int*>(inObject);
+}
+
+XPLMInstanceRef XPLMCreateInstance(XPLMObjectRef, const char**)
+{
+	auto lock = Enter();
+	GetSim().LiveInstances++;
+	return reinterpret_cast<XPLMInstanceRef>(new int(0));
+}
+
+void XPLMDestroyInstance(XPLMInstanceRef instance)
+{
+	auto lock = Enter();
+	GetSim().LiveInstances--;
+	delete reinterpret_cast<int*>(instance);
+}
+
+void XPLMInstanceSetPosition(XPLMInstanceRef, const XPLMDrawInfo_t*, const float*)
+{
+	auto lock = Enter();
+}
+
+/* Planes */
+
+int XPLMAcquirePlanes(char**, XPLMPlanesAvailable_f, void*)
+{
+	auto lock = Enter();
+	return 1;
+}
+
+void XPLMReleasePlanes(void)
+{
+	auto lock = Enter();
+}
+
+void XPLMCountAircraft(int* outTotalAircraft, int* outActiveAircraft, XPLMPluginID* outController)
+{
+	auto lock = Enter();
+	*outTotalAircraft = 1;
+	*outActiveAircraft = 1;
+	*outController = XPLM_NO_PLUGIN_ID;
+}
+
+void XPLMSetActiveAircraftCount(int)
+{
+	auto lock = Enter();
+}
+
+void XPLMDisableAIForPlane(int)
+{
+	auto lock = Enter();
+}
+
+/* Plugins and utilities */
+
+XPLMPluginID XPLMGetMyID(void)
+{
+	auto lock = Enter();
+	return 1;
+}
+
+XPLMPluginID XPLMFindPluginBySignature(const char*)
+{
+	auto lock = Enter();
+	return XPLM_NO_PLUGIN_ID;
+}
+
+void XPLMGetPluginInfo(XPLMPluginID, char* outName, char* outFilePath, char* outSignature, char* outDescription)
+{
+	auto lock = Enter();
+	if (outName)
+		strcpy(outName, "xPilot");
+	if (outFilePath)
+		strcpy(outFilePath, GetSim().PluginPath.c_str());
+	if (outSignature)
+		strcpy(outSignature, "org.vatsim.xpilot");
+	if (outDescription)
+		strcpy(outDescription, "");
+}
+
+void XPLMSendMessageToPlugin(XPLMPluginID, int, void*)
+{
+	auto lock = Enter();
+}
+
+void XPLMEnableFeature(const char* inFeature, int inEnable)
+{
+	auto lock = Enter();
+	GetSim().Features[inFeature] = inEnable;
+}
+
+int XPLMIsFeatureEnabled(const char* inFeature)
+{
+	auto lock = Enter();
+	auto& features = GetSim().Features;
+	auto it = features.find(inFeature);
+	return it != features.end() ? it->second : 0;
+}
+
+void* XPLMFindSymbol(const char*)
+{
+	auto lock = Enter();
+	return nullptr;
+}
+
+void XPLMDebugString(const char* inString)
+{
+	// the log is the one call X-Plane tolerates from any thread
+	fputs(inString, stdout);
+	fflush(stdout);
+}
+
+void XPLMGetSystemPath(char* outSystemPath)
+{
+	auto lock = Enter();
+	strcpy(outSystemPath, GetSim().SystemPath.c_str());
+}
+
+const char* XPLMGetDirectorySeparator(void)
+{
+	auto lock = Enter();
+	return "/";
+}
+
+char* XPLMExtractFileAndPath(char* inFullPath)
+{
+	auto lock = Enter();
+	char* separator = strrchr(inFullPath, '/');
+	if (!separator)
+		return inFullPath;
+	*separator = '\0';
+	return separator + 1;
+}
+
+int XPLMGetDirectoryContents(const char* inDirectoryPath, int inFirstReturn, char* outFileNames, int inFileNameBufSize,
+	char** outIndices, int inIndexCount, int* outTotalFiles, int* outReturnedFiles)
+{
+	auto lock = Enter();
+	std::vector<std::string> names;
+	std::error_code ec;
+	for (const auto& entry : std::filesystem::directory_iterator(inDirectoryPath, ec))
+	{
+		names.push_back(entry.path().filename().string());
+	}
+	std::sort(names.begin(), names.end());
+
+	if (outTotalFiles)
+		*outTotalFiles = static_cast<int>(names.size());
+
+	int returned = 0;
+	int used = 0;
+	size_t next = static_cast<size_t>(std::max(inFirstReturn, 0));
+	for (; next < names.size(); next++)
+	{
+		const int length = static_cast<int>(names[next].size()) + 1;
+		if ((outIndices && returned >= inIndexCount) || used + length > inFileNameBufSize)
+			break;
+		memcpy(outFileNames + used, names[next].c_str(), length);
+		if (outIndices)
+			outIndices[returned] = outFileNames + used;
+		used += length;
+		returned++;
+	}
+
+	if (outReturnedFiles)
+		*outReturnedFiles = returned;
+	return next >= names.size();
+}
+
+void XPLMGetVersions(int* outXPlaneVersion, int* outXPLMVersion, XPLMHostApplicationID* outHostID)
+{
+	auto lock = Enter();
+	*outXPlaneVersion = 12100;
+	*outXPLMVersion = 410;
+	*outHostID = xplm_Host_XPlane;
+}
+
+XPLMCommandRef XPLMFindCommand(const char* inName)
+{
+	auto lock = Enter();
+	Sim& sim = GetSim();
+	auto it = sim.CommandsByName.find(inName);
+	if (it != sim.CommandsByName.end())
+		return it->second;
+	return nullptr;
+}
+
+XPLMCommandRef XPLMCreateCommand(const char* inName, const char*)
+{
+	auto lock = Enter();
+	Sim& sim = GetSim();
+	if (XPLMCommandRef existing = XPLMFindCommand(inName))
+		return existing;
+	Command& command = sim.Commands.emplace_back();
+	command.Name = inName;
+	sim.CommandsByName[inName] = &command;
+	return &command;
+}
+
+void XPLMRegisterCommandHandler(XPLMCommandRef, XPLMCommandCallback_f, int, void*)
+{
+	auto lock = Enter();
+}
+
+void XPLMUnregisterCommandHandler(XPLMCommandRef, XPLMCommandCallback_f, int, void*)
+{
+	auto lock = Enter();
+}
+
+/* Menus */
+
+XPLMMenuID XPLMFindPluginsMenu(void)
+{
+	auto lock = Enter();
+	return &GetSim().MenuHandles[0];
+}
+
+XPLMMenuID XPLMCreateMenu(const char*, XPLMMenuID, int, XPLMMenuHandler_f, void*)
+{
+	auto lock = Enter();
+	Sim& sim = GetSim();
+	sim.NextMenu = std::min(sim.NextMenu + 1, static_cast<int>(sizeof(sim.MenuHandles)) - 1);
+	return &sim.MenuHandles[sim.NextMenu];
+}
+
+void XPLMDestroyMenu(XPLMMenuID)
+{
+	auto lock = Enter();
+}
+
+int XPLMAppendMenuItem(XPLMMenuID, const char*, void*, int)
+{
+	auto lock = Enter();
+	return GetSim().NextMenuItem++;
+}
+
+int XPLMAppendMenuItemWithCommand(XPLMMenuID, const char*, XPLMCommandRef)
+{
+	auto lock = Enter();
+	return GetSim().NextMenuItem++;
+}
+
+void XPLMSetMenuItemName(XPLMMenuID, int, const char*, int)
+{
+	auto lock = Enter();
+}
+
+/* Display; windows exist and remember their geometry, but nothing ever draws */
+
+XPLMWindowID XPLMCreateWindowEx(XPLMCreateWindow_t* inParams)
+{
+	auto lock = Enter();
+	Window& window = GetSim().Windows.emplace_back();
+	window.Left = inParams->left;
+	window.Top = inParams->top;
+	window.Right = inParams->right;
+	window.Bottom = inParams->bottom;
+	window.Visible = inParams->visible;
+	return &window;
+}
+
+void XPLMDestroyWindow(XPLMWindowID)
+{
+	auto lock = Enter();
+}
+
+void XPLMGetWindowGeometry(XPLMWindowID inWindowID, int* outLeft, int* outTop, int* outRight, int* outBottom)
+{
+	auto lock = Enter();
+	const Window* window = static_cast<const Window*>(inWindowID);
+	if (outLeft)
+		*outLeft = window->Left;
+	if (outTop)
+		*outTop = window->Top;
+	if (outRight)
+		*outRight = window->Right;
+	if (outBottom)
+		*outBottom = window->Bottom;
+}
+
+void XPLMGetWindowGeometryOS(XPLMWindowID inWindowID, int* outLeft, int* outTop, int* outRight, int* outBottom)
+{
+	XPLMGetWindowGeometry(inWindowID, outLeft, outTop, outRight, outBottom);
+}
+
+void XPLMGetWindowGeometryVR(XPLMWindowID inWindowID, int* outWidthBoxels, int* outHeightBoxels)
+{
+	auto lock = Enter();
+	const Window* window = static_cast<const Window*>(inWindowID);
+	if (outWidthBoxels)
+		*outWidthBoxels = window->Right - window->Left;
+	if (outHeightBoxels)
+		*outHeightBoxels = window->Top - window->Bottom;
+}
+
+void XPLMSetWindowGeometry(XPLMWindowID inWindowID, int inLeft, int inTop, int inRight, int inBottom)
+{
+	auto lock = Enter();
+	Window* window = static_cast<Window*>(inWindowID);
+	window->Left = inLeft;
+	window->Top = inTop;
+	window->Right = inRight;
+	window->Bottom = inBottom;
+}
+
+int XPLMGetWindowIsVisible(XPLMWindowID inWindowID)
+{
+	auto lock = Enter();
+	return static_cast<const Window*>(inWindowID)->Visible;
+}
+
+void XPLMSetWindowIsVisible(XPLMWindowID inWindowID, int inIsVisible)
+{
+	auto lock = Enter();
+	static_cast<Window*>(inWindowID)->Visible = inIsVisible;
+}
+
+int XPLMWindowIsPoppedOut(XPLMWindowID)
+{
+	auto lock = Enter();
+	return 0;
+}
+
+int XPLMWindowIsInVR(XPLMWindowID)
+{
+	auto lock = Enter();
+	return 0;
+}
+
+void XPLMSetWindowPositioningMode(XPLMWindowID, XPLMWindowPositioningMode, int)
+{
+	auto lock = Enter();
+}
+
+void XPLMSetWindowResizingLimits(XPLMWindowID, int, int, int, int)
+{
+	auto lock = Enter();
+}
+
+void XPLMSetWindowTitle(XPLMWindowID, const char*)
+{
+	auto lock = Enter();
+}
+
+int XPLMHasKeyboardFocus(XPLMWindowID)
+{
+	auto lock = Enter();
+	return 0;
+}
+
+void XPLMTakeKeyboardFocus(XPLMWindowID)
+{
+	auto lock = Enter();
+}
+
+void XPLMGetScreenSize(int* outWidth, int* outHeight)
+{
+	auto lock = Enter();
+	if (outWidth)
+		*outWidth = SCREEN_WIDTH;
+	if (outHeight)
+		*outHeight = SCREEN_HEIGHT;
+}
+
+void XPLMGetScreenBoundsGlobal(int* outLeft, int* outTop, int* outRight, int* outBottom)
+{
+	auto lock = Enter();
+	if (outLeft)
+		*outLeft = 0;
+	if (outTop)
+		*outTop = SCREEN_HEIGHT;
+	if (outRight)
+		*outRight = SCREEN_WIDTH;
+	if (outBottom)
+		*outBottom = 0;
+}
+
+int XPLMRegisterDrawCallback(XPLMDrawCallback_f, XPLMDrawingPhase, int, void*)
+{
+	auto lock = Enter();
+	return 1;
+}
+
+int XPLMUnregisterDrawCallback(XPLMDrawCallback_f, XPLMDrawingPhase, int, void*)
+{
+	auto lock = Enter();
+	return 1;
+}
+
+void XPLMReadCameraPosition(XPLMCameraPosition_t* outCameraPosition)
+{
+	auto lock = Enter();
+	*outCameraPosition = XPLMCameraPosition_t{};
+}
+
+/* Graphics */
+
+void XPLMSetGraphicsState(int, int, int, int, int, int, int)
+{
+	auto lock = Enter();
+}
+
+void XPLMBindTexture2d(int, int)
+{
+	auto lock = Enter();
+}
+
+void XPLMGenerateTextureNumbers(int* outTextureIDs, int inCount)
+{
+	auto lock = Enter();
+	for (int i = 0; i < inCount; i++)
+	{
+		outTextureIDs[i] = GetSim().NextTexture++;
+	}
+}
+
+void XPLMDrawString(float*, int, int, const char*, int*, XPLMFontID)
+{
+	auto lock = Enter();
+}
+
+/* Map */
+
+void XPLMRegisterMapCreationHook(XPLMMapCreatedCallback_f, void*)
+{
+	auto lock = Enter();
+}
+
+int XPLMMapExists(const char*)
+{
+	auto lock = Enter();
+	return 0;
+}
+
+XPLMMapLayerID XPLMCreateMapLayer(XPLMCreateMapLayer_t*)
+{
+	auto lock = Enter();
+	return nullptr;
+}
+
+int XPLMDestroyMapLayer(XPLMMapLayerID)
+{
+	auto lock = Enter();
+	return 1;
+}
+
+void XPLMMapProject(XPLMMapProjectionID, double, double, float* outX, float* outY)
+{
+	auto lock = Enter();
+	*outX = 0.0f;
+	*outY = 0.0f;
+}
+
+float XPLMMapScaleMeter(XPLMMapProjectionID, float, float)
+{
+	auto lock = Enter();
+	return 1.0f;
+}
+
+void XPLMDrawMapIconFromSheet(XPLMMapLayerID, const char*, int, int, int, int, float, float, XPLMMapOrientation, float, float)
+{
+	auto lock = Enter();
+}
+
+void XPLMDrawMapLabel(XPLMMapLayerID, const char*, float, float, XPLMMapOrientation, float)
+{
+	auto lock = Enter();
+}
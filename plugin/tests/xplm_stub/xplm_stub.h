@@ -0,0 +1,56 @@
+/*
+ * xPilot: X-Plane pilot client for VATSIM
+ * Copyright (C) 2019-2024 Justin Shannon
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/// Stand-in for X-Plane's XPLM (plus the FMOD and OpenGL entry points the plugin links against), so the
+/// plugin and XPMP2 can run in a plain executable on a build machine. The host plays the simulator: it
+/// points the stub at a plugin directory and then calls RunFrame in a loop. Datarefs, flight loops,
+/// commands, windows and menus behave like the real thing as far as the plugin can tell; nothing is drawn,
+/// terrain is flat and objects load on the frame after they were requested.
+namespace xplm_stub
+{
+	/// Full path of the .xpl as XPLMGetPluginInfo reports it, e.g. "<dir>/lin_x64/xPilot.xpl"
+	void SetPluginPath(const std::string& path);
+
+	/// X-Plane's root folder, with a trailing separator
+	void SetSystemPath(const std::string& path);
+
+	/// Origin of the local OpenGL coordinates; also published as sim/flightmodel/position/lat_ref and lon_ref
+	void SetReferencePoint(double latitude, double longitude);
+
+	/// Height of the (flat) terrain above mean sea level [m]
+	void SetTerrainElevation(double meters);
+
+	/// Advances simulator time by elapsed seconds, hands out objects loaded since the last frame and
+	/// calls every flight loop that is due. Main thread only, like the real flight loop.
+	void RunFrame(float elapsed);
+
+	/// Simulator time so far [s]
+	double GetSimTime();
+	uint64_t GetFrameCount();
+
+	/// Calls into the stub's XPLM API that were made off the thread which called RunFrame first
+	uint64_t GetForeignThreadCalls();
+
+	uint64_t GetProbeCount();
+	int GetLiveInstances();
+}